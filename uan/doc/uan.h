@@ -39,7 +39,7 @@
  * attempted to provide the often used models as well as make an attempt to bridge, in part, the gap between
  * complicated ocean acoustic models and network level simulation.  The three propagation
  * models included are the ideal channel model, the Thorp propagation model and
- * the Bellhop propagation model (Available as an addition).
+ * the Bellhop propagation model.
  *
  * All of the Propagation Models follow the same simple interface in ns3::UanPropModel.
  * The propagation models provide a power delay profile (PDP) and pathloss
@@ -53,6 +53,15 @@
  * a symbol duration and ISI which interferes with neighbouring signals).  Both
  * UanPropModelIdeal and UanPropModelThorp return a single impulse for a PDP.
  *
+ * Propagation delay is computed from node positions at the start of transmission.  Setting the
+ * MobilityAware attribute of ns3::UanChannel accounts for receiver motion during propagation on
+ * links where either node is moving, and tags the delivered packet with its Doppler factor
+ * (ns3::UanDopplerTag, also available from UanPacketArrival::GetDopplerFactor).
+ *
+ * Setting the MaxRange attribute of ns3::UanChannel approximates the channel by dropping every
+ * arrival at nodes beyond that distance from the sender, both as a packet and as interference.
+ * It should only be set beyond the range at which the propagation model gives negligible power.
+ *
  *  a) Ideal Channel Model ns3::UanPropModelIdeal
  *
  *  The ideal channel model assumes 0 pathloss inside a cylindrical area with bounds
@@ -69,14 +78,21 @@
  *  Sciences Social-Informatics and Telecommunications Engineering), ICST, Brussels, Belgium, 1-8.
  *
  *  The frequency used in calculation however, is the center frequency of the modulation as found from
- *  ns3::UanTxMode.  The Thorp Propagation Model also assumes an impulse channel response.
- *
- *  c) Bellhop Propagation Model ns3::UanPropModelBh (Available as an addition)
- *
- *  The Bellhop propagation model reads propagation information from a database.  A configuration
- *  file describing the location, and resolution of the archived information must be supplied via
- *  attributes.  We have included a utility, create-dat, which can create these data files using the Bellhop
- *  Acoustic Ray Tracing software (http://oalib.hlsresearch.com/).
+ *  ns3::UanTxMode.  Absorption is computed once per mode and cached.  Setting the FastLog attribute
+ *  replaces log10 in the spreading loss with a polynomial approximation (error below 1e-6 dB).
+ *  The Thorp Propagation Model also assumes an impulse channel response.
+ *
+ *  c) Bellhop Propagation Model ns3::UanPropModelBh
+ *
+ *  The Bellhop propagation model reads propagation information from a database.  A grid file
+ *  holding pathloss, delay and PDP against frequency, source depth, receiver depth and range
+ *  (see ns3::UanPropGrid for the format) must be supplied via the ConfigFile attribute.  Pathloss
+ *  and delay are interpolated per link and the PDP of the nearest grid point is used, so realistic
+ *  multipath reaches the SINR models without running a ray tracer during the simulation.  Grid files
+ *  may be text or a binary format which is memory-mapped, so large grids load in constant time and
+ *  are shared by all channels; the uan-env-convert example converts text grids to binary.  We have
+ *  included a utility, create-dat, which can create these data files using the Bellhop Acoustic Ray
+ *  Tracing software (http://oalib.hlsresearch.com/).
  *
  *  The create-dat utility requires a Bellhop installation to run.  Bellhop takes
  *  environment information about the channel, such as sound speed profile, surface height
@@ -88,10 +104,6 @@
  *  configuration file used to create the data files using create-dat should be passed via
  *  attribute to the Bellhop Propagation Model.
  *
- *  The Bellhop propagation model is available as a patch.  The link address will be
- *  made available here when it is posted online.  Otherwise email lentracy@gmail.com
- *  for more information.
- *
  *
  * \section UanPhyOverview UAN PHY Model Overview
  *
@@ -113,7 +125,10 @@
  * The Transducer class is responsible for tracking all arriving packets and
  * departing packets over the duration of the events. How the PHY class and the PER and SINR models
  * respond to packets is based on the "Mode" of the transmission as described by the ns3::UanTxMode
- * class.
+ * class.  The default ns3::UanTransducerHd is half duplex:  while transmitting, all arrivals are dropped.
+ * ns3::UanTransducerFd keeps receiving while transmitting and instead adds the own transmission as self
+ * interference, attenuated by the InBandIsolation and OutOfBandIsolation attributes, so that a PHY with
+ * several receive chains can receive on one band while transmitting on another.
  *
  * When a MAC layer sends down a packet to the PHY for transmission it specifies a "mode number" to
  * be used for the transmission.  The PHY class accepts, as an attribute, a list of supported modes.  The
@@ -131,6 +146,9 @@
  *    - Micromodem FH-FSK PER (ns3::UanPhyPerUmodem).  The FH-FSK PER model calculates probability of error assuming a
  *      rate 1/2 convolutional code with constraint length 9 and a CRC check capable of correcting
  *      up to 1 bit error.  This is similar to what is used in the receiver of the WHOI Micromodem.
+ *    - Tabulated PER (ns3::UanPhyPerTable).  PER is interpolated from measured PER vs. SINR vs. packet
+ *      length curves, one per ns3::UanTxMode, read from a file given via attribute.  A file is parsed
+ *      only once per process and shared by every PHY which uses it.
  *
  * b) SINR models
  * - Default Model (ns3::UanPhyCalcSinrDefault), The default SINR model assumes that all transmitted energy is captured at the receiver
@@ -149,7 +167,13 @@
  *
  *  In addition to the generic PHY a dual phy layer is also included (ns3::UanPhyDual).  This wraps two
  *  generic phy layers together to model a net device which includes two receivers.  This was primarily
- *  developed for UanMacRc, described in the next section.
+ *  developed for UanMacRc, described in the next section.  The transducer keeps the summed power of
+ *  the current arrivals per frequency band, so the two PHYs share one pass over the arrivals for
+ *  their SINR and CCA evaluations.
+ *
+ *  ns3::UanPhyMulti generalizes this to any number of receive chains on one transducer.  The modes in
+ *  its SupportedModes attribute are split into chains of ModesPerChain consecutive modes, each received
+ *  by its own generic PHY, so a MAC can for example listen on a control channel while receiving data.
  *
  *\section UanMAC  UAN MAC Model Overview
  *
@@ -166,17 +190,49 @@
  *
  * b) RC-MAC (ns3::UanMacRc ns3::UanMacRcGw) a reservation channel protocol which dynamically divides
  * the available bandwidth into a data channel and a control channel.  This MAC protocol
- * assumes there is a gateway node which all network traffic is destined for.  The current
- * implementation assumes a single gateway and a single network neighborhood (a single hop network).
+ * assumes there are gateway nodes which all network traffic is destined for, in a single network
+ * neighborhood (a single hop network).  Several gateways can share the neighborhood when each runs on its
+ * own band (RateSet attribute of ns3::UanMacRcGw); nodes then pick a gateway per reservation from the
+ * load and propagation delay observed in the gateways' CTS packets.
  * RTS/CTS handshaking is used and time is divided into cycles.  Non-gateway nodes transmit RTS packets
  * on the control channel in parallel to data packet transmissions which were scheduled in the previous cycle
  * at the start of a new cycle, the gateway responds on the data channel with a CTS packet which includes
  * packet transmission times of data packets for received RTS packets in the previous cycle as well as bandwidth
- * allocation information.  At the end of a cycle ACK packets are transmitted for received data packets.
+ * allocation information.  At the end of a cycle ACK packets are transmitted for received data packets,
+ * either one per node or, with the AggregateAck attribute of ns3::UanMacRcGw, all in one broadcast packet.
  *
  * When a publication is available it will be cited here.
  *
  * c) Simple ALOHA (ns3::UanMacAloha)  Nodes transmit at will.
  *
+ * The MACs refuse packets while they are busy (ALOHA holds none and refuses packets while
+ * transmitting, CW-MAC and CUMAC hold a single packet, RC-MAC a queue of QueueLimit packets).  An ns3::UanTxQueue set as TxQueue attribute of ns3::UanNetDevice
+ * absorbs bursts in front of any MAC:  packets are held in the device and handed to the MAC each time
+ * it signals that it can take the next one.  The queue is bounded in packets and bytes, serves packets
+ * in FIFO order or by the priority of their protocol number, drops the new or the oldest packets when
+ * full and traces its depth and the sojourn time of each packet.
+ * Applications can instead pace themselves with ns3::UanNetDevice::AddTxReadyCallback, which is
+ * invoked each time the MAC can accept the next packet.
+ *
+ *\section UanTraceOverview Tracing
+ *
+ * UanHelper::EnableBinary and EnableBinaryAll connect an ns3::UanTraceWriter to the PHY trace sources of
+ * each device.  Every transmission and reception is stored as a small binary record (time, node, event type,
+ * mode, size and SINR or transmit power) in a large write buffer, optionally in a compressed variable length
+ * format.  This is far cheaper than EnableAscii, which prints every packet.  The uan-trace-decode example
+ * converts binary traces to text.
+ *
+ * When only summary numbers are needed, ns3::UanStatsCollector aggregates the same trace sources in memory:
+ * per link PDR and SINR histograms, airtime and utilization per mode and the distribution of the RTS to CTS
+ * (or any other request to response) latency.  The summary is written at Simulator::Destroy.
+ *
+ *\section UanCountersOverview Hot Path Counters
+ *
+ * Setting the global value UanCounters (e.g. NS_GLOBAL_VALUE="UanCounters=1") enables ns3::UanCounters,
+ * which counts channel deliveries, transducer arrivals, SINR and PER evaluations, CUMAC channel manager
+ * scans and tone pulse lookups, in total and per node.  The counts can be read with ns3::UanCounters::GetGlobal
+ * and ns3::UanCounters::GetNode until Simulator::Destroy, which resets them.  To also get a summary, set the
+ * global value UanCountersOutputFile to the name of a file it is written to at Simulator::Destroy.
+ *
  *
  */
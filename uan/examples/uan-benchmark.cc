@@ -0,0 +1,524 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+/**
+ * \file uan-benchmark.cc
+ * \ingroup uan
+ *
+ * Performance benchmarks of the channel, PHY and MAC hot paths, each run
+ * at a series of scales:
+ *
+ *  - fanout:  every node of an N node grid broadcasts in turn, so each
+ *             transmission is delivered to N-1 transducers (UanChannel);
+ *             receptions are counted at every PHY
+ *  - sinr:    N nodes around a receiver transmit at (nearly) the same
+ *             time, so every reception is evaluated against N-1
+ *             overlapping arrivals (UanPhyGen, UanPhyCalcSinrDefault)
+ *  - cumac:   N nodes on a grid all send to one sink with UanMacCumac
+ *             (RTS/CTS/beacon handshakes), once per grid spacing given
+ *             by CumacSpacings, so handshake rate is given against both
+ *             node count and density
+ *  - rcgw:    N nodes reserving through a UanMacRcGw gateway, which
+ *             computes its cycle parameters for every cycle
+ *
+ * Topologies are deterministic and every case runs with the same seed,
+ * so results are comparable across builds.  Each case runs in its own
+ * process, which makes the peak RSS reported for it its own.  One CSV
+ * line per case is written to stdout (or Output):
+ *
+ *   bench,scale,spacing,events,units,unit,simSeconds,wallMs,eventsPerSec,simSecondsPerSec,peakRssKb
+ *
+ * where spacing is the cumac grid spacing in m (0 for the other
+ * benchmarks), events is the number of simulator events executed and
+ * units counts the benchmark's own unit of work (receptions, packets
+ * delivered through handshakes or gateway cycles).
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/common-module.h"
+#include "ns3/helper-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/node-module.h"
+#include "ns3/uan-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstdlib>
+
+using namespace ns3;
+
+/**
+ * \class UanBenchmark
+ * \brief Sets up and times one benchmark case
+ */
+class UanBenchmark
+{
+public:
+  UanBenchmark ();
+
+  /**
+   * \param bench Benchmark name (fanout, sinr, cumac or rcgw)
+   * \param scale Number of nodes
+   * \param spacing Grid spacing in m (cumac only)
+   * \returns CSV result line (without newline)
+   */
+  std::string Run (std::string bench, uint32_t scale, double spacing);
+
+  uint32_t m_seed;
+  Time m_simTime;
+  uint32_t m_packetSize;
+
+private:
+  void SetupFanout (uint32_t n);
+  void SetupSinr (uint32_t n);
+  void SetupCumac (uint32_t n, double spacing);
+  void SetupRcGw (uint32_t n);
+  /**
+   * Positions nodes and installs their mobility models
+   * \param nodes Nodes to position
+   * \param pos Positions, one per node
+   */
+  void Place (NodeContainer &nodes, std::vector<Vector> &pos);
+  void Send (Ptr<NetDevice> dev, UanAddress dest);
+  void PhyRxOk (Ptr<const Packet> pkt, double sinr, UanTxMode mode);
+  void PhyRxError (Ptr<const Packet> pkt, double sinr, UanTxMode mode);
+  void DeviceRx (Ptr<const Packet> pkt, UanAddress src);
+  void GwCycle (Time now, Time delay, uint32_t numRts, uint32_t bytes,
+                double window, uint32_t ctlRate, double actualX);
+
+  uint64_t m_units;
+  std::string m_unitName;
+};
+
+UanBenchmark::UanBenchmark ()
+  : m_seed (12345),
+    m_simTime (Seconds (2000)),
+    m_packetSize (32),
+    m_units (0)
+{
+}
+
+void
+UanBenchmark::Place (NodeContainer &nodes, std::vector<Vector> &pos)
+{
+  Ptr<ListPositionAllocator> alloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < pos.size (); i++)
+    {
+      alloc->Add (pos[i]);
+    }
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (alloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+}
+
+void
+UanBenchmark::Send (Ptr<NetDevice> dev, UanAddress dest)
+{
+  dev->Send (Create<Packet> (m_packetSize), dest, 0);
+}
+
+void
+UanBenchmark::PhyRxOk (Ptr<const Packet> pkt, double sinr, UanTxMode mode)
+{
+  m_units++;
+}
+
+void
+UanBenchmark::PhyRxError (Ptr<const Packet> pkt, double sinr, UanTxMode mode)
+{
+  m_units++;
+}
+
+void
+UanBenchmark::DeviceRx (Ptr<const Packet> pkt, UanAddress src)
+{
+  m_units++;
+}
+
+void
+UanBenchmark::GwCycle (Time now, Time delay, uint32_t numRts, uint32_t bytes,
+                       double window, uint32_t ctlRate, double actualX)
+{
+  m_units++;
+}
+
+void
+UanBenchmark::SetupFanout (uint32_t n)
+{
+  m_unitName = "receptions";
+
+  UanHelper uan;
+  uan.SetMac ("ns3::UanMacAloha");
+  NodeContainer nodes;
+  nodes.Create (n);
+  NetDeviceContainer devices = uan.Install (nodes);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<UanPhy> phy = devices.Get (i)->GetObject<UanNetDevice> ()->GetPhy ();
+      phy->TraceConnectWithoutContext ("RxOk", MakeCallback (&UanBenchmark::PhyRxOk, this));
+      phy->TraceConnectWithoutContext ("RxError", MakeCallback (&UanBenchmark::PhyRxError, this));
+    }
+
+  // Square grid with 100 m spacing, all nodes in range of each other
+  uint32_t side = (uint32_t) std::ceil (std::sqrt ((double) n));
+  std::vector<Vector> pos;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      pos.push_back (Vector ((i % side) * 100.0, (i / side) * 100.0, 70.0));
+    }
+  Place (nodes, pos);
+
+  // Round robin broadcasts spaced wider than a packet, so arrivals do
+  // not overlap and the cost is dominated by channel delivery
+  UanAddress broadcast = UanAddress::GetBroadcast ();
+  double spacing = 8.0 * m_packetSize / 80.0 + 1.0;
+  uint32_t k = 0;
+  for (double t = 1.0; t < m_simTime.GetSeconds (); t += spacing, k++)
+    {
+      Simulator::Schedule (Seconds (t), &UanBenchmark::Send, this, devices.Get (k % n), broadcast);
+    }
+}
+
+void
+UanBenchmark::SetupSinr (uint32_t n)
+{
+  m_unitName = "receptions";
+
+  UanHelper uan;
+  uan.SetMac ("ns3::UanMacAloha");
+  NodeContainer nodes;
+  nodes.Create (n + 1);
+  NetDeviceContainer devices = uan.Install (nodes);
+
+  // Receiver at the center of a 500 m circle of transmitters
+  std::vector<Vector> pos;
+  pos.push_back (Vector (0, 0, 70.0));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double theta = 2.0 * M_PI * i / n;
+      pos.push_back (Vector (500.0 * std::cos (theta), 500.0 * std::sin (theta), 70.0));
+    }
+  Place (nodes, pos);
+
+  Ptr<UanPhy> phy = devices.Get (0)->GetObject<UanNetDevice> ()->GetPhy ();
+  phy->TraceConnectWithoutContext ("RxOk", MakeCallback (&UanBenchmark::PhyRxOk, this));
+  phy->TraceConnectWithoutContext ("RxError", MakeCallback (&UanBenchmark::PhyRxError, this));
+
+  // All transmitters start within 10 ms of each other every period, so
+  // the receiver sees n overlapping arrivals
+  UanAddress broadcast = UanAddress::GetBroadcast ();
+  double period = 2.0 * (8.0 * m_packetSize / 80.0 + 1.0);
+  for (double t = 1.0; t < m_simTime.GetSeconds (); t += period)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          Simulator::Schedule (Seconds (t + 0.01 * i / n), &UanBenchmark::Send, this,
+                               devices.Get (i + 1), broadcast);
+        }
+    }
+}
+
+void
+UanBenchmark::SetupCumac (uint32_t n, double spacing)
+{
+  m_unitName = "delivered";
+
+  UanHelper uan;
+  uan.SetMac ("ns3::UanMacCumac");
+  NodeContainer nodes;
+  nodes.Create (n + 1);
+  NetDeviceContainer devices = uan.Install (nodes);
+
+  // Sink at the center, senders on a grid with one node per spacing x
+  // spacing square, so contention grows with n and with density
+  uint32_t side = (uint32_t) std::ceil (std::sqrt ((double) n));
+  std::vector<Vector> pos;
+  pos.push_back (Vector (side * spacing / 2.0, side * spacing / 2.0, 70.0));
+  for (uint32_t i = 0; i < n; i++)
+    {
+      pos.push_back (Vector ((i % side) * spacing + spacing / 2.0, (i / side) * spacing, 70.0));
+    }
+  Place (nodes, pos);
+
+  devices.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&UanBenchmark::DeviceRx, this));
+
+  UanAddress sink = UanAddress::ConvertFrom (devices.Get (0)->GetAddress ());
+  double period = 20.0;
+  for (double t = 1.0; t < m_simTime.GetSeconds (); t += period)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          Simulator::Schedule (Seconds (t + period * i / n), &UanBenchmark::Send, this,
+                               devices.Get (i + 1), sink);
+        }
+    }
+}
+
+void
+UanBenchmark::SetupRcGw (uint32_t n)
+{
+  m_unitName = "cycles";
+
+  uint32_t numRates = 1023;
+  uint32_t totalRate = 4096;
+  double maxRange = 3000;
+  UanModesList controlModes;
+  UanModesList dataModes;
+  for (uint32_t i = 1; i < numRates + 1; i++)
+    {
+      uint32_t bw = i * totalRate / (numRates + 1);
+      controlModes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::OTHER, bw, totalRate,
+                                                             (uint32_t)(12000.0 - (totalRate - bw) / 2.0),
+                                                             bw, 2, "control"));
+    }
+  for (uint32_t i = numRates; i > 0; i--)
+    {
+      uint32_t bw = i * totalRate / (numRates + 1);
+      dataModes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::OTHER, bw, totalRate,
+                                                          (totalRate - bw) / 2 + 12000,
+                                                          bw, 2, "data"));
+    }
+
+  Time pDelay = Seconds (maxRange / 1500.0);
+  UanHelper uan;
+  uan.SetPhy ("ns3::UanPhyDual",
+              "SupportedModesPhy1", UanModesListValue (dataModes),
+              "SupportedModesPhy2", UanModesListValue (controlModes));
+  uan.SetMac ("ns3::UanMacRcGw",
+              "NumberOfRates", UintegerValue (numRates),
+              "NumberOfNodes", UintegerValue (n),
+              "MaxReservations", UintegerValue (0),
+              "MaxPropDelay", TimeValue (pDelay),
+              "FrameSize", UintegerValue (m_packetSize));
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+  NodeContainer gw;
+  gw.Create (1);
+  NetDeviceContainer gwDev = uan.Install (gw, channel);
+  gwDev.Get (0)->GetObject<UanNetDevice> ()->GetMac ()->TraceConnectWithoutContext ("Cycle", MakeCallback (&UanBenchmark::GwCycle, this));
+
+  uan.SetMac ("ns3::UanMacRc",
+              "NumberOfRates", UintegerValue (numRates),
+              "MaxPropDelay", TimeValue (pDelay));
+  NodeContainer nodes;
+  nodes.Create (n);
+  NetDeviceContainer devices = uan.Install (nodes, channel);
+
+  // Gateway at the center, nodes spread over range and bearing
+  std::vector<Vector> pos;
+  pos.push_back (Vector (maxRange, maxRange, 70.0));
+  Place (gw, pos);
+  pos.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double r = maxRange * (i + 1) / n;
+      double theta = 2.0 * M_PI * i / n;
+      pos.push_back (Vector (maxRange + r * std::cos (theta), maxRange + r * std::sin (theta), 70.0));
+    }
+  Place (nodes, pos);
+
+  UanAddress dest = UanAddress::ConvertFrom (gwDev.Get (0)->GetAddress ());
+  double period = 8.0 * m_packetSize / 400.0;
+  for (double t = 0.5; t < m_simTime.GetSeconds (); t += period)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          Simulator::Schedule (Seconds (t + period * i / n), &UanBenchmark::Send, this,
+                               devices.Get (i), dest);
+        }
+    }
+}
+
+std::string
+UanBenchmark::Run (std::string bench, uint32_t scale, double spacing)
+{
+  SeedManager::SetSeed (m_seed);
+  SeedManager::SetRun (1);
+  m_units = 0;
+
+  if (bench == "fanout")
+    {
+      SetupFanout (scale);
+    }
+  else if (bench == "sinr")
+    {
+      SetupSinr (scale);
+    }
+  else if (bench == "cumac")
+    {
+      SetupCumac (scale, spacing);
+    }
+  else if (bench == "rcgw")
+    {
+      SetupRcGw (scale);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown benchmark " << bench);
+    }
+
+  // Events are run one at a time so that they can be counted
+  uint64_t events = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (m_simTime);
+  while (!Simulator::IsFinished ())
+    {
+      Simulator::RunOneEvent ();
+      events++;
+    }
+  unsigned long long wallMs = clock.End ();
+  double simSeconds = Simulator::Now ().GetSeconds ();
+  Simulator::Destroy ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  double wallSeconds = std::max (wallMs, 1ULL) / 1000.0;
+  std::ostringstream line;
+  line << bench << ","
+       << scale << ","
+       << spacing << ","
+       << events << ","
+       << m_units << ","
+       << m_unitName << ","
+       << simSeconds << ","
+       << wallMs << ","
+       << events / wallSeconds << ","
+       << simSeconds / wallSeconds << ","
+       << usage.ru_maxrss;
+  return line.str ();
+}
+
+/**
+ * Runs one benchmark case in a child process
+ * \param benchmark Benchmark settings
+ * \param bench Benchmark name
+ * \param scale Number of nodes
+ * \param spacing Grid spacing in m (cumac only)
+ * \param out Stream the result line is written to
+ * \returns True if the case finished
+ */
+static bool
+RunCase (UanBenchmark &benchmark, std::string bench, uint32_t scale, double spacing, std::ostream &out)
+{
+  int fds[2];
+  if (pipe (fds) != 0)
+    {
+      NS_FATAL_ERROR ("pipe failed");
+    }
+  pid_t pid = fork ();
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("fork failed");
+    }
+  if (pid == 0)
+    {
+      close (fds[0]);
+      std::string line = benchmark.Run (bench, scale, spacing) + "\n";
+      ssize_t written = write (fds[1], line.data (), line.size ());
+      _exit (written == (ssize_t) line.size () ? 0 : 1);
+    }
+  close (fds[1]);
+
+  // Cases run one at a time so they do not compete for the CPU
+  std::string line;
+  char buf[512];
+  ssize_t n;
+  while ((n = read (fds[0], buf, sizeof (buf))) > 0)
+    {
+      line.append (buf, n);
+    }
+  close (fds[0]);
+  int status;
+  waitpid (pid, &status, 0);
+  if (WIFEXITED (status) && WEXITSTATUS (status) == 0 && !line.empty ())
+    {
+      out << line << std::flush;
+      return true;
+    }
+  std::cerr << "Benchmark " << bench << " at scale " << scale << " spacing " << spacing << " failed" << std::endl;
+  return false;
+}
+
+int
+main (int argc, char **argv)
+{
+  UanBenchmark benchmark;
+  std::string benches = "fanout,sinr,cumac,rcgw";
+  std::string scales = "4,8,16,32,64";
+  std::string spacings = "50,100,200,400";
+  std::string outFile;
+
+  CommandLine cmd;
+  cmd.AddValue ("Benchmarks", "Comma separated benchmarks to run (fanout, sinr, cumac, rcgw)", benches);
+  cmd.AddValue ("Scales", "Comma separated node counts to run each benchmark at", scales);
+  cmd.AddValue ("CumacSpacings", "Comma separated grid spacings in m (node densities) to run cumac at", spacings);
+  cmd.AddValue ("SimTime", "Simulated time per case", benchmark.m_simTime);
+  cmd.AddValue ("PacketSize", "Packet size in bytes", benchmark.m_packetSize);
+  cmd.AddValue ("Seed", "Random number generator seed", benchmark.m_seed);
+  cmd.AddValue ("Output", "CSV file to write (stdout if empty)", outFile);
+  cmd.Parse (argc, argv);
+
+  std::ofstream file;
+  if (!outFile.empty ())
+    {
+      file.open (outFile.c_str ());
+      if (!file.is_open ())
+        {
+          NS_FATAL_ERROR ("Can not open output file: " << outFile);
+        }
+    }
+  std::ostream &out = outFile.empty () ? std::cout : file;
+  out << "bench,scale,spacing,events,units,unit,simSeconds,wallMs,eventsPerSec,simSecondsPerSec,peakRssKb" << std::endl;
+
+  std::istringstream benchList (benches);
+  std::string bench;
+  int rc = 0;
+  while (std::getline (benchList, bench, ','))
+    {
+      std::istringstream scaleList (scales);
+      std::string scale;
+      while (std::getline (scaleList, scale, ','))
+        {
+          if (bench != "cumac")
+            {
+              rc |= !RunCase (benchmark, bench, std::atoi (scale.c_str ()), 0, out);
+              continue;
+            }
+          std::istringstream spacingList (spacings);
+          std::string spacing;
+          while (std::getline (spacingList, spacing, ','))
+            {
+              rc |= !RunCase (benchmark, bench, std::atoi (scale.c_str ()), std::atof (spacing.c_str ()), out);
+            }
+        }
+    }
+  return rc;
+}
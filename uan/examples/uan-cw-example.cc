@@ -52,9 +52,6 @@ NS_LOG_COMPONENT_DEFINE("UanCwExample");
 
 Experiment::Experiment () 
   : m_numNodes (15),
-    m_dataRate (80),
-    m_depth (70),
-    m_boundary (500),
     m_packetSize (32),
     m_bytesTotal (0),
     m_cwMin (10),
@@ -64,8 +61,8 @@ Experiment::Experiment ()
     m_slotTime (Seconds (0.2)),
     m_simTime (Seconds (1000)),
     m_gnudatfile ("uan-cw-example.gpl"),
-    m_asciitracefile ("uan-cw-example.asc"),
-    m_bhCfgFile ("uan-apps/dat/default.cfg")
+    m_tracefile ("uan-cw-example.tr"),
+    m_bhCfgFile ("")
 {
 }
 
@@ -103,11 +100,11 @@ Experiment::UpdatePositions (NodeContainer &nodes)
 
   NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Updating positions");
   NodeContainer::Iterator it = nodes.Begin ();
-  UniformVariable uv (0, m_boundary);
+  UniformVariable uv (0, m_scenario.m_boundary);
   for (; it != nodes.End (); it++)
     {
       Ptr<MobilityModel> mp = (*it)->GetObject<MobilityModel> ();
-      mp->SetPosition (Vector (uv.GetValue (), uv.GetValue (), 70.0));
+      mp->SetPosition (Vector (uv.GetValue (), uv.GetValue (), m_scenario.m_depth));
     }
 }
 
@@ -132,64 +129,26 @@ Experiment::Run (UanHelper &uan)
   nc.Create (m_numNodes);
   sink.Create (1);
 
-  PacketSocketHelper socketHelper;
-  socketHelper.Install (nc);
-  socketHelper.Install (sink);
-
-#ifdef UAN_PROP_BH_INSTALLED
-  Ptr<UanPropModelBh> prop = CreateObjectWithAttributes<UanPropModelBh> ("ConfigFile", StringValue ("exbhconfig.cfg"));
-#else 
-  Ptr<UanPropModelIdeal> prop = CreateObjectWithAttributes<UanPropModelIdeal> ();
-#endif //UAN_PROP_BH_INSTALLED
+  Ptr<UanPropModel> prop;
+  if (m_bhCfgFile.empty ())
+    {
+      prop = CreateObject<UanPropModelIdeal> ();
+    }
+  else
+    {
+      prop = CreateObjectWithAttributes<UanPropModelBh> ("ConfigFile", StringValue (m_bhCfgFile));
+    }
   Ptr<UanChannel> channel = CreateObjectWithAttributes<UanChannel> ("PropagationModel", PointerValue (prop));
 
   //Create net device and nodes with UanHelper
   NetDeviceContainer devices = uan.Install (nc, channel);
   NetDeviceContainer sinkdev = uan.Install (sink, channel);
 
-  MobilityHelper mobility;
-  Ptr<ListPositionAllocator> pos = CreateObject<ListPositionAllocator> ();
+  m_scenario.SetPositions (sink, nc);
 
   {
-    UniformVariable urv (0, m_boundary);
-    pos->Add (Vector (m_boundary / 2.0, m_boundary / 2.0, m_depth));
-    double rsum = 0;
-
-    double minr = 2 * m_boundary;
-    for (uint32_t i = 0; i < m_numNodes; i++)
-      {
-        double x = urv.GetValue ();
-        double y = urv.GetValue ();
-        double newr = sqrt ((x - m_boundary / 2.0) * (x - m_boundary / 2.0)
-                            + (y - m_boundary / 2.0) * (y - m_boundary / 2.0));
-        rsum += newr;
-        minr = std::min (minr, newr);
-        pos->Add (Vector (x, y, m_depth));
-
-      }
-    NS_LOG_DEBUG ("Mean range from gateway: " << rsum / m_numNodes
-                                              << "    min. range " << minr);
-
-    mobility.SetPositionAllocator (pos);
-    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-    mobility.Install (sink);
-
-    NS_LOG_DEBUG ("Position of sink: "
-                    << sink.Get (0)->GetObject<MobilityModel> ()->GetPosition ());
-    mobility.Install (nc);
-
-    PacketSocketAddress socket;
-    socket.SetSingleDevice (sinkdev.Get(0)->GetIfIndex ());
-    socket.SetPhysicalAddress (sinkdev.Get(0)->GetAddress ());
-    socket.SetProtocol (0);
-
-    OnOffHelper app ("ns3::PacketSocketFactory", Address (socket));
-    app.SetAttribute ("OnTime", RandomVariableValue (ConstantVariable (1)));
-    app.SetAttribute ("OffTime", RandomVariableValue (ConstantVariable (0)));
-    app.SetAttribute ("DataRate", DataRateValue (m_dataRate));
-    app.SetAttribute ("PacketSize", UintegerValue (m_packetSize));
-
-    ApplicationContainer apps = app.Install (nc);
+    ApplicationContainer apps = UanExampleInstallTraffic (nc, sink, sinkdev.Get (0),
+                                                          m_scenario.m_dataRate, m_packetSize);
     apps.Start (Seconds (0.5));
     Time nextEvent = Seconds (0.5);
 
@@ -207,31 +166,16 @@ Experiment::Run (UanHelper &uan)
       }
     apps.Stop (nextEvent + m_simTime);
 
-    Ptr<Node> sinkNode = sink.Get (0);
-    TypeId psfid = TypeId::LookupByName ("ns3::PacketSocketFactory");
-    if (sinkNode->GetObject<SocketFactory> (psfid) == 0)
-      {
-        Ptr<PacketSocketFactory> psf = CreateObject<PacketSocketFactory> ();
-        sinkNode->AggregateObject (psf);
-      }
-    Ptr<Socket> sinkSocket = Socket::CreateSocket (sinkNode, psfid);
-    sinkSocket->Bind (socket);
-    sinkSocket->SetRecvCallback (MakeCallback (&Experiment::ReceivePacket, this));
+    Ptr<Socket> sinkSocket = UanExampleCreateSink (sinkdev.Get (0),
+                                                   MakeCallback (&Experiment::ReceivePacket, this));
 
     m_bytesTotal = 0;
 
-    std::ofstream ascii (m_asciitracefile.c_str ());
-    if (!ascii.is_open ())
-      {
-        NS_FATAL_ERROR ("Could not open ascii trace file: "
-                          << m_asciitracefile);
-      }
-    uan.EnableAsciiAll (ascii);
+    // Binary trace, convert to text with uan-trace-decode
+    UanHelper::EnableBinaryAll (m_tracefile);
 
     Simulator::Run ();
-    sinkNode = 0;
     sinkSocket = 0;
-    pos = 0;
     channel = 0;
     prop = 0;
     for (uint32_t i=0; i < nc.GetN (); i++)
@@ -271,10 +215,10 @@ main (int argc, char **argv)
 
   CommandLine cmd;
   cmd.AddValue ("NumNodes", "Number of transmitting nodes", exp.m_numNodes);
-  cmd.AddValue ("Depth", "Depth of transmitting and sink nodes", exp.m_depth);
-  cmd.AddValue ("RegionSize", "Size of boundary in meters", exp.m_boundary);
+  cmd.AddValue ("Depth", "Depth of transmitting and sink nodes", exp.m_scenario.m_depth);
+  cmd.AddValue ("RegionSize", "Size of boundary in meters", exp.m_scenario.m_boundary);
   cmd.AddValue ("PacketSize", "Generated packet size in bytes", exp.m_packetSize);
-  cmd.AddValue ("DataRate", "DataRate in bps", exp.m_dataRate);
+  cmd.AddValue ("DataRate", "DataRate in bps", exp.m_scenario.m_dataRate);
   cmd.AddValue ("CwMin", "Min CW to simulate", exp.m_cwMin);
   cmd.AddValue ("CwMax", "Max CW to simulate", exp.m_cwMax);
   cmd.AddValue ("SlotTime", "Slot time duration", exp.m_slotTime);
@@ -282,6 +226,7 @@ main (int argc, char **argv)
   cmd.AddValue ("GnuFile", "Name for GNU Plot output", exp.m_gnudatfile);
   cmd.AddValue ("PerModel", "PER model name", perModel);
   cmd.AddValue ("SinrModel", "SINR model name", sinrModel);
+  cmd.AddValue ("BhConfig", "UanPropModelBh grid file (ideal propagation if empty)", exp.m_bhCfgFile);
   cmd.Parse (argc, argv);
 
   ObjectFactory obf;
@@ -291,13 +236,8 @@ main (int argc, char **argv)
   Ptr<UanPhyCalcSinr> sinr = obf.Create<UanPhyCalcSinr> ();
 
   UanHelper uan;
-  UanTxMode mode;
-  mode = UanTxModeFactory::CreateMode (UanTxMode::FSK, exp.m_dataRate,
-                                       exp.m_dataRate, 12000,
-                                       exp.m_dataRate, 2,
-                                       "Default mode");
   UanModesList myModes;
-  myModes.AppendMode (mode);
+  myModes.AppendMode (exp.m_scenario.CreateMode ());
 
   uan.SetPhy ("ns3::UanPhyGen",
               "PerModel", PointerValue (per),
@@ -26,6 +26,7 @@
 #include "ns3/contrib-module.h"
 #include "ns3/uan-module.h"
 #include "ns3/helper-module.h"
+#include "uan-example-scenario.h"
 
 using namespace ns3;
 
@@ -42,10 +43,8 @@ public:
   void UpdatePositions (NodeContainer &nodes);
   void ResetData ();
   void IncrementCw (uint32_t cw);
+  UanCwScenario m_scenario;
   uint32_t m_numNodes;
-  uint32_t m_dataRate;
-  double m_depth;
-  double m_boundary;
   uint32_t m_packetSize;
   uint32_t m_bytesTotal;
   uint32_t m_cwMin;
@@ -57,7 +56,7 @@ public:
   Time m_simTime;
 
   std::string m_gnudatfile;
-  std::string m_asciitracefile;
+  std::string m_tracefile;
   std::string m_bhCfgFile;
 
   Gnuplot2dDataset m_data;
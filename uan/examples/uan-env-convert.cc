@@ -0,0 +1,56 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+/**
+ * \file uan-env-convert.cc
+ * \ingroup uan
+ *
+ * Converts a UanPropModelBh grid file from the text format (with PDPs in
+ * the UanPdp stream format) to the memory-mappable binary format.  See
+ * UanPropGrid for both formats.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/uan-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+int
+main (int argc, char **argv)
+{
+  std::string in;
+  std::string out;
+
+  CommandLine cmd;
+  cmd.AddValue ("In", "Grid file to convert (text or binary)", in);
+  cmd.AddValue ("Out", "Name of binary grid file to write", out);
+  cmd.Parse (argc, argv);
+
+  if (in.empty () || out.empty ())
+    {
+      std::cerr << "Usage: uan-env-convert --In=grid.txt --Out=grid.bin" << std::endl;
+      return 1;
+    }
+
+  UanPropGrid::Get (in).WriteBinary (out);
+  return 0;
+}
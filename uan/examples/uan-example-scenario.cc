@@ -0,0 +1,247 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-example-scenario.h"
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/log.h"
+
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("UanExampleScenario");
+
+UanCwScenario::UanCwScenario ()
+  : m_dataRate (80),
+    m_depth (70),
+    m_boundary (500)
+{
+}
+
+UanTxMode
+UanCwScenario::CreateMode (void) const
+{
+  return UanTxModeFactory::CreateMode (UanTxMode::FSK, m_dataRate,
+                                       m_dataRate, 12000,
+                                       m_dataRate, 2,
+                                       "Default mode");
+}
+
+void
+UanCwScenario::SetPositions (NodeContainer &sink, NodeContainer &nodes) const
+{
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> pos = CreateObject<ListPositionAllocator> ();
+
+  UniformVariable urv (0, m_boundary);
+  pos->Add (Vector (m_boundary / 2.0, m_boundary / 2.0, m_depth));
+  double rsum = 0;
+  double minr = 2 * m_boundary;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      double x = urv.GetValue ();
+      double y = urv.GetValue ();
+      double newr = sqrt ((x - m_boundary / 2.0) * (x - m_boundary / 2.0)
+                          + (y - m_boundary / 2.0) * (y - m_boundary / 2.0));
+      rsum += newr;
+      minr = std::min (minr, newr);
+      pos->Add (Vector (x, y, m_depth));
+    }
+  NS_LOG_DEBUG ("Mean range from gateway: " << rsum / nodes.GetN ()
+                                            << "    min. range " << minr);
+
+  mobility.SetPositionAllocator (pos);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (sink);
+  NS_LOG_DEBUG ("Position of sink: "
+                << sink.Get (0)->GetObject<MobilityModel> ()->GetPosition ());
+  mobility.Install (nodes);
+}
+
+UanRcScenario::UanRcScenario ()
+  : m_numRates (1023),
+    m_totalRate (4096),
+    m_maxRange (3000),
+    m_numGateways (1),
+    m_gwSpacing (500),
+    m_depth (70),
+    m_frameSize (1000),
+    m_sifs (Seconds (0.05))
+{
+}
+
+UanTxMode
+UanRcScenario::CreateMode (uint32_t kass,
+                           uint32_t fc,
+                           bool upperblock,
+                           std::string name) const
+{
+  std::ostringstream buf;
+  buf << name << " " << kass;
+
+  uint32_t rate = m_totalRate / (m_numRates + 1) * (kass);
+  uint32_t bw = kass * m_totalRate / (m_numRates + 1);
+  uint32_t fcmode;
+  if (upperblock)
+    {
+      fcmode = (m_totalRate - bw) / 2 + fc;
+    }
+  else
+    {
+      fcmode = (uint32_t)((-((double) m_totalRate ) + (double) bw) / 2.0 + (double) fc);
+    }
+
+  return UanTxModeFactory::CreateMode (UanTxMode::OTHER,
+                                       rate,
+                                       m_totalRate,
+                                       fcmode,
+                                       bw,
+                                       2,
+                                       buf.str ());
+}
+
+void
+UanRcScenario::CreateDualModes (uint32_t fc)
+{
+  m_dataModes = UanModesList ();
+  m_controlModes = UanModesList ();
+  for (uint32_t g = 0; g < m_numGateways; g++)
+    {
+      uint32_t fcg = fc + g * m_totalRate;
+      for (uint32_t i = 1; i < m_numRates + 1; i++)
+        {
+          m_controlModes.AppendMode (CreateMode (i, fcg, false, "control "));
+        }
+      for (uint32_t i = m_numRates; i > 0; i--)
+        {
+          m_dataModes.AppendMode (CreateMode (i, fcg, true, "data "));
+        }
+    }
+}
+
+Time
+UanRcScenario::GetMaxPropDelay (void) const
+{
+  double maxDist = m_maxRange + m_gwSpacing * (m_numGateways - 1) / 2.0;
+  return Seconds (maxDist / 1500.0);
+}
+
+void
+UanRcScenario::Install (NodeContainer &gateways, NodeContainer &nodes, Ptr<UanChannel> channel,
+                        uint32_t maxReservations, NetDeviceContainer &gwDevs,
+                        NetDeviceContainer &nodeDevs) const
+{
+  NS_ASSERT_MSG (m_dataModes.GetNModes () == m_numRates * m_numGateways,
+                 "CreateDualModes must be called with the current rate settings");
+  NS_ASSERT (gateways.GetN () == m_numGateways);
+
+  Time pDelay = GetMaxPropDelay ();
+  UanHelper uan;
+  uan.SetPhy ("ns3::UanPhyDual",
+              "SupportedModesPhy1", UanModesListValue (m_dataModes),
+              "SupportedModesPhy2", UanModesListValue (m_controlModes));
+
+  for (uint32_t g = 0; g < m_numGateways; g++)
+    {
+      uan.SetMac ("ns3::UanMacRcGw",
+                  "NumberOfRates", UintegerValue (m_numRates),
+                  "NumberOfRateSets", UintegerValue (m_numGateways),
+                  "NumberOfNodes", UintegerValue ((nodes.GetN () + m_numGateways - 1) / m_numGateways),
+                  "MaxReservations", UintegerValue (maxReservations),
+                  "RetryRate", DoubleValue (1 / 30.0),
+                  "SIFS", TimeValue (m_sifs),
+                  "MaxPropDelay", TimeValue (pDelay),
+                  "FrameSize", UintegerValue (m_frameSize));
+      NetDeviceContainer gwDev = uan.Install (NodeContainer (gateways.Get (g)), channel);
+      gwDev.Get (0)->GetObject<UanNetDevice> ()->GetMac ()->SetAttribute ("RateSet", UintegerValue (g));
+      gwDevs.Add (gwDev);
+    }
+
+  uan.SetMac ("ns3::UanMacRc",
+              "NumberOfRates", UintegerValue (m_numRates),
+              "NumberOfRateSets", UintegerValue (m_numGateways),
+              "MaxPropDelay", TimeValue (pDelay),
+              "RetryRate", DoubleValue (1.0 / 100.0));
+  nodeDevs.Add (uan.Install (nodes, channel));
+}
+
+void
+UanRcScenario::SetPositions (NodeContainer &gateways, NodeContainer &nodes) const
+{
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> pos = CreateObject<ListPositionAllocator> ();
+
+  UniformVariable urv (0, m_maxRange);
+  UniformVariable utheta (0, 2.0 * M_PI);
+  for (uint32_t g = 0; g < gateways.GetN (); g++)
+    {
+      double offset = m_gwSpacing * (g - (gateways.GetN () - 1) / 2.0);
+      pos->Add (Vector (m_maxRange + offset, m_maxRange, m_depth));
+    }
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      double theta = utheta.GetValue ();
+      double r = urv.GetValue ();
+      pos->Add (Vector (m_maxRange + r * std::cos (theta), m_maxRange + r * std::sin (theta), m_depth));
+    }
+
+  mobility.SetPositionAllocator (pos);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (gateways);
+  mobility.Install (nodes);
+}
+
+ApplicationContainer
+UanExampleInstallTraffic (NodeContainer &nodes, NodeContainer &sinks, Ptr<NetDevice> sinkDev,
+                          uint32_t dataRate, uint32_t packetSize)
+{
+  PacketSocketHelper socketHelper;
+  socketHelper.Install (nodes);
+  socketHelper.Install (sinks);
+
+  PacketSocketAddress socket;
+  socket.SetSingleDevice (sinkDev->GetIfIndex ());
+  socket.SetPhysicalAddress (sinkDev->GetAddress ());
+  socket.SetProtocol (0);
+
+  OnOffHelper app ("ns3::PacketSocketFactory", Address (socket));
+  app.SetAttribute ("OnTime", RandomVariableValue (ConstantVariable (1)));
+  app.SetAttribute ("OffTime", RandomVariableValue (ConstantVariable (0)));
+  app.SetAttribute ("DataRate", DataRateValue (dataRate));
+  app.SetAttribute ("PacketSize", UintegerValue (packetSize));
+
+  return app.Install (nodes);
+}
+
+Ptr<Socket>
+UanExampleCreateSink (Ptr<NetDevice> sinkDev, Callback<void, Ptr<Socket> > cb)
+{
+  PacketSocketAddress socket;
+  socket.SetSingleDevice (sinkDev->GetIfIndex ());
+  socket.SetPhysicalAddress (sinkDev->GetAddress ());
+  socket.SetProtocol (0);
+
+  TypeId psfid = TypeId::LookupByName ("ns3::PacketSocketFactory");
+  Ptr<Socket> sinkSocket = Socket::CreateSocket (sinkDev->GetNode (), psfid);
+  sinkSocket->Bind (socket);
+  sinkSocket->SetRecvCallback (cb);
+  return sinkSocket;
+}
@@ -0,0 +1,142 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANEXAMPLESCENARIO_H
+#define UANEXAMPLESCENARIO_H
+
+#include "ns3/common-module.h"
+#include "ns3/node-module.h"
+#include "ns3/helper-module.h"
+#include "ns3/uan-module.h"
+
+using namespace ns3;
+
+/**
+ * \class UanCwScenario
+ * \brief Network of the CW-MAC example (uan-cw-example, uan-sweep)
+ *
+ * A sink in the center of a square region and nodes placed uniformly
+ * at random in it, all at the same depth and using a single FSK mode.
+ */
+class UanCwScenario
+{
+public:
+  UanCwScenario ();
+
+  /// \returns FSK mode of m_dataRate bps centered at 12 kHz
+  UanTxMode CreateMode (void) const;
+  /**
+   * \param sink Node placed in the center of the region
+   * \param nodes Nodes placed uniformly at random in the region
+   */
+  void SetPositions (NodeContainer &sink, NodeContainer &nodes) const;
+
+  uint32_t m_dataRate;
+  double m_depth;
+  double m_boundary;
+};
+
+/**
+ * \class UanRcScenario
+ * \brief Network of the RC-MAC example (uan-rc-example, uan-sweep)
+ *
+ * Gateways spaced m_gwSpacing apart around the center of the region,
+ * each with its own band of m_totalRate Hz, and nodes at a range
+ * uniformly distributed in [0, m_maxRange] from the center.
+ */
+class UanRcScenario
+{
+public:
+  UanRcScenario ();
+
+  /**
+   * \param kass Number of the m_numRates + 1 subbands assigned to the mode
+   * \param fc Center frequency of the band
+   * \param upperblock True for the upper (data) end of the band, false for the lower (control) end
+   * \param name Prefix of the mode name
+   * \returns Mode using kass subbands at one end of the band
+   */
+  UanTxMode CreateMode (uint32_t kass, uint32_t fc, bool upperblock, std::string name) const;
+  /**
+   * Creates m_dataModes and m_controlModes, m_numRates of each per gateway,
+   * dividing the band of gateway g centered at fc + g * m_totalRate (assumes
+   * 1 bit per Hz).
+   *
+   * \param fc Center frequency of the band of the first gateway
+   */
+  void CreateDualModes (uint32_t fc);
+  /// \returns Propagation delay from the center to the farthest node
+  Time GetMaxPropDelay (void) const;
+  /**
+   * Installs UanMacRcGw on the gateways and UanMacRc on the nodes, both over
+   * UanPhyDual with the modes of CreateDualModes.
+   *
+   * \param gateways m_numGateways gateway nodes
+   * \param nodes Non-gateway nodes
+   * \param channel Channel to attach the devices to
+   * \param maxReservations "a" parameter of the gateways (0 to let them optimize it)
+   * \param gwDevs Container the gateway devices are added to
+   * \param nodeDevs Container the node devices are added to
+   */
+  void Install (NodeContainer &gateways, NodeContainer &nodes, Ptr<UanChannel> channel,
+                uint32_t maxReservations, NetDeviceContainer &gwDevs,
+                NetDeviceContainer &nodeDevs) const;
+  /**
+   * \param gateways m_numGateways gateway nodes to place around the center
+   * \param nodes Nodes to place around the center
+   */
+  void SetPositions (NodeContainer &gateways, NodeContainer &nodes) const;
+
+  uint32_t m_numRates;
+  uint32_t m_totalRate;
+  double m_maxRange;
+  uint32_t m_numGateways;
+  double m_gwSpacing;
+  double m_depth;
+  uint32_t m_frameSize;
+  Time m_sifs;
+
+  UanModesList m_dataModes;
+  UanModesList m_controlModes;
+};
+
+/**
+ * Installs packet sockets on nodes and sinks and saturating OnOff
+ * applications on nodes which send to sinkDev.  The applications are
+ * not started.
+ *
+ * \param nodes Sending nodes
+ * \param sinks Receiving nodes
+ * \param sinkDev Destination device of all packets
+ * \param dataRate Rate of each application in bps
+ * \param packetSize Size of generated packets in bytes
+ * \returns The applications of nodes
+ */
+ApplicationContainer UanExampleInstallTraffic (NodeContainer &nodes, NodeContainer &sinks,
+                                               Ptr<NetDevice> sinkDev, uint32_t dataRate,
+                                               uint32_t packetSize);
+/**
+ * \param sinkDev Device to receive packets from
+ * \param cb Callback invoked when packets are available
+ * \returns Packet socket bound to sinkDev
+ */
+Ptr<Socket> UanExampleCreateSink (Ptr<NetDevice> sinkDev, Callback<void, Ptr<Socket> > cb);
+
+#endif //UANEXAMPLESCENARIO_H
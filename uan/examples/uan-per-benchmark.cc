@@ -0,0 +1,90 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+/**
+ * \file uan-per-benchmark.cc
+ * \ingroup uan
+ *
+ * Times UanPhyPerUmodem::CalcPer with the analytic bit error calculation
+ * against the tabulated (UseTable) variant, and reports the largest
+ * difference between the two over the evaluated SINR points.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/common-module.h"
+#include "ns3/uan-module.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+static double
+RunPer (Ptr<UanPhyPer> per, Ptr<Packet> pkt, UanTxMode mode, uint32_t evals, std::vector<double> &out)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < evals; i++)
+    {
+      // Sweep across the 6-10 dB region where CalcPer is not trivially 0 or 1
+      double sinr = 6.0 + 4.0 * (i + 0.5) / evals;
+      out[i] = per->CalcPer (pkt, sinr, mode);
+    }
+  return clock.End ();
+}
+
+int
+main (int argc, char **argv)
+{
+  uint32_t evals = 100000;
+  uint32_t pktSize = 32;
+
+  CommandLine cmd;
+  cmd.AddValue ("Evals", "Number of CalcPer evaluations per model", evals);
+  cmd.AddValue ("PacketSize", "Packet size in bytes", pktSize);
+  cmd.Parse (argc, argv);
+
+  Ptr<Packet> pkt = Create<Packet> (pktSize);
+  UanTxMode mode = UanPhyGen::GetDefaultModes ()[0];
+
+  Ptr<UanPhyPerUmodem> exact = CreateObject<UanPhyPerUmodem> ();
+  Ptr<UanPhyPerUmodem> table = CreateObjectWithAttributes<UanPhyPerUmodem> ("UseTable", BooleanValue (true));
+
+  std::vector<double> exactPer (evals);
+  std::vector<double> tablePer (evals);
+  double exactMs = RunPer (exact, pkt, mode, evals, exactPer);
+  double tableMs = RunPer (table, pkt, mode, evals, tablePer);
+
+  double maxErr = 0;
+  for (uint32_t i = 0; i < evals; i++)
+    {
+      maxErr = std::max (maxErr, std::abs (exactPer[i] - tablePer[i]));
+    }
+
+  std::cout << "evals " << evals << " packetSize " << pktSize << std::endl;
+  std::cout << "analytic " << exactMs << " ms" << std::endl;
+  std::cout << "table " << tableMs << " ms" << std::endl;
+  std::cout << "maxAbsError " << maxErr << std::endl;
+
+  return 0;
+}
@@ -36,10 +36,13 @@
  * the gateway node transmits a CTS which contains packet transmission times
  * for reserved packets as well as bandwidth allocation information
  * 
- * This script deploys a single gateway node (current UanMacRc only supports
- * a single gateway) in the center of a region and then distributes
- * non-gateway nodes around the gateway with a uniformly distributed range
- * between each node and the gateway.
+ * This script deploys a single gateway node in the center of a region
+ * and then distributes non-gateway nodes around the gateway with a
+ * uniformly distributed range between each node and the gateway.
+ * With Gateways=n, n gateways are placed 500 m apart around the center,
+ * each running its cycles in its own band of TotalRate Hz, and the
+ * nodes spread their reservations over them.  Utilization is still given
+ * relative to a single band.
  * 
  * The script supports two simulation types.  By default the gateway
  * dynamically determines the optimal parameter settings and
@@ -73,13 +76,8 @@ Experiment::Experiment ()
   : m_simMin (1),
     m_simMax (1),
     m_simStep (1),
-    m_numRates (1023),
-    m_totalRate (4096),
-    m_maxRange (3000),
     m_numNodes (15),
-    m_pktSize (1000),
     m_doNode (true),
-    m_sifs (Seconds (0.05)),
     m_simTime (Seconds (5000)),
     m_gnuplotfile ("uan-rc-example.gpl"),
     m_bytesTotal (0)
@@ -96,61 +94,10 @@ Experiment::ReceivePacket (Ptr<Socket> socket)
     }
 }
 
-UanTxMode
-Experiment::CreateMode (uint32_t kass,
-                        uint32_t fc,
-                        bool upperblock,
-                        std::string name)
-{
-
-  std::ostringstream buf;
-  buf << name << " " << kass;
-
-  uint32_t rate = m_totalRate/(m_numRates+1)* (kass);
-  uint32_t bw = kass * m_totalRate / (m_numRates+1);
-  uint32_t fcmode;
-  if(upperblock)
-    fcmode = (m_totalRate - bw)/2 + fc;
-  else
-    fcmode = (uint32_t)((-((double) m_totalRate ) + (double) bw)/2.0 + (double) fc);
-
-
-  uint32_t phyrate = m_totalRate;
-
-  UanTxMode mode;
-  mode = UanTxModeFactory::CreateMode (UanTxMode::OTHER,
-                                       rate,
-                                       phyrate,
-                                       fcmode,
-                                       bw,
-                                       2,
-                                       buf.str());
-  return mode;
-}
-
-//Creates m_numRates different modes each dividing m_totalRate Hz (assumes 1 bit per hz)
-//centered at frequency fc
-void
-Experiment::CreateDualModes (uint32_t fc)
-{
-
-
-  for (uint32_t i=1; i < m_numRates+1; i++)
-    {
-      m_controlModes.AppendMode (CreateMode (i, fc, false, "control "));
-    }
-  for (uint32_t i=m_numRates; i > 0; i--)
-    {
-      m_dataModes.AppendMode (CreateMode (i, fc, true, "data "));
-    }
-}
-
 uint32_t
 Experiment::Run (uint32_t param)
 {
 
-  UanHelper uan;
-  
   m_bytesTotal=0;
 
   uint32_t nNodes;
@@ -165,85 +112,29 @@ Experiment::Run (uint32_t param)
       nNodes = m_numNodes;
       a = param;
     }
-  Time pDelay = Seconds((double) m_maxRange / 1500.0);
 
-  uan.SetPhy ("ns3::UanPhyDual",
-              "SupportedModesPhy1", UanModesListValue (m_dataModes),
-              "SupportedModesPhy2", UanModesListValue (m_controlModes));
-
-  uan.SetMac ("ns3::UanMacRcGw",
-              "NumberOfRates", UintegerValue (m_numRates),
-              "NumberOfNodes", UintegerValue (nNodes),
-              "MaxReservations", UintegerValue (a),
-              "RetryRate", DoubleValue(1/30.0),
-              "SIFS", TimeValue (m_sifs),
-              "MaxPropDelay", TimeValue (pDelay),
-              "FrameSize", UintegerValue (m_pktSize));
   Ptr<UanChannel> chan = CreateObject<UanChannel>();
 
   NodeContainer sink;
-  sink.Create(1);
-  NetDeviceContainer sinkDev = uan.Install(sink, chan);
-
-  uan.SetMac ("ns3::UanMacRc",
-              "NumberOfRates", UintegerValue (m_numRates),
-              "MaxPropDelay", TimeValue (pDelay),
-              "RetryRate", DoubleValue(1.0/100.0));
+  sink.Create (m_scenario.m_numGateways);
   NodeContainer nodes;
   nodes.Create (nNodes);
-  NetDeviceContainer devices = uan.Install (nodes, chan);
-
-  MobilityHelper mobility;
-  uint32_t depth = 70;
-  Ptr<ListPositionAllocator> pos = CreateObject<ListPositionAllocator> ();
-
-  UniformVariable urv (0,m_maxRange);
-  UniformVariable utheta (0, 2.0*M_PI);
-  pos->Add (Vector (m_maxRange, m_maxRange, depth));
-
-  for (uint32_t i=0; i<nNodes; i++)
-    {
-      double theta = utheta.GetValue ();
-      double r = urv.GetValue ();
-
-      double x = m_maxRange + r*std::cos (theta);
-      double y = m_maxRange + r*std::sin (theta);
-
-      pos->Add (Vector (x, y, depth));
-
-    }
-
-  mobility.SetPositionAllocator (pos);
-  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-  mobility.Install (sink);
-  mobility.Install (nodes);
-
-  PacketSocketHelper pktskth;
-  pktskth.Install (nodes);
-  pktskth.Install (sink);
-
-  PacketSocketAddress socket;
-  socket.SetSingleDevice (sinkDev.Get(0)->GetIfIndex ());
-  socket.SetPhysicalAddress (sinkDev.Get(0)->GetAddress ());
-  socket.SetProtocol (0);
-
-  OnOffHelper app ("ns3::PacketSocketFactory", Address (socket));
-  app.SetAttribute ("OnTime", RandomVariableValue (ConstantVariable (1)));
-  app.SetAttribute ("OffTime", RandomVariableValue (ConstantVariable (0)));
-  app.SetAttribute ("DataRate", DataRateValue (m_totalRate));
-  app.SetAttribute ("PacketSize", UintegerValue (m_pktSize));
-
-  ApplicationContainer apps = app.Install (nodes);
-
+  NetDeviceContainer sinkDev;
+  NetDeviceContainer devices;
+  m_scenario.Install (sink, nodes, chan, a, sinkDev, devices);
+  m_scenario.SetPositions (sink, nodes);
+
+  ApplicationContainer apps = UanExampleInstallTraffic (nodes, sink, sinkDev.Get (0),
+                                                        m_scenario.m_totalRate,
+                                                        m_scenario.m_frameSize);
   apps.Start (Seconds (0.5));
   apps.Stop (m_simTime + Seconds(0.5));
 
-  Ptr<Node> sinkNode = sink.Get (0);
-  TypeId psfid = TypeId::LookupByName ("ns3::PacketSocketFactory");
-
-  Ptr<Socket> sinkSocket = Socket::CreateSocket(sinkNode, psfid);
-  sinkSocket->Bind(socket);
-  sinkSocket->SetRecvCallback (MakeCallback (&Experiment::ReceivePacket, this));
+  // Nodes send to the gateway they chose, so listen at all of them
+  for (uint32_t g=0; g < m_scenario.m_numGateways; g++)
+    {
+      UanExampleCreateSink (sinkDev.Get (g), MakeCallback (&Experiment::ReceivePacket, this));
+    }
 
   Simulator::Stop (m_simTime + Seconds(0.6));
   Simulator::Run ();
@@ -260,23 +151,24 @@ main(int argc, char *argv[])
   Experiment exp;
 
   CommandLine cmd;
-  cmd.AddValue ("TotalRate", "Total channel capacity", exp.m_totalRate);
-  cmd.AddValue ("NumberRates", "Number of divided rates ( (NumberRates+1)%TotalRate should be 0)", exp.m_numRates);
-  cmd.AddValue ("MaxRange", "Maximum range between gateway and acoustic node", exp.m_maxRange);
+  cmd.AddValue ("TotalRate", "Total channel capacity", exp.m_scenario.m_totalRate);
+  cmd.AddValue ("NumberRates", "Number of divided rates ( (NumberRates+1)%TotalRate should be 0)", exp.m_scenario.m_numRates);
+  cmd.AddValue ("MaxRange", "Maximum range between gateway and acoustic node", exp.m_scenario.m_maxRange);
   cmd.AddValue ("SimMin", "Minimum parameter to test (nodes if DoNode=1, \"a\" param otherwise)", exp.m_simMin);
   cmd.AddValue ("SimMax", "Maximum parameter to test (nodes if DoNode=1, \"a\" param otherwise)", exp.m_simMax);
   cmd.AddValue ("SimStep", "Ammount to increment param per trial", exp.m_simStep);
   cmd.AddValue ("DataFile", "Filename for GnuPlot", exp.m_gnuplotfile);
   cmd.AddValue ("NumberNodes", "Number of nodes (invalid for doNode=1)", exp.m_numNodes);
-  cmd.AddValue ("SIFS", "SIFS time duration", exp.m_sifs);
-  cmd.AddValue ("PktSize", "Packet size in bytes", exp.m_pktSize);
+  cmd.AddValue ("Gateways", "Number of gateways, each with its own band", exp.m_scenario.m_numGateways);
+  cmd.AddValue ("SIFS", "SIFS time duration", exp.m_scenario.m_sifs);
+  cmd.AddValue ("PktSize", "Packet size in bytes", exp.m_scenario.m_frameSize);
   cmd.AddValue ("SimTime", "Simulation time per trial", exp.m_simTime);
   cmd.AddValue ("DoNode", "1 for do max nodes simulation (invalidates AMin and AMax values)", exp.m_doNode);
   cmd.Parse (argc, argv);
 
 
 
-  exp.CreateDualModes (12000);
+  exp.m_scenario.CreateDualModes (12000);
 
 ;
 
@@ -286,7 +178,7 @@ main(int argc, char *argv[])
       uint32_t bytesRx = exp.Run (param);
       NS_LOG_DEBUG ("param=" << param << ":  Received " << bytesRx << " bytes at sink");
 
-      double util = bytesRx*8.0/(exp.m_simTime.GetSeconds ()*exp.m_totalRate);
+      double util = bytesRx*8.0/(exp.m_simTime.GetSeconds ()*exp.m_scenario.m_totalRate);
 
       ds.Add (param, util);
 
@@ -26,6 +26,7 @@
 #include "ns3/contrib-module.h"
 #include "ns3/helper-module.h"
 #include "ns3/uan-module.h"
+#include "uan-example-scenario.h"
 
 using namespace ns3;
 
@@ -35,28 +36,16 @@ public:
   uint32_t m_simMin;
   uint32_t m_simMax;
   uint32_t m_simStep;
-  uint32_t m_numRates;
-  uint32_t m_totalRate;
-  uint32_t m_maxRange;
+  UanRcScenario m_scenario;
   uint32_t m_numNodes;
-  uint32_t m_pktSize;
   bool m_doNode;
-  Time m_sifs;
   Time m_simTime;
 
   std::string m_gnuplotfile;
 
   uint32_t m_bytesTotal;
 
-  UanModesList m_dataModes;
-  UanModesList m_controlModes;
-
   void ReceivePacket (Ptr<Socket> socket);
-  UanTxMode CreateMode (uint32_t kass,
-                        uint32_t fc,
-                        bool upperblock,
-                        std::string name);
-  void CreateDualModes (uint32_t fc);
   uint32_t Run (uint32_t param);
 
   Experiment();
@@ -0,0 +1,442 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+/**
+ * \file uan-sweep.cc
+ * \ingroup uan
+ *
+ * Runs a parameter sweep of the CW-MAC and/or RC-MAC scenarios of
+ * uan-cw-example and uan-rc-example (UanCwScenario and UanRcScenario,
+ * with a single RC-MAC gateway) with each (parameter, seed) point
+ * simulated in its own process.  Up to Jobs processes run at once.  For
+ * CW-MAC the parameter is the contention window, for RC-MAC it is the
+ * number of non-gateway nodes.
+ *
+ * Every finished run appends one line to the CSV file given by Output:
+ *
+ *   mac,param,seed,rxBytes,throughput,packets,meanLatency,maxLatency,wallMs
+ *
+ * with throughput in bps at the sink and latencies (from the sending
+ * net device to the sink socket) in seconds.  When Output already
+ * exists the runs it holds are skipped, so an interrupted sweep is
+ * resumed by running the same command again.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/common-module.h"
+#include "ns3/helper-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/node-module.h"
+#include "ns3/contrib-module.h"
+#include "ns3/uan-module.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/log.h"
+#include "uan-example-scenario.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("UanSweep");
+
+/**
+ * \brief One point of the sweep
+ */
+struct SweepJob
+{
+  std::string mac;
+  uint32_t param;
+  uint32_t seed;
+
+  /// \returns Key identifying the job in the output file
+  std::string GetKey (void) const
+  {
+    std::ostringstream key;
+    key << mac << "," << param << "," << seed;
+    return key.str ();
+  }
+};
+
+/**
+ * \class SweepRun
+ * \brief Builds and runs the simulation of a single sweep point
+ */
+class SweepRun
+{
+public:
+  SweepRun ();
+
+  /**
+   * \param job Sweep point to simulate
+   * \returns Result line (without newline) for the output file
+   */
+  std::string Run (const SweepJob &job);
+
+  UanCwScenario m_cw;
+  UanRcScenario m_rc;
+  uint32_t m_numNodes;
+  uint32_t m_packetSize;
+  Time m_slotTime;
+  Time m_simTime;
+
+private:
+  void RunCw (uint32_t cw);
+  void RunRc (uint32_t nNodes);
+  void InstallTraffic (NodeContainer &nodes, NodeContainer &sink, Ptr<NetDevice> sinkDev,
+                       NetDeviceContainer &devices, uint32_t dataRate);
+  void DeviceTx (Ptr<const Packet> pkt, UanAddress dest);
+  void ReceivePacket (Ptr<Socket> socket);
+
+  uint64_t m_bytesTotal;
+  uint32_t m_packets;
+  double m_latencySum;
+  double m_latencyMax;
+  /// Send time of packets not yet received, by packet uid
+  std::map<uint32_t, Time> m_sent;
+};
+
+SweepRun::SweepRun ()
+  : m_numNodes (6),
+    m_packetSize (32),
+    m_slotTime (Seconds (0.2)),
+    m_simTime (Seconds (1000)),
+    m_bytesTotal (0),
+    m_packets (0),
+    m_latencySum (0),
+    m_latencyMax (0)
+{
+}
+
+void
+SweepRun::DeviceTx (Ptr<const Packet> pkt, UanAddress dest)
+{
+  m_sent[pkt->GetUid ()] = Simulator::Now ();
+}
+
+void
+SweepRun::ReceivePacket (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while (packet = socket->Recv ())
+    {
+      m_bytesTotal += packet->GetSize ();
+      std::map<uint32_t, Time>::iterator it = m_sent.find (packet->GetUid ());
+      if (it != m_sent.end ())
+        {
+          double latency = (Simulator::Now () - it->second).GetSeconds ();
+          m_latencySum += latency;
+          m_latencyMax = std::max (m_latencyMax, latency);
+          m_packets++;
+          m_sent.erase (it);
+        }
+    }
+}
+
+void
+SweepRun::InstallTraffic (NodeContainer &nodes, NodeContainer &sink, Ptr<NetDevice> sinkDev,
+                          NetDeviceContainer &devices, uint32_t dataRate)
+{
+  ApplicationContainer apps = UanExampleInstallTraffic (nodes, sink, sinkDev, dataRate, m_packetSize);
+  apps.Start (Seconds (0.5));
+  apps.Stop (m_simTime + Seconds (0.5));
+
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      devices.Get (i)->TraceConnectWithoutContext ("Tx", MakeCallback (&SweepRun::DeviceTx, this));
+    }
+  UanExampleCreateSink (sinkDev, MakeCallback (&SweepRun::ReceivePacket, this));
+}
+
+void
+SweepRun::RunCw (uint32_t cw)
+{
+  UanHelper uan;
+  UanModesList myModes;
+  myModes.AppendMode (m_cw.CreateMode ());
+  uan.SetPhy ("ns3::UanPhyGen", "SupportedModes", UanModesListValue (myModes));
+  uan.SetMac ("ns3::UanMacCw", "CW", UintegerValue (cw), "SlotTime", TimeValue (m_slotTime));
+
+  NodeContainer nodes;
+  NodeContainer sink;
+  nodes.Create (m_numNodes);
+  sink.Create (1);
+
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+  NetDeviceContainer devices = uan.Install (nodes, channel);
+  NetDeviceContainer sinkDev = uan.Install (sink, channel);
+  m_cw.SetPositions (sink, nodes);
+
+  InstallTraffic (nodes, sink, sinkDev.Get (0), devices, m_cw.m_dataRate);
+
+  Simulator::Stop (m_simTime + Seconds (0.6));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+SweepRun::RunRc (uint32_t nNodes)
+{
+  m_rc.m_frameSize = m_packetSize;
+  m_rc.CreateDualModes (12000);
+
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+  NodeContainer sink;
+  sink.Create (1);
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  NetDeviceContainer sinkDev;
+  NetDeviceContainer devices;
+  m_rc.Install (sink, nodes, channel, 0, sinkDev, devices);
+  m_rc.SetPositions (sink, nodes);
+
+  InstallTraffic (nodes, sink, sinkDev.Get (0), devices, m_rc.m_totalRate);
+
+  Simulator::Stop (m_simTime + Seconds (0.6));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+std::string
+SweepRun::Run (const SweepJob &job)
+{
+  SeedManager::SetRun (job.seed);
+  m_bytesTotal = 0;
+  m_packets = 0;
+  m_latencySum = 0;
+  m_latencyMax = 0;
+  m_sent.clear ();
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  if (job.mac == "cw")
+    {
+      RunCw (job.param);
+    }
+  else if (job.mac == "rc")
+    {
+      RunRc (job.param);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown MAC " << job.mac << " (must be cw or rc)");
+    }
+  unsigned long long wallMs = clock.End ();
+  if (m_bytesTotal > 0 && m_packets == 0)
+    {
+      // Every received packet went through a device Tx trace, so none
+      // matching means the latency columns would be meaningless zeros
+      NS_FATAL_ERROR ("Run " << job.GetKey () << " received " << m_bytesTotal
+                             << " bytes but measured no latency");
+    }
+
+  std::ostringstream line;
+  line << job.GetKey () << ","
+       << m_bytesTotal << ","
+       << m_bytesTotal * 8.0 / m_simTime.GetSeconds () << ","
+       << m_packets << ","
+       << (m_packets == 0 ? 0.0 : m_latencySum / m_packets) << ","
+       << m_latencyMax << ","
+       << wallMs;
+  return line.str ();
+}
+
+/**
+ * \param fileName Name of output file of an earlier (possibly partial) sweep
+ * \returns Keys of the runs already recorded in fileName
+ */
+static std::set<std::string>
+ReadFinished (std::string fileName)
+{
+  std::set<std::string> done;
+  std::ifstream in (fileName.c_str ());
+  std::string line;
+  while (std::getline (in, line))
+    {
+      // Key is the first three fields; anything shorter is a header or a truncated line
+      std::string::size_type end = 0;
+      uint32_t fields = 0;
+      while (fields < 3 && (end = line.find (',', end)) != std::string::npos)
+        {
+          fields++;
+          end++;
+        }
+      if (fields == 3 && line.find (',', end) != std::string::npos)
+        {
+          done.insert (line.substr (0, end - 1));
+        }
+    }
+  return done;
+}
+
+int
+main (int argc, char **argv)
+{
+  SweepRun run;
+  std::string mac = "cw";
+  uint32_t paramMin = 10;
+  uint32_t paramMax = 100;
+  uint32_t paramStep = 10;
+  uint32_t seeds = 3;
+  uint32_t jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  std::string outFile = "uan-sweep.csv";
+
+  CommandLine cmd;
+  cmd.AddValue ("Mac", "MAC to sweep: cw (parameter is CW), rc (parameter is nodes) or both", mac);
+  cmd.AddValue ("ParamMin", "First parameter value", paramMin);
+  cmd.AddValue ("ParamMax", "Last parameter value", paramMax);
+  cmd.AddValue ("ParamStep", "Parameter increment", paramStep);
+  cmd.AddValue ("Seeds", "Number of runs (seeds 1..Seeds) per parameter value", seeds);
+  cmd.AddValue ("Jobs", "Maximum number of simulations run in parallel", jobs);
+  cmd.AddValue ("Output", "CSV file results are appended to (runs found in it are skipped)", outFile);
+  cmd.AddValue ("NumNodes", "Number of transmitting nodes (cw)", run.m_numNodes);
+  cmd.AddValue ("DataRate", "DataRate in bps (cw)", run.m_cw.m_dataRate);
+  cmd.AddValue ("PacketSize", "Packet size in bytes", run.m_packetSize);
+  cmd.AddValue ("SlotTime", "Slot time duration (cw)", run.m_slotTime);
+  cmd.AddValue ("SimTime", "Simulation time per run", run.m_simTime);
+  cmd.AddValue ("TotalRate", "Total channel capacity (rc)", run.m_rc.m_totalRate);
+  cmd.AddValue ("NumberRates", "Number of divided rates (rc)", run.m_rc.m_numRates);
+  cmd.AddValue ("MaxRange", "Maximum range between gateway and acoustic node (rc)", run.m_rc.m_maxRange);
+  cmd.Parse (argc, argv);
+
+  if (paramStep == 0 || jobs == 0)
+    {
+      NS_FATAL_ERROR ("ParamStep and Jobs must be positive");
+    }
+  if (mac != "cw" && mac != "rc" && mac != "both")
+    {
+      NS_FATAL_ERROR ("Unknown MAC " << mac << " (must be cw, rc or both)");
+    }
+
+  std::set<std::string> done = ReadFinished (outFile);
+  std::list<SweepJob> pending;
+  for (uint32_t m = 0; m < 2; m++)
+    {
+      std::string name = m == 0 ? "cw" : "rc";
+      if (mac != name && mac != "both")
+        {
+          continue;
+        }
+      for (uint32_t param = paramMin; param <= paramMax; param += paramStep)
+        {
+          for (uint32_t seed = 1; seed <= seeds; seed++)
+            {
+              SweepJob job;
+              job.mac = name;
+              job.param = param;
+              job.seed = seed;
+              if (done.find (job.GetKey ()) == done.end ())
+                {
+                  pending.push_back (job);
+                }
+            }
+        }
+    }
+  NS_LOG_INFO (done.size () << " runs already in " << outFile << ", " << pending.size () << " to go");
+
+  bool newFile = done.empty () && !std::ifstream (outFile.c_str ()).good ();
+  std::ofstream out (outFile.c_str (), std::ios::app);
+  if (!out.is_open ())
+    {
+      NS_FATAL_ERROR ("Can not open output file: " << outFile);
+    }
+  if (newFile)
+    {
+      out << "mac,param,seed,rxBytes,throughput,packets,meanLatency,maxLatency,wallMs" << std::endl;
+    }
+
+  // Each run is simulated in a forked child which writes its result line
+  // (well below PIPE_BUF, so the write never blocks) to a pipe and exits.
+  // The parent never touches the simulator, so every child starts clean.
+  std::map<pid_t, std::pair<int, SweepJob> > running;
+  uint32_t failed = 0;
+  while (!pending.empty () || !running.empty ())
+    {
+      while (!pending.empty () && running.size () < jobs)
+        {
+          SweepJob job = pending.front ();
+          pending.pop_front ();
+          int fds[2];
+          if (pipe (fds) != 0)
+            {
+              NS_FATAL_ERROR ("pipe failed: " << errno);
+            }
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("fork failed: " << errno);
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              std::string line = run.Run (job) + "\n";
+              ssize_t written = write (fds[1], line.data (), line.size ());
+              _exit (written == (ssize_t) line.size () ? 0 : 1);
+            }
+          close (fds[1]);
+          running[pid] = std::make_pair (fds[0], job);
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("waitpid failed: " << errno);
+        }
+      std::map<pid_t, std::pair<int, SweepJob> >::iterator it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      std::string line;
+      char buf[512];
+      ssize_t n;
+      while ((n = read (it->second.first, buf, sizeof (buf))) > 0)
+        {
+          line.append (buf, n);
+        }
+      close (it->second.first);
+
+      if (WIFEXITED (status) && WEXITSTATUS (status) == 0 && !line.empty ())
+        {
+          // Flushed per run so that an interrupted sweep loses no finished runs
+          out << line << std::flush;
+          NS_LOG_INFO ("Finished " << it->second.second.GetKey ());
+        }
+      else
+        {
+          failed++;
+          std::cerr << "Run " << it->second.second.GetKey () << " failed" << std::endl;
+        }
+      running.erase (it);
+    }
+
+  return failed == 0 ? 0 : 1;
+}
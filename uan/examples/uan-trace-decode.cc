@@ -0,0 +1,77 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+/**
+ * \file uan-trace-decode.cc
+ * \ingroup uan
+ *
+ * Converts a binary trace written by UanTraceWriter (see
+ * UanHelper::EnableBinary) to text, one line per record.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/uan-module.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+
+int
+main (int argc, char **argv)
+{
+  std::string in;
+  std::string out;
+
+  CommandLine cmd;
+  cmd.AddValue ("In", "Binary trace file to decode", in);
+  cmd.AddValue ("Out", "Text file to write (stdout if empty)", out);
+  cmd.Parse (argc, argv);
+
+  if (in.empty ())
+    {
+      std::cerr << "Usage: uan-trace-decode --In=trace.tr [--Out=trace.txt]" << std::endl;
+      return 1;
+    }
+
+  std::ifstream is (in.c_str (), std::ios::in | std::ios::binary);
+  if (!is.is_open ())
+    {
+      std::cerr << "Could not open " << in << std::endl;
+      return 1;
+    }
+  std::ofstream file;
+  if (!out.empty ())
+    {
+      file.open (out.c_str ());
+      if (!file.is_open ())
+        {
+          std::cerr << "Could not open " << out << std::endl;
+          return 1;
+        }
+    }
+
+  if (!UanTraceWriter::Decode (is, out.empty () ? std::cout : file))
+    {
+      std::cerr << in << " is not a valid UAN trace (or is truncated)" << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -34,6 +34,7 @@
 #include "ns3/log.h"
 #include "ns3/uan-tx-mode.h"
 #include "ns3/config.h"
+#include "ns3/boolean.h"
 #include "ns3/simulator.h"
 #include "ns3/uan-noise-model-default.h"
 
@@ -187,6 +188,39 @@ UanHelper::EnableAsciiAll (std::ostream &os)
   EnableAscii (os, NodeContainer::GetGlobal ());
 }
 
+Ptr<UanTraceWriter>
+UanHelper::EnableBinary (std::string fileName, NetDeviceContainer d, bool compress)
+{
+  Ptr<UanTraceWriter> writer = CreateObject<UanTraceWriter> ();
+  writer->SetAttribute ("Compress", BooleanValue (compress));
+  writer->Open (fileName);
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      Ptr<UanNetDevice> dev = (*i)->GetObject<UanNetDevice> ();
+      if (dev != 0)
+        {
+          writer->Connect (dev);
+        }
+    }
+  return writer;
+}
+
+Ptr<UanTraceWriter>
+UanHelper::EnableBinaryAll (std::string fileName, bool compress)
+{
+  NetDeviceContainer devs;
+  NodeContainer n = NodeContainer::GetGlobal ();
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+    }
+  return EnableBinary (fileName, devs, compress);
+}
+
 NetDeviceContainer
 UanHelper::Install (NodeContainer c) const
 {
@@ -27,6 +27,7 @@
 #include "ns3/object-factory.h"
 #include "ns3/node-container.h"
 #include "ns3/net-device-container.h"
+#include "uan-trace-writer.h"
 
 namespace ns3
 {
@@ -175,6 +176,26 @@ public:
    */
   static void EnableAsciiAll (std::ostream &os);
 
+  /**
+   * \param fileName name of binary trace file
+   * \param d device container
+   * \param compress use the compressed record format
+   * \returns the writer, which flushes and closes the file at Simulator::Destroy
+   *
+   * Enable binary tracing (see ns3::UanTraceWriter) of the PHY of each
+   * ns3::UanNetDevice in the input device container.  This is much
+   * cheaper than ascii tracing and does not need packet printing.
+   */
+  static Ptr<UanTraceWriter> EnableBinary (std::string fileName, NetDeviceContainer d, bool compress = false);
+  /**
+   * \param fileName name of binary trace file
+   * \param compress use the compressed record format
+   * \returns the writer, which flushes and closes the file at Simulator::Destroy
+   *
+   * Enable binary tracing of every ns3::UanNetDevice.
+   */
+  static Ptr<UanTraceWriter> EnableBinaryAll (std::string fileName, bool compress = false);
+
   /**
    * \param c a set of nodes
    *
@@ -0,0 +1,372 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-stats-collector.h"
+#include "ns3/uan-phy.h"
+#include "ns3/uan-mac.h"
+#include "ns3/uan-header-common.h"
+#include "ns3/uan-mac-rc.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("UanStatsCollector");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanStatsCollector);
+
+UanStatsCollector::Histogram::Histogram ()
+  : m_min (0),
+    m_width (1)
+{
+}
+
+UanStatsCollector::Histogram::Histogram (double min, double max, double width)
+  : m_min (min),
+    m_width (width),
+    m_bins ((uint32_t) std::ceil ((max - min) / width) + 2, 0)
+{
+  NS_ASSERT (width > 0 && max > min);
+}
+
+void
+UanStatsCollector::Histogram::Add (double x)
+{
+  if (m_bins.empty ())
+    {
+      return;
+    }
+  double bin = std::floor ((x - m_min) / m_width) + 1;
+  uint32_t last = m_bins.size () - 1;
+  if (bin < 0)
+    {
+      m_bins[0]++;
+    }
+  else if (bin >= last)
+    {
+      m_bins[last]++;
+    }
+  else
+    {
+      m_bins[(uint32_t) bin]++;
+    }
+}
+
+const std::vector<uint32_t> &
+UanStatsCollector::Histogram::GetBins (void) const
+{
+  return m_bins;
+}
+
+UanStatsCollector::Sink::Sink (UanStatsCollector *collector, uint32_t node, UanAddress address)
+  : m_collector (collector),
+    m_node (node),
+    m_address (address),
+    m_requestPending (false)
+{
+}
+
+void
+UanStatsCollector::Sink::Tx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode)
+{
+  m_collector->Tx (*this, pkt, mode);
+}
+
+void
+UanStatsCollector::Sink::RxOk (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode)
+{
+  m_collector->Rx (*this, pkt, sinrDb, true);
+}
+
+void
+UanStatsCollector::Sink::RxError (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode)
+{
+  m_collector->Rx (*this, pkt, sinrDb, false);
+}
+
+UanStatsCollector::UanStatsCollector ()
+  : m_sinrMin (-10),
+    m_sinrMax (40),
+    m_sinrBinWidth (1),
+    m_latencyMax (Seconds (60)),
+    m_latencyBinWidth (Seconds (0.5)),
+    m_requestType (UanMacRc::TYPE_RTS),
+    m_responseType (UanMacRc::TYPE_CTS),
+    m_started (false),
+    m_nHandshakes (0),
+    m_latencySum (0),
+    m_latencyMinS (0),
+    m_latencyMaxS (0)
+{
+}
+
+UanStatsCollector::~UanStatsCollector ()
+{
+}
+
+TypeId
+UanStatsCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UanStatsCollector")
+    .SetParent<Object> ()
+    .AddConstructor<UanStatsCollector> ()
+    .AddAttribute ("SinrMin",
+                   "Lower edge (dB) of the SINR histograms (lower values go to an underflow bin).",
+                   DoubleValue (-10),
+                   MakeDoubleAccessor (&UanStatsCollector::m_sinrMin),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SinrMax",
+                   "Upper edge (dB) of the SINR histograms (higher values go to an overflow bin).",
+                   DoubleValue (40),
+                   MakeDoubleAccessor (&UanStatsCollector::m_sinrMax),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SinrBinWidth",
+                   "Bin width (dB) of the SINR histograms.",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&UanStatsCollector::m_sinrBinWidth),
+                   MakeDoubleChecker<double> (1e-3))
+    .AddAttribute ("LatencyMax",
+                   "Upper edge of the handshake latency histogram.",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&UanStatsCollector::m_latencyMax),
+                   MakeTimeChecker ())
+    .AddAttribute ("LatencyBinWidth",
+                   "Bin width of the handshake latency histogram.",
+                   TimeValue (Seconds (0.5)),
+                   MakeTimeAccessor (&UanStatsCollector::m_latencyBinWidth),
+                   MakeTimeChecker ())
+    .AddAttribute ("RequestType",
+                   "UanHeaderCommon type of the packet starting a handshake.",
+                   UintegerValue (UanMacRc::TYPE_RTS),
+                   MakeUintegerAccessor (&UanStatsCollector::m_requestType),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("ResponseType",
+                   "UanHeaderCommon type of the packet completing a handshake.",
+                   UintegerValue (UanMacRc::TYPE_CTS),
+                   MakeUintegerAccessor (&UanStatsCollector::m_responseType),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("OutputFile",
+                   "File the summary is written to at Simulator::Destroy (standard output if empty).",
+                   StringValue (""),
+                   MakeStringAccessor (&UanStatsCollector::m_outputFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+void
+UanStatsCollector::DoDispose (void)
+{
+  m_sinks.clear ();
+  Object::DoDispose ();
+}
+
+void
+UanStatsCollector::Install (Ptr<UanNetDevice> dev)
+{
+  if (!m_started)
+    {
+      m_started = true;
+      m_startTime = Simulator::Now ();
+      m_latency = Histogram (0, m_latencyMax.GetSeconds (), m_latencyBinWidth.GetSeconds ());
+      Simulator::ScheduleDestroy (&UanStatsCollector::Dump, Ptr<UanStatsCollector> (this));
+    }
+
+  UanAddress address = UanAddress::ConvertFrom (dev->GetMac ()->GetAddress ());
+  Ptr<Sink> sink = Create<Sink> (this, dev->GetNode ()->GetId (), address);
+  m_sinks.push_back (sink);
+  Ptr<UanPhy> phy = dev->GetPhy ();
+  phy->TraceConnectWithoutContext ("Tx", MakeCallback (&Sink::Tx, PeekPointer (sink)));
+  phy->TraceConnectWithoutContext ("RxOk", MakeCallback (&Sink::RxOk, PeekPointer (sink)));
+  phy->TraceConnectWithoutContext ("RxError", MakeCallback (&Sink::RxError, PeekPointer (sink)));
+}
+
+void
+UanStatsCollector::Install (NetDeviceContainer d)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      Ptr<UanNetDevice> dev = (*i)->GetObject<UanNetDevice> ();
+      if (dev != 0)
+        {
+          Install (dev);
+        }
+    }
+}
+
+void
+UanStatsCollector::Tx (Sink &sink, Ptr<const Packet> pkt, UanTxMode mode)
+{
+  m_airtime[mode.GetUid ()] += pkt->GetSize () * 8.0 / mode.GetDataRateBps ();
+
+  UanHeaderCommon ch;
+  pkt->PeekHeader (ch);
+  if (ch.GetType () == m_requestType && !sink.m_requestPending)
+    {
+      sink.m_requestPending = true;
+      sink.m_requestTime = Simulator::Now ();
+    }
+}
+
+void
+UanStatsCollector::Rx (Sink &sink, Ptr<const Packet> pkt, double sinrDb, bool ok)
+{
+  UanHeaderCommon ch;
+  pkt->PeekHeader (ch);
+
+  LinkKey key (ch.GetSrc ().GetAsInt (), sink.m_node);
+  std::map<LinkKey, LinkStats>::iterator it = m_links.find (key);
+  if (it == m_links.end ())
+    {
+      LinkStats stats;
+      stats.rxOk = 0;
+      stats.rxError = 0;
+      stats.sinrSum = 0;
+      stats.sinr = Histogram (m_sinrMin, m_sinrMax, m_sinrBinWidth);
+      it = m_links.insert (std::make_pair (key, stats)).first;
+    }
+  LinkStats &stats = it->second;
+  if (ok)
+    {
+      stats.rxOk++;
+    }
+  else
+    {
+      stats.rxError++;
+    }
+  stats.sinrSum += sinrDb;
+  stats.sinr.Add (sinrDb);
+
+  if (ok && ch.GetType () == m_responseType && sink.m_requestPending
+      && (ch.GetDest () == sink.m_address || ch.GetDest () == UanAddress::GetBroadcast ()))
+    {
+      double latency = (Simulator::Now () - sink.m_requestTime).GetSeconds ();
+      sink.m_requestPending = false;
+      m_latencyMinS = m_nHandshakes == 0 ? latency : std::min (m_latencyMinS, latency);
+      m_latencyMaxS = std::max (m_latencyMaxS, latency);
+      m_latencySum += latency;
+      m_nHandshakes++;
+      m_latency.Add (latency);
+    }
+}
+
+UanStatsCollector::LinkStats
+UanStatsCollector::GetLinkStats (UanAddress src, uint32_t node) const
+{
+  std::map<LinkKey, LinkStats>::const_iterator it = m_links.find (LinkKey (src.GetAsInt (), node));
+  if (it != m_links.end ())
+    {
+      return it->second;
+    }
+  LinkStats stats;
+  stats.rxOk = 0;
+  stats.rxError = 0;
+  stats.sinrSum = 0;
+  return stats;
+}
+
+Time
+UanStatsCollector::GetAirtime (uint32_t modeUid) const
+{
+  std::map<uint32_t, double>::const_iterator it = m_airtime.find (modeUid);
+  return Seconds (it == m_airtime.end () ? 0.0 : it->second);
+}
+
+uint32_t
+UanStatsCollector::GetNHandshakes (void) const
+{
+  return m_nHandshakes;
+}
+
+Time
+UanStatsCollector::GetMeanHandshakeLatency (void) const
+{
+  return Seconds (m_nHandshakes == 0 ? 0.0 : m_latencySum / m_nHandshakes);
+}
+
+void
+UanStatsCollector::Print (std::ostream &os) const
+{
+  for (std::map<LinkKey, LinkStats>::const_iterator it = m_links.begin (); it != m_links.end (); it++)
+    {
+      const LinkStats &stats = it->second;
+      uint32_t total = stats.rxOk + stats.rxError;
+      os << "link src " << (uint32_t) it->first.first
+         << " node " << it->first.second
+         << " ok " << stats.rxOk
+         << " error " << stats.rxError
+         << " pdr " << (double) stats.rxOk / total
+         << " meanSinr " << stats.sinrSum / total
+         << " sinrHist";
+      const std::vector<uint32_t> &bins = stats.sinr.GetBins ();
+      for (uint32_t i = 0; i < bins.size (); i++)
+        {
+          os << " " << bins[i];
+        }
+      os << std::endl;
+    }
+
+  double elapsed = (Simulator::Now () - m_startTime).GetSeconds ();
+  for (std::map<uint32_t, double>::const_iterator it = m_airtime.begin (); it != m_airtime.end (); it++)
+    {
+      os << "mode " << it->first
+         << " airtime " << it->second
+         << " utilization " << (elapsed > 0 ? it->second / elapsed : 0.0) << std::endl;
+    }
+
+  os << "handshake count " << m_nHandshakes
+     << " mean " << GetMeanHandshakeLatency ().GetSeconds ()
+     << " min " << m_latencyMinS
+     << " max " << m_latencyMaxS
+     << " hist";
+  const std::vector<uint32_t> &bins = m_latency.GetBins ();
+  for (uint32_t i = 0; i < bins.size (); i++)
+    {
+      os << " " << bins[i];
+    }
+  os << std::endl;
+}
+
+void
+UanStatsCollector::Dump (void)
+{
+  if (m_outputFile.empty ())
+    {
+      Print (std::cout);
+      return;
+    }
+  std::ofstream of (m_outputFile.c_str ());
+  if (!of.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open statistics file " << m_outputFile);
+    }
+  Print (of);
+}
+
+} // namespace ns3
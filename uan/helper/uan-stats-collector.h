@@ -0,0 +1,195 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANSTATSCOLLECTOR_H
+#define UANSTATSCOLLECTOR_H
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/uan-tx-mode.h"
+#include "ns3/uan-address.h"
+#include "ns3/uan-net-device.h"
+#include "ns3/net-device-container.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \class UanStatsCollector
+ * \brief Aggregates per-link and per-mode statistics from the PHY trace sources
+ *
+ * Subscribes to the Tx, RxOk and RxError trace sources of the PHY of each
+ * installed device and keeps, in memory independent of the length of
+ * the simulation:
+ *
+ *  - per link (source MAC address, receiving node): receptions without
+ *    and with error, hence PDR of the detected packets, and a histogram
+ *    of the reception SINR
+ *  - per TX mode (channel): airtime and utilization since installation
+ *  - handshake latency: the time from a node's first transmission of a
+ *    packet of type RequestType to its reception of a packet of type
+ *    ResponseType addressed to it (or broadcast), as a histogram plus
+ *    mean, minimum and maximum.  The defaults match the RTS and CTS of
+ *    UanMacRc; use 1 and 2 for UanMacCumac.
+ *
+ * Source address and packet type are read from the UanHeaderCommon all
+ * UAN MACs put in front of their packets.  The summary is written to
+ * OutputFile (std::cout if empty) at Simulator::Destroy.
+ */
+class UanStatsCollector : public Object
+{
+public:
+  /**
+   * \brief Fixed bin histogram with underflow and overflow bins
+   */
+  class Histogram
+  {
+  public:
+    Histogram ();
+    /**
+     * \param min Lower edge of first regular bin
+     * \param max Upper edge of last regular bin
+     * \param width Bin width
+     */
+    Histogram (double min, double max, double width);
+    /**
+     * \param x Value to add
+     */
+    void Add (double x);
+    /**
+     * \returns Counts: underflow, regular bins in increasing order, overflow
+     */
+    const std::vector<uint32_t> &GetBins (void) const;
+  private:
+    double m_min;
+    double m_width;
+    std::vector<uint32_t> m_bins;
+  };
+
+  /**
+   * \brief Counters of one link
+   */
+  struct LinkStats
+  {
+    uint32_t rxOk;
+    uint32_t rxError;
+    double sinrSum;
+    Histogram sinr;
+  };
+
+  UanStatsCollector ();
+  virtual ~UanStatsCollector ();
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param dev Device whose PHY is observed
+   */
+  void Install (Ptr<UanNetDevice> dev);
+  /**
+   * \param d Devices whose PHYs are observed (non UAN devices are skipped)
+   */
+  void Install (NetDeviceContainer d);
+
+  /**
+   * \param src MAC address of sender
+   * \param node Id of receiving node
+   * \returns Statistics of the link (all zero if nothing was received on it)
+   */
+  LinkStats GetLinkStats (UanAddress src, uint32_t node) const;
+  /**
+   * \param modeUid Uid of TX mode
+   * \returns Total transmission time in mode modeUid
+   */
+  Time GetAirtime (uint32_t modeUid) const;
+  /**
+   * \returns Number of handshakes completed
+   */
+  uint32_t GetNHandshakes (void) const;
+  /**
+   * \returns Mean handshake latency (zero if there were none)
+   */
+  Time GetMeanHandshakeLatency (void) const;
+
+  /**
+   * Writes the summary
+   * \param os Stream to write to
+   */
+  void Print (std::ostream &os) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Trace sink for one device
+   */
+  class Sink : public SimpleRefCount<Sink>
+  {
+  public:
+    Sink (UanStatsCollector *collector, uint32_t node, UanAddress address);
+    void Tx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode);
+    void RxOk (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode);
+    void RxError (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode);
+
+    UanStatsCollector *m_collector;
+    uint32_t m_node;
+    UanAddress m_address;
+    /// True if a request has been sent and not yet answered
+    bool m_requestPending;
+    /// Time of the first unanswered request
+    Time m_requestTime;
+  };
+
+  typedef std::pair<uint8_t, uint32_t> LinkKey;
+
+  void Tx (Sink &sink, Ptr<const Packet> pkt, UanTxMode mode);
+  void Rx (Sink &sink, Ptr<const Packet> pkt, double sinrDb, bool ok);
+  void Dump (void);
+
+  double m_sinrMin;
+  double m_sinrMax;
+  double m_sinrBinWidth;
+  Time m_latencyMax;
+  Time m_latencyBinWidth;
+  uint32_t m_requestType;
+  uint32_t m_responseType;
+  std::string m_outputFile;
+
+  bool m_started;
+  Time m_startTime;
+  std::vector<Ptr<Sink> > m_sinks;
+  std::map<LinkKey, LinkStats> m_links;
+  /// Airtime in seconds per mode uid
+  std::map<uint32_t, double> m_airtime;
+  uint32_t m_nHandshakes;
+  double m_latencySum;
+  double m_latencyMinS;
+  double m_latencyMaxS;
+  Histogram m_latency;
+};
+
+} // namespace ns3
+
+#endif // UANSTATSCOLLECTOR_H
@@ -0,0 +1,347 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-trace-writer.h"
+#include "ns3/uan-phy.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+
+#include <cstring>
+#include <iomanip>
+
+NS_LOG_COMPONENT_DEFINE ("UanTraceWriter");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanTraceWriter);
+
+static const char g_traceMagic[8] = { 'U', 'A', 'N', 'T', 'R', 'A', 'C', 'E' };
+static const uint32_t TRACE_VERSION = 1;
+static const uint32_t FORMAT_PLAIN = 0;
+static const uint32_t FORMAT_COMPRESSED = 1;
+static const uint32_t PLAIN_RECORD_SIZE = 32;
+
+UanTraceWriter::Source::Source (UanTraceWriter *writer, uint32_t node)
+  : m_writer (writer),
+    m_node (node)
+{
+}
+
+void
+UanTraceWriter::Source::Tx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode)
+{
+  m_writer->Write (TX, m_node, pkt, txPowerDb, mode);
+}
+
+void
+UanTraceWriter::Source::RxOk (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode)
+{
+  m_writer->Write (RX_OK, m_node, pkt, sinrDb, mode);
+}
+
+void
+UanTraceWriter::Source::RxError (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode)
+{
+  m_writer->Write (RX_ERROR, m_node, pkt, sinrDb, mode);
+}
+
+UanTraceWriter::UanTraceWriter ()
+  : m_bufferSize (1 << 20),
+    m_compress (false),
+    m_used (0),
+    m_lastNs (0),
+    m_nRecords (0)
+{
+}
+
+UanTraceWriter::~UanTraceWriter ()
+{
+}
+
+TypeId
+UanTraceWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UanTraceWriter")
+    .SetParent<Object> ()
+    .AddConstructor<UanTraceWriter> ()
+    .AddAttribute ("BufferSize",
+                   "Number of bytes of records collected before writing to the file.",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&UanTraceWriter::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (64))
+    .AddAttribute ("Compress",
+                   "Write variable length, delta encoded records instead of fixed size records.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UanTraceWriter::m_compress),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+void
+UanTraceWriter::DoDispose (void)
+{
+  Close ();
+  m_sources.clear ();
+  Object::DoDispose ();
+}
+
+void
+UanTraceWriter::Open (std::string fileName)
+{
+  NS_ASSERT (!m_file.is_open ());
+  m_file.open (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open trace file " << fileName);
+    }
+  m_buffer.resize (m_bufferSize);
+  m_used = 0;
+  m_lastNs = 0;
+  m_nRecords = 0;
+
+  uint32_t version = TRACE_VERSION;
+  uint32_t format = m_compress ? FORMAT_COMPRESSED : FORMAT_PLAIN;
+  Put (g_traceMagic, sizeof (g_traceMagic));
+  Put (&version, sizeof (version));
+  Put (&format, sizeof (format));
+
+  Simulator::ScheduleDestroy (&UanTraceWriter::Close, Ptr<UanTraceWriter> (this));
+}
+
+void
+UanTraceWriter::Connect (Ptr<UanNetDevice> dev)
+{
+  Ptr<Source> source = Create<Source> (this, dev->GetNode ()->GetId ());
+  m_sources.push_back (source);
+  Ptr<UanPhy> phy = dev->GetPhy ();
+  phy->TraceConnectWithoutContext ("Tx", MakeCallback (&Source::Tx, PeekPointer (source)));
+  phy->TraceConnectWithoutContext ("RxOk", MakeCallback (&Source::RxOk, PeekPointer (source)));
+  phy->TraceConnectWithoutContext ("RxError", MakeCallback (&Source::RxError, PeekPointer (source)));
+}
+
+void
+UanTraceWriter::Close (void)
+{
+  if (m_file.is_open ())
+    {
+      Flush ();
+      m_file.close ();
+    }
+}
+
+uint64_t
+UanTraceWriter::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+void
+UanTraceWriter::Flush (void)
+{
+  m_file.write (&m_buffer[0], m_used);
+  m_used = 0;
+}
+
+void
+UanTraceWriter::Put (const void *data, uint32_t len)
+{
+  if (m_used + len > m_buffer.size ())
+    {
+      Flush ();
+    }
+  std::memcpy (&m_buffer[m_used], data, len);
+  m_used += len;
+}
+
+void
+UanTraceWriter::PutVarint (uint64_t v)
+{
+  uint8_t bytes[10];
+  uint32_t n = 0;
+  do
+    {
+      bytes[n] = v & 0x7f;
+      v >>= 7;
+      if (v != 0)
+        {
+          bytes[n] |= 0x80;
+        }
+      n++;
+    }
+  while (v != 0);
+  Put (bytes, n);
+}
+
+void
+UanTraceWriter::Write (uint8_t type, uint32_t node, Ptr<const Packet> pkt, double value, UanTxMode mode)
+{
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  uint32_t modeUid = mode.GetUid ();
+  uint32_t size = pkt->GetSize ();
+  if (m_compress)
+    {
+      Put (&type, 1);
+      PutVarint (now - m_lastNs);
+      PutVarint (node);
+      PutVarint (modeUid);
+      PutVarint (size);
+      Put (&value, sizeof (value));
+      m_lastNs = now;
+    }
+  else
+    {
+      char rec[PLAIN_RECORD_SIZE];
+      std::memset (rec, 0, sizeof (rec));
+      std::memcpy (rec, &now, 8);
+      std::memcpy (rec + 8, &node, 4);
+      rec[12] = type;
+      std::memcpy (rec + 16, &modeUid, 4);
+      std::memcpy (rec + 20, &size, 4);
+      std::memcpy (rec + 24, &value, 8);
+      Put (rec, sizeof (rec));
+    }
+  m_nRecords++;
+}
+
+static bool
+GetVarint (std::istream &is, uint64_t &v)
+{
+  v = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      int c = is.get ();
+      if (c == EOF)
+        {
+          return false;
+        }
+      v |= (uint64_t)(c & 0x7f) << shift;
+      if ((c & 0x80) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+UanTraceWriter::ReadHeader (std::istream &is, uint32_t &format)
+{
+  char magic[8];
+  uint32_t version;
+  is.read (magic, sizeof (magic));
+  is.read ((char *) &version, sizeof (version));
+  is.read ((char *) &format, sizeof (format));
+  return is && std::memcmp (magic, g_traceMagic, sizeof (magic)) == 0
+         && version == TRACE_VERSION && format <= FORMAT_COMPRESSED;
+}
+
+bool
+UanTraceWriter::ReadRecord (std::istream &is, uint32_t format, int64_t &lastNs, Record &r)
+{
+  if (format == FORMAT_PLAIN)
+    {
+      char rec[PLAIN_RECORD_SIZE];
+      if (!is.read (rec, sizeof (rec)))
+        {
+          return false;
+        }
+      std::memcpy (&r.timeNs, rec, 8);
+      std::memcpy (&r.node, rec + 8, 4);
+      r.type = rec[12];
+      std::memcpy (&r.modeUid, rec + 16, 4);
+      std::memcpy (&r.size, rec + 20, 4);
+      std::memcpy (&r.value, rec + 24, 8);
+    }
+  else
+    {
+      uint64_t delta, node, modeUid, size;
+      r.type = is.get ();
+      if (!GetVarint (is, delta) || !GetVarint (is, node)
+          || !GetVarint (is, modeUid) || !GetVarint (is, size)
+          || !is.read ((char *) &r.value, sizeof (r.value)))
+        {
+          return false;
+        }
+      lastNs += delta;
+      r.timeNs = lastNs;
+      r.node = node;
+      r.modeUid = modeUid;
+      r.size = size;
+    }
+  return r.type <= RX_ERROR;
+}
+
+bool
+UanTraceWriter::Read (std::istream &is, std::vector<Record> &records)
+{
+  uint32_t format;
+  if (!ReadHeader (is, format))
+    {
+      return false;
+    }
+  int64_t lastNs = 0;
+  Record r;
+  while (is.peek () != EOF)
+    {
+      if (!ReadRecord (is, format, lastNs, r))
+        {
+          return false;
+        }
+      records.push_back (r);
+    }
+  return true;
+}
+
+bool
+UanTraceWriter::Decode (std::istream &is, std::ostream &os)
+{
+  static const char types[] = { '+', 'r', 'e' };
+  uint32_t format;
+  if (!ReadHeader (is, format))
+    {
+      return false;
+    }
+  int64_t lastNs = 0;
+  Record r;
+  while (is.peek () != EOF)
+    {
+      if (!ReadRecord (is, format, lastNs, r))
+        {
+          return false;
+        }
+      os << types[r.type] << " "
+         << std::setprecision (12) << r.timeNs * 1e-9 << " "
+         << r.node << " "
+         << r.modeUid << " "
+         << r.size << " "
+         << std::setprecision (6) << r.value << "\n";
+    }
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,159 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANTRACEWRITER_H
+#define UANTRACEWRITER_H
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/uan-tx-mode.h"
+#include "ns3/uan-net-device.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \class UanTraceWriter
+ * \brief Buffered binary trace of PHY transmissions and receptions
+ *
+ * Each PHY Tx, RxOk and RxError event is stored as a record holding the
+ * simulation time, node id, event type, mode uid, packet size and a
+ * value in dB (the SINR for receptions, the transmit power for
+ * transmissions).  Packets are not printed, so Packet::EnablePrinting
+ * is not needed.  Records are collected in a buffer of BufferSize bytes
+ * which is written out when full and when the writer is closed (at the
+ * latest at Simulator::Destroy).
+ *
+ * The file starts with the 16 byte header: magic "UANTRACE", version
+ * (uint32) and format (uint32).  In the plain format (Compress false)
+ * records are 32 bytes in native byte order:
+ *
+ *   time (int64 ns) node (uint32) type (uint8, 3 bytes padding)
+ *   mode uid (uint32) size (uint32) value (double)
+ *
+ * With Compress set records are variable length: type byte, time
+ * increment over the previous record, node, mode uid and size as LEB128
+ * varints, then the value as a double.  Typical records take about
+ * 14 bytes.  Both formats are lossless; Decode converts either to text.
+ */
+class UanTraceWriter : public Object
+{
+public:
+  enum EventType
+  {
+    TX = 0,
+    RX_OK = 1,
+    RX_ERROR = 2
+  };
+
+  /**
+   * \brief One decoded trace record
+   */
+  struct Record
+  {
+    int64_t timeNs;
+    uint32_t node;
+    uint8_t type;
+    uint32_t modeUid;
+    uint32_t size;
+    double value;
+  };
+
+  UanTraceWriter ();
+  virtual ~UanTraceWriter ();
+  static TypeId GetTypeId (void);
+
+  /**
+   * Opens fileName and writes the header.  Attributes must be set before.
+   * \param fileName Name of trace file
+   */
+  void Open (std::string fileName);
+  /**
+   * Connects to the Tx, RxOk and RxError trace sources of the PHY of dev
+   * \param dev Device to trace
+   */
+  void Connect (Ptr<UanNetDevice> dev);
+  /**
+   * Writes out the buffer and closes the file.  Further events are dropped.
+   */
+  void Close (void);
+  /**
+   * \returns Number of records written so far
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \param is Trace file stream (opened in binary mode)
+   * \param records Decoded records are appended here
+   * \returns True if the whole stream was a valid trace
+   */
+  static bool Read (std::istream &is, std::vector<Record> &records);
+  /**
+   * Converts a binary trace to text, one line per record:
+   * "+" (TX), "r" (RX_OK) or "e" (RX_ERROR), time in seconds, node,
+   * mode uid, size in bytes and value in dB
+   * \param is Trace file stream (opened in binary mode)
+   * \param os Stream text is written to
+   * \returns True if the whole stream was a valid trace
+   */
+  static bool Decode (std::istream &is, std::ostream &os);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Trace sink for one device, remembering its node id
+   */
+  class Source : public SimpleRefCount<Source>
+  {
+  public:
+    Source (UanTraceWriter *writer, uint32_t node);
+    void Tx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode);
+    void RxOk (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode);
+    void RxError (Ptr<const Packet> pkt, double sinrDb, UanTxMode mode);
+  private:
+    UanTraceWriter *m_writer;
+    uint32_t m_node;
+  };
+
+  static bool ReadHeader (std::istream &is, uint32_t &format);
+  static bool ReadRecord (std::istream &is, uint32_t format, int64_t &lastNs, Record &r);
+  void Write (uint8_t type, uint32_t node, Ptr<const Packet> pkt, double value, UanTxMode mode);
+  void Put (const void *data, uint32_t len);
+  void PutVarint (uint64_t v);
+  void Flush (void);
+
+  uint32_t m_bufferSize;
+  bool m_compress;
+  std::ofstream m_file;
+  std::vector<char> m_buffer;
+  uint32_t m_used;
+  int64_t m_lastNs;
+  uint64_t m_nRecords;
+  std::vector<Ptr<Source> > m_sources;
+};
+
+} // namespace ns3
+
+#endif // UANTRACEWRITER_H
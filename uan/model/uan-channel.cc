@@ -26,7 +26,8 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
-#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 
 #include "uan-channel.h"
 #include "uan-phy.h"
@@ -36,6 +37,11 @@
 #include "uan-transducer.h"
 #include "uan-noise-model-default.h"
 #include "uan-prop-model-ideal.h"
+#include "uan-doppler-tag.h"
+#include "uan-counters.h"
+
+#include <cmath>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("UanChannel");
 namespace ns3 {
@@ -58,6 +64,21 @@ UanChannel::GetTypeId ()
                    PointerValue (CreateObject<UanNoiseModelDefault> ()),
                    MakePointerAccessor (&UanChannel::m_noise),
                    MakePointerChecker<UanNoiseModel> ())
+    .AddAttribute ("MobilityAware",
+                   "Account for node motion during propagation (and Doppler) on links with a moving node",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UanChannel::m_mobilityAware),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SoundSpeed",
+                   "Speed of sound in m/s used when MobilityAware is set",
+                   DoubleValue (1500.0),
+                   MakeDoubleAccessor (&UanChannel::m_soundSpeed),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxRange",
+                   "Nodes further than this (m) from the sender neither receive nor are interfered with; 0 for no limit",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&UanChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
   ;
 
   return tid;
@@ -66,7 +87,12 @@ UanChannel::GetTypeId ()
 UanChannel::UanChannel ()
   : Channel (),
     m_prop (0),
-    m_cleared (false)
+    m_cleared (false),
+    m_mobilityAware (false),
+    m_soundSpeed (1500.0),
+    m_maxRange (0),
+    m_builtRange (0),
+    m_regionsValid (false)
 {
 }
 
@@ -82,6 +108,13 @@ UanChannel::Clear ()
       return;
     }
   m_cleared = true;
+  for (uint32_t k = 0; k < m_mobility.size (); k++)
+    {
+      m_mobility[k]->TraceDisconnectWithoutContext ("CourseChange",
+                                                    MakeCallback (&UanChannel::CourseChanged, this));
+    }
+  m_mobility.clear ();
+  m_regions.clear ();
   UanDeviceList::iterator it = m_devList.begin ();
   for (; it != m_devList.end (); it++)
     {
@@ -140,6 +173,95 @@ UanChannel::AddDevice (Ptr<UanNetDevice> dev, Ptr<UanTransducer> trans)
 {
   NS_LOG_DEBUG ("Adding dev/trans pair number " << m_devList.size ());
   m_devList.push_back (std::make_pair (dev, trans));
+  m_regionsValid = false;
+}
+
+bool
+UanChannel::Region::operator< (const Region &o) const
+{
+  if (x != o.x)
+    {
+      return x < o.x;
+    }
+  if (y != o.y)
+    {
+      return y < o.y;
+    }
+  return z < o.z;
+}
+
+bool
+UanChannel::Region::operator!= (const Region &o) const
+{
+  return x != o.x || y != o.y || z != o.z;
+}
+
+UanChannel::Region
+UanChannel::GetRegion (const Vector &pos) const
+{
+  Region r;
+  r.x = (int64_t) std::floor (pos.x / m_maxRange);
+  r.y = (int64_t) std::floor (pos.y / m_maxRange);
+  r.z = (int64_t) std::floor (pos.z / m_maxRange);
+  return r;
+}
+
+void
+UanChannel::BuildRegions (void)
+{
+  // Mobility may be aggregated after the device is added, so
+  // models are looked up (and watched) on first use
+  for (uint32_t k = m_mobility.size (); k < m_devList.size (); k++)
+    {
+      Ptr<MobilityModel> mobility = m_devList[k].first->GetNode ()->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&UanChannel::CourseChanged, this));
+      m_mobility.push_back (mobility);
+    }
+
+  m_regions.clear ();
+  m_moving.clear ();
+  m_devRegion.resize (m_devList.size ());
+  for (uint32_t k = 0; k < m_devList.size (); k++)
+    {
+      m_devRegion[k] = GetRegion (m_mobility[k]->GetPosition ());
+      m_regions[m_devRegion[k]].push_back (k);
+      Vector v = m_mobility[k]->GetVelocity ();
+      if (v.x != 0 || v.y != 0 || v.z != 0)
+        {
+          m_moving.push_back (k);
+        }
+    }
+  NS_LOG_DEBUG ("Binned " << m_devList.size () << " nodes into " << m_regions.size ()
+                          << " regions, " << m_moving.size () << " moving");
+  m_builtRange = m_maxRange;
+  m_regionsValid = true;
+}
+
+void
+UanChannel::UpdateMovingRegions (void)
+{
+  for (std::vector<uint32_t>::const_iterator it = m_moving.begin (); it != m_moving.end (); it++)
+    {
+      Region r = GetRegion (m_mobility[*it]->GetPosition ());
+      if (r != m_devRegion[*it])
+        {
+          std::vector<uint32_t> &old = m_regions[m_devRegion[*it]];
+          old.erase (std::find (old.begin (), old.end (), *it));
+          if (old.empty ())
+            {
+              m_regions.erase (m_devRegion[*it]);
+            }
+          m_regions[r].push_back (*it);
+          m_devRegion[*it] = r;
+        }
+    }
+}
+
+void
+UanChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  m_regionsValid = false;
 }
 
 void
@@ -160,40 +282,147 @@ UanChannel::TxPacket (Ptr<UanTransducer> src, Ptr<Packet> packet,
         }
     }
   NS_ASSERT (senderMobility != 0);
+  bool senderMoving = false;
+  if (m_mobilityAware)
+    {
+      Vector v = senderMobility->GetVelocity ();
+      senderMoving = v.x != 0 || v.y != 0 || v.z != 0;
+    }
+
+  if (m_maxRange > 0)
+    {
+      if (!m_regionsValid || m_builtRange != m_maxRange)
+        {
+          BuildRegions ();
+        }
+      else
+        {
+          UpdateMovingRegions ();
+        }
+
+      // Candidates in the 27 regions around the sender, delivered in
+      // device order so event ordering matches the unpartitioned channel
+      std::vector<uint32_t> candidates;
+      Region c = GetRegion (senderMobility->GetPosition ());
+      Region r;
+      for (r.x = c.x - 1; r.x <= c.x + 1; r.x++)
+        {
+          for (r.y = c.y - 1; r.y <= c.y + 1; r.y++)
+            {
+              for (r.z = c.z - 1; r.z <= c.z + 1; r.z++)
+                {
+                  std::map<Region, std::vector<uint32_t> >::const_iterator it = m_regions.find (r);
+                  if (it != m_regions.end ())
+                    {
+                      candidates.insert (candidates.end (), it->second.begin (), it->second.end ());
+                    }
+                }
+            }
+        }
+      std::sort (candidates.begin (), candidates.end ());
+
+      for (std::vector<uint32_t>::const_iterator it = candidates.begin (); it != candidates.end (); it++)
+        {
+          if (src != m_devList[*it].second
+              && senderMobility->GetDistanceFrom (m_mobility[*it]) <= m_maxRange)
+            {
+              Deliver (*it, senderMobility, m_mobility[*it], senderMoving, packet, txPowerDb, txMode);
+            }
+        }
+      return;
+    }
+
   uint32_t j = 0;
   UanDeviceList::const_iterator i = m_devList.begin ();
   for (; i != m_devList.end (); i++)
     {
       if (src != i->second)
         {
-          NS_LOG_DEBUG ("Scheduling " << i->first->GetMac ()->GetAddress ());
           Ptr<MobilityModel> rcvrMobility = i->first->GetNode ()->GetObject<MobilityModel> ();
-          Time delay = m_prop->GetDelay (senderMobility, rcvrMobility, txMode);
-          UanPdp pdp = m_prop->GetPdp (senderMobility, rcvrMobility, txMode);
-
-          double pathLoss = m_prop->GetPathLossDb (senderMobility, rcvrMobility, txMode);
-          double rxPowerDb = txPowerDb - pathLoss;
-
-          NS_LOG_DEBUG ("txPowerDb=" << txPowerDb << "dB, rxPowerDb="
-                                     << rxPowerDb << "distance="
-                                     << senderMobility->GetDistanceFrom (rcvrMobility)
-                                     << "m, delay=" << delay);
-
-          uint32_t dstNodeId = i->first->GetNode ()->GetId ();
-          Ptr<Packet> copy = packet->Copy ();
-          Simulator::ScheduleWithContext (dstNodeId, delay,
-                                          &UanChannel::SendUp,
-                                          this,
-                                          j,
-                                          copy,
-                                          rxPowerDb,
-                                          txMode,
-                                          pdp);
+          Deliver (j, senderMobility, rcvrMobility, senderMoving, packet, txPowerDb, txMode);
         }
       j++;
     }
 }
 
+void
+UanChannel::Deliver (uint32_t j, Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> rcvrMobility,
+                     bool senderMoving, Ptr<Packet> packet, double txPowerDb, UanTxMode txMode)
+{
+  NS_LOG_DEBUG ("Scheduling " << m_devList[j].first->GetMac ()->GetAddress ());
+  UanCounters::Increment (UanCounters::CHANNEL_DELIVERY);
+  Time delay = m_prop->GetDelay (senderMobility, rcvrMobility, txMode);
+  UanPdp pdp = m_prop->GetPdp (senderMobility, rcvrMobility, txMode);
+
+  double pathLoss = m_prop->GetPathLossDb (senderMobility, rcvrMobility, txMode);
+  double rxPowerDb = txPowerDb - pathLoss;
+
+  NS_LOG_DEBUG ("txPowerDb=" << txPowerDb << "dB, rxPowerDb="
+                             << rxPowerDb << "distance="
+                             << senderMobility->GetDistanceFrom (rcvrMobility)
+                             << "m, delay=" << delay);
+
+  uint32_t dstNodeId = m_devList[j].first->GetNode ()->GetId ();
+  Ptr<Packet> copy = packet->Copy ();
+  // A forwarded packet may still carry the tag of its previous hop
+  UanDopplerTag oldTag;
+  copy->RemovePacketTag (oldTag);
+  if (m_mobilityAware)
+    {
+      Vector v = rcvrMobility->GetVelocity ();
+      if (senderMoving || v.x != 0 || v.y != 0 || v.z != 0)
+        {
+          delay = ApplyMotion (senderMobility, rcvrMobility, delay, copy);
+        }
+    }
+  Simulator::ScheduleWithContext (dstNodeId, delay,
+                                  &UanChannel::SendUp,
+                                  this,
+                                  j,
+                                  copy,
+                                  rxPowerDb,
+                                  txMode,
+                                  pdp);
+}
+
+Time
+UanChannel::ApplyMotion (Ptr<MobilityModel> src, Ptr<MobilityModel> dst, Time delay, Ptr<Packet> packet)
+{
+  Vector ps = src->GetPosition ();
+  Vector pd = dst->GetPosition ();
+  Vector vs = src->GetVelocity ();
+  Vector vd = dst->GetVelocity ();
+  double c = m_soundSpeed;
+
+  // Receiver at pd + vd * t, signal radius c * t from the transmit position:
+  // (vd.vd - c^2) t^2 + 2 (d.vd) t + d.d = 0
+  double dx = pd.x - ps.x;
+  double dy = pd.y - ps.y;
+  double dz = pd.z - ps.z;
+  double dist = std::sqrt (dx * dx + dy * dy + dz * dz);
+  if (dist == 0)
+    {
+      return delay;
+    }
+  double a = vd.x * vd.x + vd.y * vd.y + vd.z * vd.z - c * c;
+  double b = 2 * (dx * vd.x + dy * vd.y + dz * vd.z);
+  NS_ASSERT_MSG (a < 0, "Receiver faster than sound");
+  double t = (-b - std::sqrt (b * b - 4 * a * dist * dist)) / (2 * a);
+
+  // Unit vector from transmit position to receiver at arrival
+  double ux = (dx + vd.x * t) / (c * t);
+  double uy = (dy + vd.y * t) / (c * t);
+  double uz = (dz + vd.z * t) / (c * t);
+  double factor = (c - (vd.x * ux + vd.y * uy + vd.z * uz))
+    / (c - (vs.x * ux + vs.y * uy + vs.z * uz));
+  packet->AddPacketTag (UanDopplerTag (factor));
+
+  // Scale the model delay, which may include more than straight line travel
+  Time moving = Seconds (delay.GetSeconds () * t * c / dist);
+  NS_LOG_DEBUG ("Moving link: delay " << delay << " -> " << moving << ", Doppler factor " << factor);
+  return moving;
+}
+
 void
 UanChannel::SetNoiseModel (Ptr<UanNoiseModel> noise)
 {
@@ -216,4 +445,11 @@ UanChannel::GetNoiseDbHz (double fKhz)
   return noise;
 }
 
+double
+UanChannel::GetNoiseDb (double fKhz, UanTxMode mode)
+{
+  NS_ASSERT (m_noise);
+  return m_noise->GetNoiseDb (fKhz, mode);
+}
+
 } // namespace ns3
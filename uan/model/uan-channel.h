@@ -28,6 +28,7 @@
 #include "ns3/uan-noise-model.h"
 
 #include <list>
+#include <map>
 #include <vector>
 
 namespace ns3 {
@@ -40,6 +41,27 @@ class UanTxMode;
 /**
  * \class UanChannel
  * \brief Channel class used by UAN devices
+ *
+ * With the MobilityAware attribute set, links on which either node
+ * has a non-zero velocity account for motion during propagation: the
+ * arrival time is solved against the receiver's track (extrapolated
+ * from its current velocity), the propagation model delay is scaled
+ * accordingly, and the Doppler factor is attached to the delivered
+ * packet as a UanDopplerTag (replacing any tag of a previous hop).  The
+ * transducers and UanPhyGen scale the duration of the arrival by the
+ * factor.  Links between stationary nodes are handled exactly as
+ * without the attribute.
+ *
+ * The MaxRange attribute is a physics approximation: a transmission is
+ * not delivered at all to nodes further than MaxRange from the sender,
+ * so it neither reaches their PHYs as a packet nor adds to their
+ * interference.  Results only match those without the limit if the
+ * received power beyond MaxRange is negligible for the propagation model
+ * in use.  To find the nodes in range, nodes are binned into cubic
+ * regions of side MaxRange and only the sender's and neighbouring
+ * regions are searched.  Regions are rebuilt after a mobility course
+ * change, and nodes with a non-zero velocity are re-binned at every
+ * transmission.
  */
 class UanChannel : public Channel
 {
@@ -94,6 +116,13 @@ public:
    */
   double GetNoiseDbHz (double fKhz);
 
+  /**
+   * \param fKhz Frequency in kHz
+   * \param mode Mode whose bandwidth noise is integrated over
+   * \returns Ambient noise in dB on channel within the bandwidth of mode
+   */
+  double GetNoiseDb (double fKhz, UanTxMode mode);
+
   /**
    * Clears all pointer references
    */
@@ -104,8 +133,52 @@ private:
   Ptr<UanPropModel> m_prop;
   Ptr<UanNoiseModel> m_noise;
   bool m_cleared;
+  bool m_mobilityAware;
+  double m_soundSpeed;
+
+  /**
+   * \brief Index of a cubic region of side m_maxRange
+   */
+  struct Region
+  {
+    int64_t x;
+    int64_t y;
+    int64_t z;
+    bool operator< (const Region &o) const;
+    bool operator!= (const Region &o) const;
+  };
+  double m_maxRange;
+  double m_builtRange;
+  bool m_regionsValid;
+  /// Device list indices of the nodes in each region
+  std::map<Region, std::vector<uint32_t> > m_regions;
+  /// Region and mobility model of each device
+  std::vector<Region> m_devRegion;
+  std::vector<Ptr<MobilityModel> > m_mobility;
+  /// Devices whose node had a non-zero velocity when regions were built
+  std::vector<uint32_t> m_moving;
+
+  Region GetRegion (const Vector &pos) const;
+  void BuildRegions (void);
+  void UpdateMovingRegions (void);
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  /**
+   * Schedules reception of packet by device j
+   */
+  void Deliver (uint32_t j, Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> rcvrMobility,
+                bool senderMoving, Ptr<Packet> packet, double txPowerDb, UanTxMode txMode);
 
   void SendUp (uint32_t i, Ptr<Packet> packet, double rxPowerDb, UanTxMode txMode, UanPdp pdp);
+  /**
+   * Accounts for node motion on a link with a moving endpoint
+   *
+   * \param src Mobility model of transmitter
+   * \param dst Mobility model of receiver
+   * \param delay Propagation delay between current positions
+   * \param packet Copy of packet to be delivered, tagged with the Doppler factor
+   * \returns Propagation delay with motion of receiver during propagation
+   */
+  Time ApplyMotion (Ptr<MobilityModel> src, Ptr<MobilityModel> dst, Time delay, Ptr<Packet> packet);
 protected:
   virtual void DoDispose ();
 };
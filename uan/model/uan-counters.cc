@@ -0,0 +1,197 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-counters.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+#include <fstream>
+
+NS_LOG_COMPONENT_DEFINE ("UanCounters");
+
+namespace ns3 {
+
+static GlobalValue g_uanCounters ("UanCounters",
+                                  "Count work done in the UAN channel, transducer, PHY and MAC hot paths",
+                                  BooleanValue (false),
+                                  MakeBooleanChecker ());
+
+static GlobalValue g_uanCountersOutputFile ("UanCountersOutputFile",
+                                            "File the UanCounters summary is written to at Simulator::Destroy "
+                                            "(none if empty)",
+                                            StringValue (""),
+                                            MakeStringChecker ());
+
+bool UanCounters::m_checked = false;
+bool UanCounters::m_enabled = false;
+bool UanCounters::m_written = false;
+uint64_t UanCounters::m_global[UanCounters::NUM_COUNTERS];
+std::vector<uint64_t> UanCounters::m_node;
+
+void
+UanCounters::Check (void)
+{
+  BooleanValue enabled;
+  g_uanCounters.GetValue (enabled);
+  m_enabled = enabled.Get ();
+  m_checked = true;
+  if (m_enabled)
+    {
+      StringValue fileName;
+      g_uanCountersOutputFile.GetValue (fileName);
+      if (!fileName.Get ().empty ())
+        {
+          Simulator::ScheduleDestroy (&UanCounters::Dump, fileName.Get ());
+        }
+    }
+  // Scheduled after Dump so the summary still sees the counts
+  Simulator::ScheduleDestroy (&UanCounters::Finish);
+}
+
+void
+UanCounters::DoIncrement (Counter c, uint64_t n)
+{
+  m_global[c] += n;
+  uint32_t nodeId = Simulator::GetContext ();
+  if (nodeId == 0xffffffff)
+    {
+      return;
+    }
+  uint32_t index = nodeId * NUM_COUNTERS + c;
+  if (index >= m_node.size ())
+    {
+      m_node.resize ((nodeId + 1) * NUM_COUNTERS, 0);
+    }
+  m_node[index] += n;
+}
+
+void
+UanCounters::Dump (std::string fileName)
+{
+  // The first summary of the process replaces the file, later ones are appended
+  std::ofstream os (fileName.c_str (), m_written ? std::ios::app : std::ios::trunc);
+  if (!os.is_open ())
+    {
+      NS_LOG_WARN ("Could not open UanCounters output file " << fileName);
+      return;
+    }
+  Print (os);
+  m_written = true;
+}
+
+void
+UanCounters::Finish (void)
+{
+  Reset ();
+  // Re-read the global value in the next simulation
+  m_checked = false;
+  m_enabled = false;
+}
+
+uint64_t
+UanCounters::GetGlobal (Counter c)
+{
+  return m_global[c];
+}
+
+uint64_t
+UanCounters::GetNode (Counter c, uint32_t nodeId)
+{
+  uint32_t index = nodeId * NUM_COUNTERS + c;
+  return index < m_node.size () ? m_node[index] : 0;
+}
+
+std::string
+UanCounters::GetName (Counter c)
+{
+  switch (c)
+    {
+    case CHANNEL_DELIVERY:
+      return "ChannelDelivery";
+    case ARRIVAL_ADDED:
+      return "ArrivalAdded";
+    case ARRIVAL_REMOVED:
+      return "ArrivalRemoved";
+    case SINR_EVAL:
+      return "SinrEval";
+    case PER_EVAL:
+      return "PerEval";
+    case CUMAC_SCAN:
+      return "CumacScan";
+    case CUMAC_ENTRY:
+      return "CumacEntry";
+    case TONE_LOOKUP:
+      return "ToneLookup";
+    default:
+      return "Unknown";
+    }
+}
+
+void
+UanCounters::Print (std::ostream &os)
+{
+  os << "UanCounters node";
+  for (uint32_t c = 0; c < NUM_COUNTERS; c++)
+    {
+      os << " " << GetName ((Counter) c);
+    }
+  os << std::endl;
+
+  os << "UanCounters all";
+  for (uint32_t c = 0; c < NUM_COUNTERS; c++)
+    {
+      os << " " << m_global[c];
+    }
+  os << std::endl;
+
+  for (uint32_t node = 0; node * NUM_COUNTERS < m_node.size (); node++)
+    {
+      bool any = false;
+      for (uint32_t c = 0; c < NUM_COUNTERS; c++)
+        {
+          any = any || m_node[node * NUM_COUNTERS + c] != 0;
+        }
+      if (!any)
+        {
+          continue;
+        }
+      os << "UanCounters " << node;
+      for (uint32_t c = 0; c < NUM_COUNTERS; c++)
+        {
+          os << " " << m_node[node * NUM_COUNTERS + c];
+        }
+      os << std::endl;
+    }
+}
+
+void
+UanCounters::Reset (void)
+{
+  for (uint32_t c = 0; c < NUM_COUNTERS; c++)
+    {
+      m_global[c] = 0;
+    }
+  m_node.clear ();
+}
+
+} // namespace ns3
@@ -0,0 +1,133 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANCOUNTERS_H
+#define UANCOUNTERS_H
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \class UanCounters
+ * \brief Optional counts of the work done in the UAN hot paths
+ *
+ * Counting is off unless the global value UanCounters is set to true
+ * (e.g. NS_GLOBAL_VALUE="UanCounters=1").  The global value is read at
+ * the first count of a simulation, so a disabled counter costs a single
+ * branch.  Counts are kept in total and per node, the node being the
+ * context of the event doing the work.  The counts are reset at
+ * Simulator::Destroy.  If the global value UanCountersOutputFile names
+ * a file, a summary is written to it first (the first simulation of the
+ * process replaces the file, later ones append to it); nothing is
+ * printed otherwise.
+ */
+class UanCounters
+{
+public:
+  enum Counter
+  {
+    CHANNEL_DELIVERY,   //!< Packet copies scheduled by UanChannel::TxPacket
+    ARRIVAL_ADDED,      //!< Arrivals added to a UanTransducerHd
+    ARRIVAL_REMOVED,    //!< Arrivals removed from a UanTransducerHd
+    SINR_EVAL,          //!< SINR calculations by UanPhyGen
+    PER_EVAL,           //!< PER calculations by UanPhyGen
+    CUMAC_SCAN,         //!< Scans of the CUMAC channel manager transmissions
+    CUMAC_ENTRY,        //!< Transmissions visited by those scans
+    TONE_LOOKUP,        //!< Tone pulse table lookups by UanMacCumac
+    NUM_COUNTERS
+  };
+
+  /**
+   * \param c Counter to increment
+   * \param n Amount to add
+   */
+  static void Increment (Counter c, uint64_t n = 1)
+  {
+    if (IsEnabled ())
+      {
+        DoIncrement (c, n);
+      }
+  }
+  /**
+   * \returns True if counting is enabled for the current simulation
+   */
+  static bool IsEnabled (void)
+  {
+    if (!m_checked)
+      {
+        Check ();
+      }
+    return m_enabled;
+  }
+  /**
+   * \param c Counter
+   * \returns Count over all nodes
+   */
+  static uint64_t GetGlobal (Counter c);
+  /**
+   * \param c Counter
+   * \param nodeId Id of node
+   * \returns Count for node nodeId
+   */
+  static uint64_t GetNode (Counter c, uint32_t nodeId);
+  /**
+   * \param c Counter
+   * \returns Name of counter c
+   */
+  static std::string GetName (Counter c);
+  /**
+   * Prints the totals and a line per node which has non-zero counts
+   * \param os Stream to print to
+   */
+  static void Print (std::ostream &os);
+  /**
+   * Clears all counts
+   */
+  static void Reset (void);
+
+private:
+  static void Check (void);
+  static void DoIncrement (Counter c, uint64_t n);
+  /**
+   * Writes the summary of the ending simulation
+   * \param fileName File to write to
+   */
+  static void Dump (std::string fileName);
+  /**
+   * Resets the counts at the end of a simulation
+   */
+  static void Finish (void);
+
+  static bool m_checked;
+  static bool m_enabled;
+  /// True once a summary has been written in this process
+  static bool m_written;
+  static uint64_t m_global[NUM_COUNTERS];
+  /// Per node counts, NUM_COUNTERS entries per node id
+  static std::vector<uint64_t> m_node;
+};
+
+} // namespace ns3
+
+#endif // UANCOUNTERS_H
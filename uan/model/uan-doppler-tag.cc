@@ -0,0 +1,89 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-doppler-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanDopplerTag);
+
+UanDopplerTag::UanDopplerTag ()
+  : m_factor (1.0)
+{
+}
+
+UanDopplerTag::UanDopplerTag (double factor)
+  : m_factor (factor)
+{
+}
+
+TypeId
+UanDopplerTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UanDopplerTag")
+    .SetParent<Tag> ()
+    .AddConstructor<UanDopplerTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+UanDopplerTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+UanDopplerTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+UanDopplerTag::Serialize (TagBuffer i) const
+{
+  i.WriteDouble (m_factor);
+}
+
+void
+UanDopplerTag::Deserialize (TagBuffer i)
+{
+  m_factor = i.ReadDouble ();
+}
+
+void
+UanDopplerTag::Print (std::ostream &os) const
+{
+  os << "DopplerFactor=" << m_factor;
+}
+
+void
+UanDopplerTag::SetDopplerFactor (double factor)
+{
+  m_factor = factor;
+}
+
+double
+UanDopplerTag::GetDopplerFactor (void) const
+{
+  return m_factor;
+}
+
+} // namespace ns3
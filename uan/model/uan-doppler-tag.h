@@ -0,0 +1,68 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANDOPPLERTAG_H
+#define UANDOPPLERTAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \class UanDopplerTag
+ * \brief Doppler factor of a packet arrival over a link with moving endpoints
+ *
+ * Added by UanChannel (when MobilityAware is set) to the copy of a packet
+ * delivered over a link where either node is moving.  The factor is the
+ * ratio of received to transmitted frequency; packets without the tag
+ * arrived over a static link (factor 1).
+ */
+class UanDopplerTag : public Tag
+{
+public:
+  UanDopplerTag ();
+  /**
+   * \param factor Ratio of received to transmitted frequency
+   */
+  UanDopplerTag (double factor);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  /**
+   * \param factor Ratio of received to transmitted frequency
+   */
+  void SetDopplerFactor (double factor);
+  /**
+   * \returns Ratio of received to transmitted frequency
+   */
+  double GetDopplerFactor (void) const;
+
+private:
+  double m_factor;
+};
+
+} // namespace ns3
+
+#endif // UANDOPPLERTAG_H
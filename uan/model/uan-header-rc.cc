@@ -30,6 +30,7 @@ NS_OBJECT_ENSURE_REGISTERED (UanHeaderRcRts);
 NS_OBJECT_ENSURE_REGISTERED (UanHeaderRcCtsGlobal);
 NS_OBJECT_ENSURE_REGISTERED (UanHeaderRcCts);
 NS_OBJECT_ENSURE_REGISTERED (UanHeaderRcAck);
+NS_OBJECT_ENSURE_REGISTERED (UanHeaderRcAckAgg);
 
 UanHeaderRcData::UanHeaderRcData ()
   : Header (),
@@ -626,4 +627,143 @@ UanHeaderRcAck::GetInstanceTypeId (void) const
   return GetTypeId ();
 }
 
+UanHeaderRcAckAgg::UanHeaderRcAckAgg ()
+{
+}
+
+UanHeaderRcAckAgg::~UanHeaderRcAckAgg ()
+{
+  m_acks.clear ();
+}
+
+TypeId
+UanHeaderRcAckAgg::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::UanHeaderRcAckAgg")
+    .SetParent<Header> ()
+    .AddConstructor<UanHeaderRcAckAgg> ()
+  ;
+  return tid;
+}
+
+void
+UanHeaderRcAckAgg::AddAck (UanAddress addr, const UanHeaderRcAck &ack)
+{
+  m_acks.push_back (std::make_pair (addr, ack));
+}
+
+bool
+UanHeaderRcAckAgg::GetAck (UanAddress addr, UanHeaderRcAck &ack) const
+{
+  std::vector<std::pair<UanAddress, UanHeaderRcAck> >::const_iterator it = m_acks.begin ();
+  for (; it != m_acks.end (); it++)
+    {
+      if (it->first == addr)
+        {
+          ack = it->second;
+          return true;
+        }
+    }
+  return false;
+}
+
+uint32_t
+UanHeaderRcAckAgg::GetNoAcks (void) const
+{
+  return m_acks.size ();
+}
+
+/**
+ * \param nacks NACKed frames
+ * \returns Number of bytes of the bitmap holding nacks
+ */
+static uint32_t
+NackBitmapSize (const std::set<uint8_t> &nacks)
+{
+  return nacks.empty () ? 0 : *nacks.rbegin () / 8 + 1;
+}
+
+uint32_t
+UanHeaderRcAckAgg::GetSerializedSize (void) const
+{
+  uint32_t size = 2;
+  std::vector<std::pair<UanAddress, UanHeaderRcAck> >::const_iterator it = m_acks.begin ();
+  for (; it != m_acks.end (); it++)
+    {
+      size += 3 + NackBitmapSize (it->second.GetNackedFrames ());
+    }
+  return size;
+}
+
+void
+UanHeaderRcAckAgg::Serialize (Buffer::Iterator start) const
+{
+  start.WriteU16 (m_acks.size ());
+  std::vector<std::pair<UanAddress, UanHeaderRcAck> >::const_iterator it = m_acks.begin ();
+  for (; it != m_acks.end (); it++)
+    {
+      const std::set<uint8_t> &nacks = it->second.GetNackedFrames ();
+      uint32_t bitmapSize = NackBitmapSize (nacks);
+      start.WriteU8 (it->first.GetAsInt ());
+      start.WriteU8 (it->second.GetFrameNo ());
+      start.WriteU8 (bitmapSize);
+      std::vector<uint8_t> bitmap (bitmapSize, 0);
+      for (std::set<uint8_t>::const_iterator nit = nacks.begin (); nit != nacks.end (); nit++)
+        {
+          bitmap[*nit / 8] |= 1 << (*nit % 8);
+        }
+      for (uint32_t i = 0; i < bitmapSize; i++)
+        {
+          start.WriteU8 (bitmap[i]);
+        }
+    }
+}
+
+uint32_t
+UanHeaderRcAckAgg::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator rbuf = start;
+  m_acks.clear ();
+  uint16_t noAcks = rbuf.ReadU16 ();
+  for (uint32_t i = 0; i < noAcks; i++)
+    {
+      UanAddress addr (rbuf.ReadU8 ());
+      UanHeaderRcAck ack;
+      ack.SetFrameNo (rbuf.ReadU8 ());
+      uint8_t bitmapSize = rbuf.ReadU8 ();
+      for (uint32_t j = 0; j < bitmapSize; j++)
+        {
+          uint8_t bits = rbuf.ReadU8 ();
+          for (uint32_t b = 0; b < 8; b++)
+            {
+              if (bits & (1 << b))
+                {
+                  ack.AddNackedFrame (j * 8 + b);
+                }
+            }
+        }
+      m_acks.push_back (std::make_pair (addr, ack));
+    }
+  return rbuf.GetDistanceFrom (start);
+}
+
+void
+UanHeaderRcAckAgg::Print (std::ostream &os) const
+{
+  os << "Aggregated ACK (# acks=" << m_acks.size () << ")";
+  std::vector<std::pair<UanAddress, UanHeaderRcAck> >::const_iterator it = m_acks.begin ();
+  for (; it != m_acks.end (); it++)
+    {
+      os << " [Addr=" << it->first << " ";
+      it->second.Print (os);
+      os << "]";
+    }
+}
+
+TypeId
+UanHeaderRcAckAgg::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
 } // namespace ns3
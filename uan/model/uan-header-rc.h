@@ -27,6 +27,8 @@
 #include "ns3/uan-address.h"
 
 #include <set>
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
@@ -370,6 +372,50 @@ private:
 
 };
 
+/**
+ * \class UanHeaderRcAckAgg
+ * \brief Header of aggregated ACK packets used by protocol ns3::UanMacRc
+ *
+ * Carries the acknowledgements of all reservations of one cycle in a
+ * single broadcast packet.  Each entry takes three bytes (address,
+ * reservation frame # and bitmap length) plus a bitmap of the NACKed
+ * data frames, which is empty if all frames were received.
+ */
+class UanHeaderRcAckAgg : public Header
+{
+public:
+  UanHeaderRcAckAgg ();
+  virtual ~UanHeaderRcAckAgg ();
+
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param addr Node whose reservation is acknowledged
+   * \param ack Frame # of the reservation and NACKed data frames
+   */
+  void AddAck (UanAddress addr, const UanHeaderRcAck &ack);
+  /**
+   * \param addr Node address
+   * \param ack Set to the acknowledgement for addr, if there is one
+   * \returns True if this header holds an acknowledgement for addr
+   */
+  bool GetAck (UanAddress addr, UanHeaderRcAck &ack) const;
+  /**
+   * \returns Number of acknowledged reservations
+   */
+  uint32_t GetNoAcks (void) const;
+
+  // Inherrited methods
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+  virtual TypeId GetInstanceTypeId (void) const;
+
+private:
+  std::vector<std::pair<UanAddress, UanHeaderRcAck> > m_acks;
+};
+
 }
 
 #endif // UANHEADERRC_H
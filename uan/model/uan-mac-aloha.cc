@@ -22,6 +22,7 @@
 #include "uan-tx-mode.h"
 #include "uan-address.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 #include "uan-phy.h"
 #include "uan-header-common.h"
 
@@ -104,12 +105,21 @@ UanMacAloha::Enqueue (Ptr<Packet> packet, const Address &dest, uint16_t protocol
 
       packet->AddHeader (header);
       m_phy->SendPacket (packet, protocolNumber);
+
+      double txdelay = packet->GetSize () * 8.0 / m_phy->GetMode (protocolNumber).GetDataRateBps ();
+      Simulator::Schedule (Seconds (txdelay), &UanMacAloha::EndTx, this);
       return true;
     }
   else
     return false;
 }
 
+void
+UanMacAloha::EndTx (void)
+{
+  NotifyTxReady ();
+}
+
 void
 UanMacAloha::SetForwardUpCb (Callback<void, Ptr<Packet>, const UanAddress& > cb)
 {
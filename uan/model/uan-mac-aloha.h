@@ -76,6 +76,10 @@ private:
    * \param sinr SINR of received packet
    */
   void RxPacketError (Ptr<Packet> pkt, double sinr);
+  /**
+   * \brief End of own transmission, the next packet may be enqueued
+   */
+  void EndTx (void);
 protected:
   virtual void DoDispose ();
 };
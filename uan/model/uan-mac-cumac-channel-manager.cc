@@ -21,6 +21,7 @@
 #include "ns3/log.h"
 
 #include "uan-mac-cumac-channel-manager.h"
+#include "uan-counters.h"
 
 NS_LOG_COMPONENT_DEFINE ("UanMacCumacChannelManager");
 
@@ -96,9 +97,11 @@ bool UanMacCumacChannelManager::CanTransmitFromSrc (uint8_t channelNo, Time star
   //  std::cout << "UMCCM " << start.GetSeconds ()  << " " << finish.GetSeconds () << " " << srcPosition << std::endl;
 
 
+  UanCounters::Increment (UanCounters::CUMAC_SCAN);
   EntryList::iterator it = m_transmissions.begin ();
   for (; it != m_transmissions.end (); it++) {
     Entry &entry = *it;
+    UanCounters::Increment (UanCounters::CUMAC_ENTRY);
 
     if (channelNo != entry.GetChannel ())
       continue;
@@ -126,9 +129,11 @@ bool UanMacCumacChannelManager::CanTransmitToDst (uint8_t channelNo, Time start,
                                                   Vector dstPosition)
 {
 
+  UanCounters::Increment (UanCounters::CUMAC_SCAN);
   EntryList::iterator it = m_transmissions.begin ();
   for (; it != m_transmissions.end (); it++) {
     Entry &entry = *it;
+    UanCounters::Increment (UanCounters::CUMAC_ENTRY);
 
     if (channelNo != entry.GetChannel ())
       continue;
@@ -156,9 +161,11 @@ bool UanMacCumacChannelManager::CanTransmitToDst (uint8_t channelNo, Time start,
 bool
 UanMacCumacChannelManager::IsRegistered (uint8_t channelNo, Vector position)
 {
+  UanCounters::Increment (UanCounters::CUMAC_SCAN);
   EntryList::iterator it = m_transmissions.begin ();
   for (; it != m_transmissions.end (); it++) {
     Entry &entry = *it;
+    UanCounters::Increment (UanCounters::CUMAC_ENTRY);
 
     if (channelNo == entry.GetChannel ())
       return true;
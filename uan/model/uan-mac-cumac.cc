@@ -26,7 +26,9 @@
 #include "ns3/log.h"
 #include "uan-phy.h"
 #include "uan-header-common.h"
+#include "uan-counters.h"
 #include "ns3/random-variable.h"
+#include "ns3/uinteger.h"
 
 #include <iostream>
 NS_LOG_COMPONENT_DEFINE ("UanMacCumac");
@@ -46,9 +48,14 @@ UanMacCumac::UanMacCumac ()
     m_maxPropDelay (Seconds (550.0 / 1500.0)),
     m_cwMin (2),
     m_cwMax (8),
+    m_numRetries (0),
     m_tryingRts (false),
+    m_timerRunning (false),
+    m_rtsCts (false),
     m_status (IDLE),
     m_tx (false),
+    m_hasPacket (false),
+    m_currentFrameNo (0),
     m_cleared (false)
 {
   m_cw = m_cwMin;
@@ -87,6 +94,11 @@ UanMacCumac::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::UanMacCumac")
     .SetParent<Object> ()
     .AddConstructor<UanMacCumac> ()
+    .AddAttribute ("MaxRetries",
+                   "Number of RTS attempts made for a packet before it is dropped",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&UanMacCumac::m_maxRetries),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -139,8 +151,22 @@ UanMacCumac::TryRts ()
   NS_LOG_DEBUG ("" << Simulator::Now ().GetSeconds () << " MAC " << m_address << " TRYING RTS TO " << m_dstAddress);
 
   NS_ASSERT(m_status == IDLE);
-  if (++m_numRetries > 3) // maximum retries
-    return;
+  if (++m_numRetries > m_maxRetries)
+    {
+      // Give up the packet so the MAC accepts the next one.  A CTS for it
+      // arriving later is ignored (see RxPacketGood)
+      NS_LOG_DEBUG ("" << Simulator::Now ().GetSeconds () << " MAC " << m_address << " GIVING UP [frameNo=" << (int)m_currentFrameNo << "]");
+      m_waitCtsEvent.Cancel ();
+      m_rtsWaitCtsEvent.Cancel ();
+      m_currentTimer.Cancel ();
+      m_tryingRts = false;
+      m_timerRunning = false;
+      m_rtsCts = false;
+      m_hasPacket = false;
+      m_packet = 0;
+      NotifyTxReady ();
+      return;
+    }
 
   int timeSlots = m_uv.GetInteger(0, std::pow((double)2, m_cw));
   m_cw = std::min(m_cwMax, m_cw + 1);
@@ -351,11 +377,14 @@ UanMacCumac::RxPacketGood (Ptr<Packet> pkt, double sinr, UanTxMode txMode)
 
       NS_LOG_DEBUG ("" << Simulator::Now ().GetSeconds () << " MAC " << m_address << " CTS RECEIVED [frameNo=" << (int)cts.GetFrameNo () << ", channelNo=" << (int)cts.GetChannel ()  << "]");
 
-      NS_ASSERT(cts.GetFrameNo () == m_currentFrameNo);
+      if (!m_hasPacket || m_status != WAITING_CTS || cts.GetFrameNo () != m_currentFrameNo)
+        {
+          // Late CTS for a packet already given up (or retried)
+          NS_LOG_DEBUG ("" << Simulator::Now ().GetSeconds () << " MAC " << m_address << " IGNORING STALE CTS");
+          return;
+        }
       NS_ASSERT(!m_phy->IsStateTx ());
 
-      NS_ASSERT(m_hasPacket);
-
       m_waitCtsEvent.Cancel ();
 
       UanHeaderCumacData data (m_currentFrameNo);
@@ -555,6 +584,7 @@ UanMacCumac::EndTx (void)
       m_status = IDLE;
       m_hasPacket = false;
       SetChannel (0);
+      NotifyTxReady ();
       break;
     default:
       NS_ASSERT(false);
@@ -845,6 +875,7 @@ TonePulseTable::Remove (uint32_t id)
 bool
 TonePulseTable::IsBusy(uint8_t channel, uint8_t interval, Vector position) const
 {
+  UanCounters::Increment (UanCounters::TONE_LOOKUP);
   std::map<uint32_t, Entry>::const_iterator it = m_entries.begin ();
   for ( ; it != m_entries.end (); it++) {
     const Entry &e = it->second;
@@ -131,7 +131,8 @@ private:
 
   /* rts sending */
   int m_cw;
-  int m_numRetries;
+  uint32_t m_numRetries;
+  uint32_t m_maxRetries;
   Time m_timeStartDelay;
   Time m_timeCurrentDelay;
   EventId m_currentTimer;
@@ -382,6 +382,7 @@ UanMacCw::SendPacket (void)
   m_pktTx = 0;
   m_sendTime = Seconds (0);
   m_savedDelayS = Seconds (0);
+  NotifyTxReady ();
 }
 
 } // namespace ns3
@@ -31,12 +31,15 @@
 #include "ns3/nstime.h"
 #include "ns3/double.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 
 #include <utility>
 #include <set>
 #include <map>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("UanMacRcGw");
 
@@ -55,7 +58,13 @@ UanMacRcGw::UanMacRcGw ()
   : UanMac (),
     m_state (IDLE),
     m_currentRateNum (0),
-    m_cleared (false)
+    m_cleared (false),
+    m_modelValid (false),
+    m_modelNodes (0),
+    m_modelFrameSize (0),
+    m_modelAggregateAck (false),
+    m_modelTotalRate (0),
+    m_optA (0)
 {
   UanHeaderCommon ch;
   UanHeaderRcRts rts;
@@ -68,6 +77,11 @@ UanMacRcGw::UanMacRcGw ()
   m_ctsSizeG = ch.GetSerializedSize () + ctsg.GetSerializedSize ();
   m_ackSize = ch.GetSerializedSize () + ack.GetSerializedSize ();
 
+  UanHeaderRcAckAgg agg;
+  m_ackAggSize = ch.GetSerializedSize () + agg.GetSerializedSize ();
+  agg.AddAck (UanAddress (), ack);
+  m_ackEntrySize = ch.GetSerializedSize () + agg.GetSerializedSize () - m_ackAggSize;
+
   NS_LOG_DEBUG ("Gateway initialized");
 }
 
@@ -89,6 +103,7 @@ UanMacRcGw::Clear ()
       m_phy = 0;
     }
   m_propDelay.clear ();
+  m_modelValid = false;
   std::map<UanAddress, AckData>::iterator it = m_ackData.begin ();
   for (; it != m_ackData.end (); it++)
     {
@@ -121,6 +136,21 @@ UanMacRcGw::GetTypeId (void)
                    UintegerValue (1023),
                    MakeUintegerAccessor (&UanMacRcGw::m_numRates),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NumberOfRateSets",
+                   "Number of blocks of NumberOfRates modes in each PHY mode list (one per gateway band)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&UanMacRcGw::m_numRateSets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RateSet",
+                   "Block of modes this gateway runs its cycles on (0 to NumberOfRateSets - 1)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&UanMacRcGw::m_rateSet),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AggregateAck",
+                   "Acknowledge all reservations of a cycle in one broadcast packet",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UanMacRcGw::m_aggregateAck),
+                   MakeBooleanChecker ())
     .AddAttribute ("RetryRate",
                    "Number of retry rates per second at non-gateway nodes",
                    DoubleValue (1 / 10.0),
@@ -250,7 +280,12 @@ UanMacRcGw::ReceivePacket (Ptr<Packet> pkt, double sinr, UanTxMode mode)
       {
         UanHeaderRcData dh;
         pkt->RemoveHeader (dh);
-        m_propDelay[ch.GetSrc ()] = dh.GetPropDelay ();
+        std::map<UanAddress, Time>::iterator pdit = m_propDelay.find (ch.GetSrc ());
+        if (pdit == m_propDelay.end () || pdit->second != dh.GetPropDelay ())
+          {
+            m_propDelay[ch.GetSrc ()] = dh.GetPropDelay ();
+            m_modelValid = false;
+          }
         if (m_ackData.find (ch.GetSrc ()) == m_ackData.end ())
           {
             NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " GATEWAY Received unexpected data packet");
@@ -301,19 +336,32 @@ UanMacRcGw::ReceivePacket (Ptr<Packet> pkt, double sinr, UanTxMode mode)
         }
       break;
     case UanMacRc::TYPE_CTS:
-      NS_FATAL_ERROR ("Received CTS at GW.  Currently only support single GW network!");
-      break;
     case UanMacRc::TYPE_ACK:
-      NS_FATAL_ERROR ("Received ACK at GW.  Currently only support single GW network!");
+    case UanMacRc::TYPE_ACKAGG:
+      // Control packet of another gateway
+      NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " GW ignoring control packet from gateway " << ch.GetSrc ());
       break;
     default:
       NS_FATAL_ERROR ("Received unknown packet at GW!");
     }
 }
 
+uint32_t
+UanMacRcGw::GetDataMode (uint32_t rateNum) const
+{
+  return m_rateSet * m_numRates + rateNum;
+}
+
+uint32_t
+UanMacRcGw::GetControlMode (uint32_t rateNum) const
+{
+  return m_numRateSets * m_numRates + GetDataMode (rateNum);
+}
+
 void
 UanMacRcGw::StartCycle (void)
 {
+  NS_ASSERT_MSG (m_rateSet < m_numRateSets, "RateSet must be less than NumberOfRateSets");
   uint32_t numRts = m_sortedRes.size ();
 
   if (numRts)
@@ -341,7 +389,7 @@ UanMacRcGw::StartCycle (void)
     }
 
 
-  double minRate = m_phy->GetMode (m_numRates).GetDataRateBps ();
+  double minRate = m_phy->GetMode (GetControlMode (0)).GetDataRateBps ();
 
   uint32_t optA = m_maxRes;
   if (m_maxRes == 0)
@@ -362,7 +410,7 @@ UanMacRcGw::StartCycle (void)
   NS_LOG_DEBUG ("Found theoretical alpha: " << thAlpha << " Found associated rate = " << thCtlRate << " Giving rate number: " << temprate);
   double thX = thAlpha * m_totalRate / (2.0 * m_numNodes * m_rtsSize * 8.0);
 
-  double dataRate = m_phy->GetMode (m_currentRateNum).GetDataRateBps ();
+  double dataRate = m_phy->GetMode (GetDataMode (m_currentRateNum)).GetDataRateBps ();
 
 
   if (thX < m_minRetryRate)
@@ -377,7 +425,7 @@ UanMacRcGw::StartCycle (void)
 
   double actualX = m_currentRetryRate * m_retryStep + m_minRetryRate;
 
-  uint32_t ctlRate =  m_phy->GetMode (m_currentRateNum + m_numRates).GetDataRateBps ();
+  uint32_t ctlRate =  m_phy->GetMode (GetControlMode (m_currentRateNum)).GetDataRateBps ();
 
 
   double winSize = (double)(totalBytes) * 8.0 / dataRate + m_sifs.GetSeconds () * totalFrames + pDelay;
@@ -389,7 +437,8 @@ UanMacRcGw::StartCycle (void)
 
 
   // Before fast CTS/ACK(below)
-  double cycleSeconds = winSize + (totalFrames + 1.0) * m_sifs.GetSeconds () + m_ctsSizeG * 8.0 / dataRate + (m_ctsSizeN + m_ackSize) * 8.0 * numRts / dataRate;
+  double ackBytes = m_aggregateAck ? m_ackAggSize + m_ackEntrySize * numRts : m_ackSize * numRts;
+  double cycleSeconds = winSize + (totalFrames + 1.0) * m_sifs.GetSeconds () + m_ctsSizeG * 8.0 / dataRate + (m_ctsSizeN * numRts + ackBytes) * 8.0 / dataRate;
 
   Time ctsTxTimeG = Seconds (m_ctsSizeG * 8.0 / dataRate);
   Time ctsTxTimeTotal = Seconds (m_ctsSizeN * 8.0 * numRts / dataRate) + ctsTxTimeG;
@@ -397,7 +446,7 @@ UanMacRcGw::StartCycle (void)
     {
       UanHeaderRcCtsGlobal ctsg;
       ctsg.SetWindowTime (Seconds (effWinSize));
-      ctsg.SetRateNum (m_currentRateNum);
+      ctsg.SetRateNum (GetDataMode (m_currentRateNum));
       ctsg.SetRetryRate (m_currentRetryRate);
       ctsg.SetTxTimeStamp (Simulator::Now ());
 
@@ -405,7 +454,7 @@ UanMacRcGw::StartCycle (void)
       Ptr<Packet> p = Create<Packet> ();
       p->AddHeader (ctsg);
       p->AddHeader (ch);
-      SendPacket (p, m_currentRateNum);
+      SendPacket (p, GetDataMode (m_currentRateNum));
 
 
       Simulator::Schedule (Seconds (cycleSeconds), &UanMacRcGw::StartCycle, this);
@@ -451,7 +500,7 @@ UanMacRcGw::StartCycle (void)
     }
 
   UanHeaderRcCtsGlobal ctsg;
-  ctsg.SetRateNum (m_currentRateNum);
+  ctsg.SetRateNum (GetDataMode (m_currentRateNum));
   ctsg.SetRetryRate (m_currentRetryRate);
   ctsg.SetWindowTime (Seconds (effWinSize));
   ctsg.SetTxTimeStamp (Simulator::Now ());
@@ -461,7 +510,7 @@ UanMacRcGw::StartCycle (void)
   ch.SetType (UanMacRc::TYPE_CTS);
   cts->AddHeader (ctsg);
   cts->AddHeader (ch);
-  SendPacket (cts, m_currentRateNum);
+  SendPacket (cts, GetDataMode (m_currentRateNum));
 
   m_requests.clear ();
   m_sortedRes.clear ();
@@ -484,7 +533,9 @@ UanMacRcGw::EndCycle ()
 
   Time nextAck = Seconds (0);
 
-  Time ackTime = Seconds (m_ackSize * 8.0 / m_phy->GetMode (m_currentRateNum).GetDataRateBps ());
+  double dataRate = m_phy->GetMode (GetDataMode (m_currentRateNum)).GetDataRateBps ();
+  Time ackTime = Seconds (m_ackSize * 8.0 / dataRate);
+  UanHeaderRcAckAgg agg;
 
   std::map<UanAddress, AckData>::iterator it = m_ackData.begin ();
   for (; it != m_ackData.end (); it++)
@@ -500,10 +551,6 @@ UanMacRcGw::EndCycle ()
               toNack.push_back (i);
             }
         }
-      UanHeaderCommon ch;
-      ch.SetDest (dest);
-      ch.SetSrc (m_address);
-      ch.SetType (UanMacRc::TYPE_ACK);
       UanHeaderRcAck ah;
       ah.SetFrameNo (data.frameNo);
       std::list<uint32_t>::iterator nit = toNack.begin ();
@@ -511,13 +558,30 @@ UanMacRcGw::EndCycle ()
         {
           ah.AddNackedFrame (*nit);
         }
+      if (m_aggregateAck)
+        {
+          agg.AddAck (dest, ah);
+          continue;
+        }
 
+      UanHeaderCommon ch;
+      ch.SetDest (dest);
+      ch.SetSrc (m_address);
+      ch.SetType (UanMacRc::TYPE_ACK);
       Ptr<Packet> ack = Create<Packet> ();
       ack->AddHeader (ah);
       ack->AddHeader (ch);
-      Simulator::Schedule (nextAck, &UanMacRcGw::SendPacket, this, ack, m_currentRateNum);
+      Simulator::Schedule (nextAck, &UanMacRcGw::SendPacket, this, ack, GetDataMode (m_currentRateNum));
       nextAck = nextAck + ackTime + m_sifs;
     }
+  if (agg.GetNoAcks () > 0)
+    {
+      Ptr<Packet> ack = Create<Packet> ();
+      ack->AddHeader (agg);
+      ack->AddHeader (UanHeaderCommon (m_address, UanAddress::GetBroadcast (), UanMacRc::TYPE_ACKAGG));
+      SendPacket (ack, GetDataMode (m_currentRateNum));
+      nextAck = Seconds (ack->GetSize () * 8.0 / dataRate) + m_sifs;
+    }
   m_ackData.clear ();
   Simulator::Schedule (nextAck, &UanMacRcGw::StartCycle, this);
 
@@ -542,6 +606,9 @@ UanMacRcGw::SendPacket (Ptr<Packet> pkt, uint32_t rate)
     case UanMacRc::TYPE_ACK:
       type = "ACK";
       break;
+    case UanMacRc::TYPE_ACKAGG:
+      type = "ACKAGG";
+      break;
     case UanMacRc::TYPE_GWPING:
       type = "GWPING";
       break;
@@ -607,14 +674,14 @@ UanMacRcGw::GetExpPdk (void)
   exppdk.push_back (m_maxDelta.GetSeconds ());
   for (uint32_t k = 1; k <= n; k++)
     {
-      uint32_t ind = CompExpMinIndex (n,k) - 1;
+      uint32_t ind = m_expMinIndex[k - 1] - 1;
       exppdk.push_back (pds[ind]);
     }
   return exppdk;
 }
 
 double
-UanMacRcGw::ComputeExpS (uint32_t a, uint32_t ld, std::vector<double> exppdk)
+UanMacRcGw::ComputeExpS (uint32_t a, uint32_t ld, const std::vector<double> &exppdk)
 {
   UanHeaderCommon ch;
   uint32_t lh = ch.GetSerializedSize ();
@@ -636,25 +703,21 @@ UanMacRcGw::ComputeExpS (uint32_t a, uint32_t ld, std::vector<double> exppdk)
       expp += ComputePiK (a,n,i) * exppdk[i - 1];
     }
 
-  exptime += ComputeExpBOverA (n,a,ld + lh,exppdk) + expk * 2 * m_sifs.GetSeconds () + m_sifs.GetSeconds () + 2 * expp;
+  // One SIFS per node after its data, and unless ACKs are aggregated one after its ACK
+  double sifsPerNode = m_aggregateAck ? 1 : 2;
+  exptime += ComputeExpBOverA (n,a,ld + lh,exppdk) + expk * sifsPerNode * m_sifs.GetSeconds () + m_sifs.GetSeconds () + 2 * expp;
   double s = (1.0 / m_totalRate) * expdata / exptime;
 
   return s;
 }
 
-double
-UanMacRcGw::ComputeExpS (uint32_t a, uint32_t ld)
-{
-  return ComputeExpS (a, ld, GetExpPdk ());
-}
-
 uint32_t
 UanMacRcGw::CompExpMinIndex (uint32_t n, uint32_t k)
 {
   double sum = 0;
   for (uint32_t i = 1; i <= n - k + 1; i++)
     {
-      double p = (double) NchooseK (n - i, k - 1) / NchooseK (n, k);
+      double p = std::exp (LogNchooseK (n - i, k - 1) - LogNchooseK (n, k));
       sum += p * i;
     }
   return (uint32_t)(sum + 0.5);
@@ -663,21 +726,28 @@ UanMacRcGw::CompExpMinIndex (uint32_t n, uint32_t k)
 double
 UanMacRcGw::ComputePiK (uint32_t a, uint32_t n, uint32_t k)
 {
-  double nck = (double) NchooseK (n, k);
-  return nck * std::pow ( (std::exp ( (double) a / (double) n) - 1.0), (double) k) * std::exp (-( (double) a));
+  // Evaluated in the log domain since n choose k overflows and
+  // exp (-a) underflows for large n
+  double logPik = LogNchooseK (n, k) + k * std::log (std::exp ( (double) a / (double) n) - 1.0) - (double) a;
+  return std::exp (logPik);
 }
 
 double
-UanMacRcGw::ComputeExpBOverA (uint32_t n, uint32_t a, uint32_t ldlh, std::vector<double> deltaK)
+UanMacRcGw::ComputeExpBOverA (uint32_t n, uint32_t a, uint32_t ldlh, const std::vector<double> &deltaK)
 {
 
   double sum = 0;
-  uint32_t lt = 8 * (m_ctsSizeN + ldlh + m_ackSize);
+  uint32_t lt = 8 * (m_ctsSizeN + ldlh + (m_aggregateAck ? m_ackEntrySize : m_ackSize));
   for (uint32_t k = 1; k <= n; k++)
     {
+      double pik = ComputePiK (a, n, k);
+      if (pik == 0)
+        {
+          // Negligible probability, alpha need not be valid for this k
+          continue;
+        }
       double num = 8.0 * m_ctsSizeG + k * lt;
       double denom = (1.0 - ComputeAlpha (k, k * ldlh, n, a, deltaK[k])) * m_totalRate;
-      double pik = ComputePiK (a, n, k);
       double term = pik * num / denom;
 
       sum += term;
@@ -686,38 +756,70 @@ UanMacRcGw::ComputeExpBOverA (uint32_t n, uint32_t a, uint32_t ldlh, std::vector
   return sum;
 }
 
-uint64_t
-UanMacRcGw::NchooseK (uint32_t n, uint32_t k)
+double
+UanMacRcGw::LogNchooseK (uint32_t n, uint32_t k)
 {
   if (k > n)
     {
-      return 0;
+      return -std::numeric_limits<double>::infinity ();
     }
+  NS_ASSERT (n < m_logFact.size ());
+  return m_logFact[n] - m_logFact[k] - m_logFact[n - k];
+}
 
-  if (k > n / 2)
+void
+UanMacRcGw::UpdateModel (void)
+{
+  uint32_t n = m_numNodes;
+  if (m_modelNodes != n)
     {
-      k = n - k;
+      m_logFact.resize (n + 1);
+      m_logFact[0] = 0;
+      for (uint32_t i = 1; i <= n; i++)
+        {
+          m_logFact[i] = m_logFact[i - 1] + std::log ((double) i);
+        }
+      m_expMinIndex.resize (n);
+      for (uint32_t k = 1; k <= n; k++)
+        {
+          m_expMinIndex[k - 1] = CompExpMinIndex (n, k);
+        }
+      m_modelNodes = n;
+      m_modelValid = false;
     }
-
-  double accum = 1;
-  for (uint32_t i = 1; i <= k; i++)
+  if (!m_modelValid || m_modelMaxDelta != m_maxDelta)
     {
-      accum = accum * (n - k + i) / i;
+      m_expPdk = GetExpPdk ();
+      m_optA = 0;
+      m_modelMaxDelta = m_maxDelta;
+      m_modelValid = true;
+    }
+  if (m_modelFrameSize != m_frameSize || m_modelSifs != m_sifs
+      || m_modelAggregateAck != m_aggregateAck || m_modelTotalRate != m_totalRate)
+    {
+      m_optA = 0;
+      m_modelFrameSize = m_frameSize;
+      m_modelSifs = m_sifs;
+      m_modelAggregateAck = m_aggregateAck;
+      m_modelTotalRate = m_totalRate;
     }
-
-  return (uint64_t)(accum + 0.5);
-
 }
 
 uint32_t
 UanMacRcGw::FindOptA (void)
 {
+  UpdateModel ();
+  if (m_optA != 0)
+    {
+      return m_optA;
+    }
+
   double tput = 0;
   uint32_t a = 1;
   while (1)
     {
 
-      double newtput = ComputeExpS (a, m_frameSize);
+      double newtput = ComputeExpS (a, m_frameSize, m_expPdk);
       if (newtput < tput)
         {
           a--;
@@ -730,6 +832,7 @@ UanMacRcGw::FindOptA (void)
         }
     }
   NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " GW: Found optimum a = " << a);
+  m_optA = a;
   return a;
 }
 } // namespace ns3
@@ -49,8 +49,20 @@ class UanTxMode;
  * some out of band (RF?) means.  UanMacRcGw is the protocol
  * which runs on the gateway nodes.
  *
- * This particular implementation
- * assumes that there is only a single gateway.
+ * Several gateways may serve overlapping neighborhoods if each runs
+ * its cycles on its own rate set (RateSet attribute): the PHY mode
+ * lists then hold NumberOfRateSets consecutive blocks of NumberOfRates
+ * modes, block i of each list occupying a band disjoint from the other
+ * blocks.  Each gateway only schedules the nodes which sent their
+ * requests to it (see UanMacRc for how nodes choose a gateway).
+ *
+ * With AggregateAck set the acknowledgements of a cycle are sent as one
+ * broadcast packet (UanHeaderRcAckAgg) instead of one ACK packet per
+ * node, each followed by a SIFS, and the next cycle starts right after it.
+ * Cycles are not pipelined: the next CTS is sent only once the ACK has
+ * been transmitted, so the next RTS window overlaps the propagation of
+ * the ACK but not its transmission, and the ACK is never carried in the
+ * CTS packet itself.
  *
  * For more information on class operation email
  * lentracy@u.washington.edu
@@ -74,6 +86,14 @@ public:
   virtual Address GetBroadcast (void) const;
   virtual void Clear (void);
 
+  /**
+   * Finds the number of reservations per cycle maximizing the expected
+   * throughput, used when MaxReservations is 0.  The result is cached
+   * until the propagation delays or any attribute it depends on change.
+   * \returns Optimum expected number of reservations per cycle
+   */
+  uint32_t FindOptA (void);
+
 private:
   enum State {
     IDLE, INCYCLE, CTSING
@@ -102,10 +122,17 @@ private:
   Time m_sifs;
   uint32_t m_maxRes;
   uint32_t m_numRates;
+  uint32_t m_numRateSets;
+  uint32_t m_rateSet;
   uint32_t m_rtsSize;
   uint32_t m_ctsSizeN;
   uint32_t m_ctsSizeG;
   uint32_t m_ackSize;
+  /// Size of an aggregated ACK packet without entries
+  uint32_t m_ackAggSize;
+  /// Size of one entry of an aggregated ACK (all frames received)
+  uint32_t m_ackEntrySize;
+  bool m_aggregateAck;
   double m_retryRate;
   uint16_t m_currentRetryRate;
   uint32_t m_currentRateNum;
@@ -128,6 +155,26 @@ private:
 
   bool m_cleared;
 
+  /// True if m_expPdk and m_optA match the current prop. delays
+  bool m_modelValid;
+  /// Number of nodes m_logFact and m_expMinIndex were built for
+  uint32_t m_modelNodes;
+  /// MaxPropDelay m_expPdk was built for
+  Time m_modelMaxDelta;
+  /// Frame size, SIFS, AggregateAck and TotalRate m_optA was found for
+  uint32_t m_modelFrameSize;
+  Time m_modelSifs;
+  bool m_modelAggregateAck;
+  uint32_t m_modelTotalRate;
+  /// log (i!) for i = 0..m_modelNodes
+  std::vector<double> m_logFact;
+  /// CompExpMinIndex (n, k) for n = m_modelNodes, k = 1..n (index k - 1)
+  std::vector<uint32_t> m_expMinIndex;
+  /// Cached result of GetExpPdk
+  std::vector<double> m_expPdk;
+  /// Cached result of FindOptA
+  uint32_t m_optA;
+
   TracedCallback<Ptr<const Packet>, UanTxMode > m_rxLogger;
 
   // Start time, min p-delay, reservations, frames, bytes, window size, ctl rate, retry rate
@@ -139,17 +186,36 @@ private:
   void SendPacket (Ptr<Packet> pkt, uint32_t rate);
   void CycleStarted (void);
   void ReceiveError (Ptr<Packet> pkt, double sinr);
+  /**
+   * \param rateNum Rate number within this gateway's rate set
+   * \returns PHY mode number of the data channel with rate rateNum
+   */
+  uint32_t GetDataMode (uint32_t rateNum) const;
+  /**
+   * \param rateNum Rate number within this gateway's rate set
+   * \returns PHY mode number of the reservation channel matching rateNum
+   */
+  uint32_t GetControlMode (uint32_t rateNum) const;
 
   // Stuff for computing exp throughput
   double ComputeAlpha (uint32_t totalFrames, uint32_t totalBytes, uint32_t n, uint32_t a, double deltaK);
   std::vector<double>  GetExpPdk (void);
-  double ComputeExpS (uint32_t a, uint32_t ld, std::vector<double> exppdk);
-  double ComputeExpS (uint32_t a, uint32_t ld);
+  double ComputeExpS (uint32_t a, uint32_t ld, const std::vector<double> &exppdk);
   uint32_t CompExpMinIndex (uint32_t n, uint32_t k);
   double ComputePiK (uint32_t a, uint32_t n, uint32_t k);
-  double ComputeExpBOverA (uint32_t n, uint32_t a, uint32_t ldlh, std::vector<double> deltaK);
-  uint64_t NchooseK (uint32_t n, uint32_t k);
-  uint32_t FindOptA (void);
+  double ComputeExpBOverA (uint32_t n, uint32_t a, uint32_t ldlh, const std::vector<double> &deltaK);
+  /**
+   * Rebuilds the cached log-factorial and index tables if NumberOfNodes
+   * changed and the expected min. prop. delays if they are invalid or
+   * MaxPropDelay changed.  Discards m_optA if any of its inputs changed.
+   */
+  void UpdateModel (void);
+  /**
+   * \param n Set size, at most NumberOfNodes
+   * \param k Subset size
+   * \returns Natural logarithm of n choose k (-infinity if k > n)
+   */
+  double LogNchooseK (uint32_t n, uint32_t k);
 protected:
   virtual void DoDispose ();
 
@@ -33,7 +33,6 @@
 #include "ns3/double.h"
 #include "ns3/uinteger.h"
 
-#include <list>
 #include <utility>
 
 
@@ -52,41 +51,23 @@ Reservation::Reservation ()
 
 }
 
-Reservation::Reservation (std::list<std::pair <Ptr<Packet>, UanAddress > > &list, uint8_t frameNo, uint32_t maxPkts)
-  : m_frameNo (frameNo),
+Reservation::Reservation (const std::vector<uint32_t> &frames, uint32_t length, uint8_t frameNo)
+  : m_frames (frames),
+    m_length (length),
+    m_frameNo (frameNo),
     m_retryNo (0),
     m_transmitted (false)
 {
-  uint32_t numPkts = (maxPkts) ? maxPkts : list.size ();
-  uint32_t length = 0;
-  UanHeaderRcData dh;
-  UanHeaderCommon ch;
-
-  for (uint32_t i = 0; i < numPkts; i++)
-    {
-      length += list.front ().first->GetSize () +
-        ch.GetSerializedSize () +
-        dh.GetSerializedSize ();
-      m_pktList.push_back (list.front ());
-      list.pop_front ();
-    }
-  m_length = length;
 }
 
 Reservation::~Reservation ()
 {
-  std::list<std::pair <Ptr<Packet>, UanAddress > >::iterator it;
-  for (it = m_pktList.begin (); it != m_pktList.end (); it++)
-    {
-      it->first = Ptr<Packet> ((Packet *) 0);
-    }
-  m_pktList.clear ();
-  m_timestamp.clear ();
 }
+
 uint32_t
 Reservation::GetNoFrames () const
 {
-  return m_pktList.size ();
+  return m_frames.size ();
 }
 
 uint32_t
@@ -95,10 +76,10 @@ Reservation::GetLength () const
   return m_length;
 }
 
-const std::list<std::pair <Ptr<Packet>, UanAddress > > &
-Reservation::GetPktList (void) const
+const std::vector<uint32_t> &
+Reservation::GetFrames (void) const
 {
-  return m_pktList;
+  return m_frames;
 }
 
 uint8_t
@@ -157,7 +138,9 @@ UanMacRc::UanMacRc ()
     m_rtsBlocked (false),
     m_currentRate (10),
     m_frameNo (0),
-    m_cleared (false)
+    m_cleared (false),
+    m_resRing (256),
+    m_resValid (256, false)
 {
   UanHeaderCommon ch;
   UanHeaderRcCts ctsh;
@@ -184,15 +167,15 @@ UanMacRc::Clear ()
       m_phy->Clear ();
       m_phy = 0;
     }
-  std::list<std::pair <Ptr<Packet>, UanAddress > >::iterator it;
-  for (it = m_pktQueue.begin (); it != m_pktQueue.end (); it++)
-    {
-      it->first = 0;
-    }
+  m_frames.clear ();
+  m_freeFrames.clear ();
   m_pktQueue.clear ();
-  m_resList.clear ();
+  m_resRing.assign (256, Reservation ());
+  m_resValid.assign (256, false);
+  m_gateways.clear ();
   m_startAgain.Cancel ();
   m_rtsEvent.Cancel ();
+  m_blockRtsEvent.Cancel ();
 }
 
 void
@@ -233,6 +216,16 @@ UanMacRc::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&UanMacRc::m_numRates),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NumberOfRateSets",
+                   "Number of blocks of NumberOfRates modes in each PHY mode list (one per gateway band)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&UanMacRc::m_numRateSets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ReservationCost",
+                   "Cost, in round trip propagation delay, of each reservation a gateway scheduled in its last cycle when choosing a gateway",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&UanMacRc::m_reservationCost),
+                   MakeTimeChecker ())
     .AddAttribute ("MinRetryRate",
                    "Smallest allowed RTS retry rate",
                    DoubleValue (0.01),
@@ -262,6 +255,12 @@ UanMacRc::GetTypeId (void)
     .AddTraceSource ("RX",
                      "A packet was destined for and received at this MAC layer",
                      MakeTraceSourceAccessor (&UanMacRc::m_rxLogger))
+    .AddTraceSource ("DequeueLatency",
+                     "A (data) packet was passed down to PHY, with the time since it arrived at the MAC",
+                     MakeTraceSourceAccessor (&UanMacRc::m_dequeueLatencyLogger))
+    .AddTraceSource ("AckLatency",
+                     "A (data) packet was acknowledged, with the time since it arrived at the MAC",
+                     MakeTraceSourceAccessor (&UanMacRc::m_ackLatencyLogger))
   ;
   return tid;
 }
@@ -293,7 +292,24 @@ UanMacRc::Enqueue (Ptr<Packet> packet, const Address &dest, uint16_t protocolNum
       return false;
     }
 
-  m_pktQueue.push_back (std::make_pair (packet, UanAddress::ConvertFrom (dest)));
+  Frame frame;
+  frame.packet = packet;
+  frame.dest = UanAddress::ConvertFrom (dest);
+  frame.enqueueTime = Simulator::Now ();
+  uint32_t index;
+  if (m_freeFrames.empty ())
+    {
+      index = m_frames.size ();
+      m_frames.push_back (frame);
+    }
+  else
+    {
+      index = m_freeFrames.back ();
+      m_freeFrames.pop_back ();
+      m_frames[index] = frame;
+    }
+  m_pktQueue.push_back (index);
+  m_enqueueLogger (packet, protocolNumber);
 
   switch (m_state)
     {
@@ -359,51 +375,60 @@ UanMacRc::ReceiveOkFromPhy (Ptr<Packet> pkt, double sinr, UanTxMode mode)
       break;
     case TYPE_RTS:
       // Currently don't respond to RTS packets at non-gateway nodes
-      // (Code assumes single network neighberhood)
       break;
     case TYPE_CTS:
       {
         uint32_t ctsBytes = ch.GetSerializedSize () + pkt->GetSize ();
-        m_assocAddr = ch.GetSrc ();
         UanHeaderRcCtsGlobal ctsg;
         pkt->RemoveHeader (ctsg);
-        m_currentRate = ctsg.GetRateNum ();
-        m_retryRate = m_minRetryRate + m_retryStep*ctsg.GetRetryRate ();
-
-        UanHeaderRcRts rhtmp;
 
         Time winDelay = ctsg.GetWindowTime ();
-
-        if (winDelay.GetSeconds () > 0)
-          {
-            m_rtsBlocked = false;
-            Simulator::Schedule (winDelay, &UanMacRc::BlockRtsing, this);
-          }
-        else
+        if (winDelay.GetSeconds () <= 0)
           {
             NS_FATAL_ERROR (Simulator::Now ().GetSeconds () << " Node " << m_address << " Received window period < 0");
           }
 
+        GatewayInfo &info = m_gateways[ch.GetSrc ()];
+        info.rateNum = ctsg.GetRateNum ();
+        info.retryRate = m_minRetryRate + m_retryStep*ctsg.GetRetryRate ();
+        info.windowEnd = Simulator::Now () + winDelay;
+        double bps = m_phy->GetMode (info.rateNum).GetDataRateBps ();
+        info.propDelay = Simulator::Now () - ctsg.GetTxTimeStamp () - Seconds (ctsBytes * 8.0 / bps);
+        info.load = 0;
+
+        bool forMe = false;
         UanHeaderRcCts ctsh;
+        UanHeaderRcCts myCts;
         ctsh.SetAddress (UanAddress::GetBroadcast ());
         while (pkt->GetSize () > 0)
           {
             pkt->RemoveHeader (ctsh);
+            info.load++;
             if (ctsh.GetAddress () == m_address)
               {
-                if (m_state == GWPSENT)
-                  {
-                    m_assocAddr = ch.GetSrc ();
-                    ScheduleData (ctsh, ctsg, ctsBytes);
-                  }
-                else if (m_state == RTSSENT)
-                  {
-                    ScheduleData (ctsh, ctsg, ctsBytes);
-                  }
-                else
-                  {
-                    NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " received CTS while state != RTSSENT or GWPING");
-                  }
+                forMe = true;
+                myCts = ctsh;
+              }
+          }
+
+        if (m_assocAddr == UanAddress::GetBroadcast () || (forMe && m_state == GWPSENT))
+          {
+            m_assocAddr = ch.GetSrc ();
+          }
+        if (ch.GetSrc () == m_assocAddr)
+          {
+            UseGateway (info);
+          }
+
+        if (forMe)
+          {
+            if (m_state == GWPSENT || m_state == RTSSENT)
+              {
+                ScheduleData (myCts, ctsg, ctsBytes, ch.GetSrc ());
+              }
+            else
+              {
+                NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " received CTS while state != RTSSENT or GWPING");
               }
           }
       }
@@ -412,12 +437,34 @@ UanMacRc::ReceiveOkFromPhy (Ptr<Packet> pkt, double sinr, UanTxMode mode)
       // Do not respond to GWPINGS at non-gateway nodes
       break;
     case TYPE_ACK:
-      m_rtsBlocked = true;
+      if (ch.GetSrc () == m_assocAddr)
+        {
+          m_rtsBlocked = true;
+        }
       if (ch.GetDest () != m_address)
         {
           return;
         }
-      ProcessAck (pkt);
+      {
+        UanHeaderRcAck ah;
+        pkt->RemoveHeader (ah);
+        ProcessAck (ah);
+      }
+      break;
+    case TYPE_ACKAGG:
+      if (ch.GetSrc () == m_assocAddr)
+        {
+          m_rtsBlocked = true;
+        }
+      {
+        UanHeaderRcAckAgg agg;
+        pkt->RemoveHeader (agg);
+        UanHeaderRcAck ah;
+        if (agg.GetAck (m_address, ah))
+          {
+            ProcessAck (ah);
+          }
+      }
       break;
     default:
       NS_FATAL_ERROR ("Unknown packet type " << ch.GetType () << " received at node " << GetAddress ());
@@ -426,29 +473,29 @@ UanMacRc::ReceiveOkFromPhy (Ptr<Packet> pkt, double sinr, UanTxMode mode)
 }
 
 void
-UanMacRc::ScheduleData (const UanHeaderRcCts &ctsh, const UanHeaderRcCtsGlobal &ctsg, uint32_t ctsBytes)
+UanMacRc::ScheduleData (const UanHeaderRcCts &ctsh, const UanHeaderRcCtsGlobal &ctsg, uint32_t ctsBytes, UanAddress gateway)
 {
   NS_ASSERT (m_state == RTSSENT || m_state == GWPSENT);
 
 
 
-  std::list<Reservation>::iterator it = m_resList.begin ();
-  for (; it != m_resList.end (); it++)
+  Reservation *res = FindReservation (ctsh.GetFrameNo ());
+  if (res == 0)
     {
-      if (it->GetFrameNo () == ctsh.GetFrameNo ())
-        {
-          break;
-        }
+      NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " received CTS packet with no corresponding reservation!");
+      return;
     }
-  if (it == m_resList.end ())
+  if (res->IsTransmitted ())
     {
-      NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " received CTS packet with no corresponding reservation!");
+      // Reservation was already scheduled by (another) gateway
+      NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " received second CTS for frame " << (uint32_t) ctsh.GetFrameNo ());
       return;
     }
   NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " received CTS packet.  Scheduling data");
-  it->SetTransmitted ();
+  res->SetTransmitted ();
 
-  double currentBps = m_phy->GetMode (m_currentRate).GetDataRateBps ();
+  uint32_t rate = ctsg.GetRateNum ();
+  double currentBps = m_phy->GetMode (rate).GetDataRateBps ();
 
   m_learnedProp = Simulator::Now () - ctsg.GetTxTimeStamp () - Seconds (ctsBytes * 8.0 / currentBps);
 
@@ -460,15 +507,11 @@ UanMacRc::ScheduleData (const UanHeaderRcCts &ctsh, const UanHeaderRcCtsGlobal &
 
   Time frameDelay = Seconds (0);
 
-  const std::list<std::pair <Ptr<Packet>, UanAddress > > l = it->GetPktList ();
-  std::list<std::pair <Ptr<Packet>, UanAddress > >::const_iterator pit;
-  pit = l.begin ();
-
-
-
-  for (uint32_t i = 0; i < it->GetNoFrames (); i++, pit++)
+  const std::vector<uint32_t> &frames = res->GetFrames ();
+  for (uint32_t i = 0; i < frames.size (); i++)
     {
-      Ptr<Packet> pkt = (*pit).first->Copy ();
+      const Frame &frame = m_frames[frames[i]];
+      Ptr<Packet> pkt = frame.packet->Copy ();
 
       UanHeaderRcData dh;
       dh.SetFrameNo (i);
@@ -477,7 +520,7 @@ UanMacRc::ScheduleData (const UanHeaderRcCts &ctsh, const UanHeaderRcCtsGlobal &
 
       UanHeaderCommon ch;
       ch.SetType (TYPE_DATA);
-      ch.SetDest (m_assocAddr);
+      ch.SetDest (gateway);
       ch.SetSrc (m_address);
 
       pkt->AddHeader (ch);
@@ -494,7 +537,7 @@ UanMacRc::ScheduleData (const UanHeaderRcCts &ctsh, const UanHeaderRcCtsGlobal &
             }
         }
       NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " scheduling with delay " << eventTime.GetSeconds () << " propDelay " << m_learnedProp.GetSeconds () << " start delay " << startDelay.GetSeconds () << " arrival time " << arrTime.GetSeconds ());
-      Simulator::Schedule (eventTime, &UanMacRc::SendPacket, this, pkt, m_currentRate);
+      Simulator::Schedule (eventTime, &UanMacRc::SendData, this, pkt, rate, frame.enqueueTime);
       frameDelay = frameDelay + m_sifs + Seconds (pkt->GetSize () / currentBps);
     }
 
@@ -533,6 +576,9 @@ UanMacRc::SendPacket (Ptr<Packet> pkt, uint32_t rate)
     case TYPE_ACK:
       type = "ACK";
       break;
+    case TYPE_ACKAGG:
+      type = "ACKAGG";
+      break;
     case TYPE_GWPING:
       type = "GWPING";
       break;
@@ -546,55 +592,114 @@ UanMacRc::SendPacket (Ptr<Packet> pkt, uint32_t rate)
 }
 
 void
-UanMacRc::ProcessAck (Ptr<Packet> ack)
+UanMacRc::SendData (Ptr<Packet> pkt, uint32_t rate, Time enqueueTime)
 {
-  UanHeaderRcAck ah;
-  ack->RemoveHeader (ah);
+  m_dequeueLatencyLogger (pkt, Simulator::Now () - enqueueTime);
+  SendPacket (pkt, rate);
+}
 
-  std::list<Reservation>::iterator it = m_resList.begin ();
-  for (; it != m_resList.end (); it++)
-    {
-      if (it->GetFrameNo () == ah.GetFrameNo ())
-        {
-          break;
-        }
-    }
-  if (it == m_resList.end ())
+void
+UanMacRc::ProcessAck (const UanHeaderRcAck &ah)
+{
+  Reservation *res = FindReservation (ah.GetFrameNo ());
+  if (res == 0)
     {
       NS_LOG_DEBUG ("In " << __func__ << " could not find reservation corresponding to received ACK");
       return;
     }
-  if (!it->IsTransmitted ())
+  if (!res->IsTransmitted ())
     {
       return;
     }
-  if (ah.GetNoNacks () > 0)
-    {
-      const std::list<std::pair <Ptr<Packet>, UanAddress > > l = it->GetPktList ();
-      std::list<std::pair <Ptr<Packet>, UanAddress > >::const_iterator pit;
-      pit = l.begin ();
 
-      const std::set<uint8_t> &nacks = ah.GetNackedFrames ();
-      std::set<uint8_t>::iterator nit = nacks.begin ();
-      uint8_t pnum = 0;
-      for (; nit != nacks.end (); nit++)
+  // NACKed frames go back to the front of the queue in their original
+  // order, the others are acknowledged and return to the pool
+  const std::vector<uint32_t> &frames = res->GetFrames ();
+  const std::set<uint8_t> &nacks = ah.GetNackedFrames ();
+  for (uint32_t i = frames.size (); i > 0; i--)
+    {
+      uint32_t index = frames[i - 1];
+      if (nacks.find (i - 1) != nacks.end ())
         {
-          NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " Received NACK for " << (uint32_t) *nit);
-          while (pnum < *nit)
-            {
-              pit++;
-              pnum++;
-            }
-          UanHeaderRcData dh;
-          UanHeaderCommon ch;
-          m_pktQueue.push_front (*pit);
+          NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " Received NACK for " << i - 1);
+          m_pktQueue.push_front (index);
+        }
+      else
+        {
+          m_ackLatencyLogger (m_frames[index].packet, Simulator::Now () - m_frames[index].enqueueTime);
+          m_frames[index].packet = 0;
+          m_freeFrames.push_back (index);
         }
     }
-  else
+  if (nacks.empty ())
     {
       NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " received ACK for all frames");
     }
-  m_resList.erase (it);
+  m_resValid[ah.GetFrameNo ()] = false;
+  m_resRing[ah.GetFrameNo ()] = Reservation ();
+}
+
+Reservation &
+UanMacRc::CreateReservation (void)
+{
+  // A reservation still holding this frame number was created 256
+  // reservations ago, so its ACK was lost.  Its frames go out first.
+  if (m_resValid[m_frameNo])
+    {
+      ExpireReservation (m_frameNo);
+    }
+
+  uint32_t numFrames = m_pktQueue.size ();
+  if (m_maxFrames != 0 && m_maxFrames < numFrames)
+    {
+      numFrames = m_maxFrames;
+    }
+  UanHeaderRcData dh;
+  UanHeaderCommon ch;
+  std::vector<uint32_t> frames;
+  frames.reserve (numFrames);
+  uint32_t length = 0;
+  for (uint32_t i = 0; i < numFrames; i++)
+    {
+      uint32_t index = m_pktQueue.front ();
+      m_pktQueue.pop_front ();
+      length += m_frames[index].packet->GetSize () + ch.GetSerializedSize () + dh.GetSerializedSize ();
+      frames.push_back (index);
+    }
+  if (numFrames > 0)
+    {
+      NotifyTxReady ();
+    }
+
+  m_resRing[m_frameNo] = Reservation (frames, length, m_frameNo);
+  m_resValid[m_frameNo] = true;
+  m_resRing[m_frameNo].AddTimestamp (Simulator::Now ());
+  return m_resRing[m_frameNo++];
+}
+
+void
+UanMacRc::ExpireReservation (uint8_t frameNo)
+{
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " giving up reservation " << (uint32_t) frameNo << " with no ACK");
+  const std::vector<uint32_t> &frames = m_resRing[frameNo].GetFrames ();
+  for (uint32_t i = frames.size (); i > 0; i--)
+    {
+      m_pktQueue.push_front (frames[i - 1]);
+    }
+  m_resValid[frameNo] = false;
+  m_resRing[frameNo] = Reservation ();
+}
+
+Reservation *
+UanMacRc::FindReservation (uint8_t frameNo)
+{
+  return m_resValid[frameNo] ? &m_resRing[frameNo] : 0;
+}
+
+Reservation *
+UanMacRc::GetLastReservation (void)
+{
+  return FindReservation (m_frameNo - 1);
 }
 
 UanHeaderRcRts
@@ -614,20 +719,18 @@ void
 UanMacRc::Associate (void)
 {
   m_cntrlSends++;
+  SelectGateway ();
 
-  Reservation res (m_pktQueue, m_frameNo, m_maxFrames);
-  res.AddTimestamp (Simulator::Now ());
-  m_frameNo++;
-  m_resList.push_back (res);
+  Reservation &res = CreateReservation ();
   Ptr<UanPhyDual> phyDual = m_phy->GetObject<UanPhyDual> ();
   bool phy1ok = IsPhy1Ok ();
   if (phy1ok && !phyDual->IsPhy2Tx () & !m_rtsBlocked)
     {
       Ptr<Packet> pkt = Create<Packet> (0);
       pkt->AddHeader (CreateRtsHeader (res));
-      pkt->AddHeader (UanHeaderCommon (m_address, UanAddress::GetBroadcast (), (uint8_t) TYPE_GWPING));
+      pkt->AddHeader (UanHeaderCommon (m_address, m_assocAddr, (uint8_t) TYPE_GWPING));
       NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Sending first GWPING " << *pkt);
-      SendPacket (pkt,m_currentRate + m_numRates);
+      SendPacket (pkt, GetControlMode ());
     }
   m_state = GWPSENT;
   NS_ASSERT (!m_rtsEvent.IsRunning ());
@@ -650,16 +753,15 @@ UanMacRc::AssociateTimeout ()
     {
       Ptr<Packet> pkt = Create<Packet> ();
 
-      Reservation res = m_resList.back ();
-      m_resList.pop_back ();
-      res.AddTimestamp (Simulator::Now ());
-      res.IncrementRetry ();
+      Reservation *res = GetLastReservation ();
+      NS_ASSERT (res != 0);
+      res->AddTimestamp (Simulator::Now ());
+      res->IncrementRetry ();
 
-      pkt->AddHeader (CreateRtsHeader (res));
-      pkt->AddHeader (UanHeaderCommon (m_address, UanAddress::GetBroadcast (), (uint8_t) TYPE_GWPING));
+      pkt->AddHeader (CreateRtsHeader (*res));
+      pkt->AddHeader (UanHeaderCommon (m_address, m_assocAddr, (uint8_t) TYPE_GWPING));
 
-      SendPacket (pkt,m_currentRate + m_numRates);
-      m_resList.push_back (res);
+      SendPacket (pkt, GetControlMode ());
     }
   NS_ASSERT (!m_rtsEvent.IsRunning ());
   ExponentialVariable ev (1.0 / m_retryRate);
@@ -678,19 +780,17 @@ UanMacRc::SendRts (void)
     }
 
   NS_ASSERT (!m_pktQueue.empty ());
+  SelectGateway ();
 
-  Reservation res (m_pktQueue, m_frameNo, m_maxFrames);
-  res.AddTimestamp (Simulator::Now ());
-  m_frameNo++;
-  m_resList.push_back (res);
+  Reservation &res = CreateReservation ();
   Ptr<UanPhyDual> phyDual = m_phy->GetObject<UanPhyDual> ();
   bool phy1ok = IsPhy1Ok ();
   if (phy1ok && !phyDual->IsPhy2Tx () && !m_rtsBlocked )
     {
       Ptr<Packet> pkt = Create<Packet> (0);
       pkt->AddHeader (CreateRtsHeader (res));
-      pkt->AddHeader (UanHeaderCommon (m_address, UanAddress::GetBroadcast (), (uint8_t) TYPE_RTS));
-      SendPacket (pkt,m_currentRate + m_numRates);
+      pkt->AddHeader (UanHeaderCommon (m_address, m_assocAddr, (uint8_t) TYPE_RTS));
+      SendPacket (pkt, GetControlMode ());
     }
   m_state = RTSSENT;
   NS_ASSERT (!m_rtsEvent.IsRunning ());
@@ -712,7 +812,7 @@ UanMacRc::IsPhy1Ok ()
       Ptr<Packet> pkt = phyDual->GetPhy1PacketRx ();
       UanHeaderCommon ch;
       pkt->PeekHeader (ch);
-      if (ch.GetType () == TYPE_CTS || ch.GetType () == TYPE_ACK)
+      if (ch.GetType () == TYPE_CTS || ch.GetType () == TYPE_ACK || ch.GetType () == TYPE_ACKAGG)
         {
           phy1ok = false;
         }
@@ -739,21 +839,19 @@ UanMacRc::RtsTimeout (void)
   if (phy1ok && !phyDual->IsPhy2Tx () && !m_rtsBlocked)
     {
 
-      if (m_resList.empty ())
+      Reservation *res = GetLastReservation ();
+      if (res == 0)
         {
           NS_FATAL_ERROR (Simulator::Now ().GetSeconds () << " Node " << m_address << " tried to retry RTS with empty reservation list");
         }
       Ptr<Packet> pkt = Create<Packet> (0);
 
-      Reservation res = m_resList.back ();
-      NS_ASSERT (!res.IsTransmitted ());
-      m_resList.pop_back ();
-      res.AddTimestamp (Simulator::Now ());
-      res.IncrementRetry ();
-      m_resList.push_back (res);
-      pkt->AddHeader (CreateRtsHeader (res));
-      pkt->AddHeader (UanHeaderCommon (m_address, UanAddress::GetBroadcast (), (uint8_t) TYPE_RTS));
-      SendPacket (pkt,m_currentRate + m_numRates);
+      NS_ASSERT (!res->IsTransmitted ());
+      res->AddTimestamp (Simulator::Now ());
+      res->IncrementRetry ();
+      pkt->AddHeader (CreateRtsHeader (*res));
+      pkt->AddHeader (UanHeaderCommon (m_address, m_assocAddr, (uint8_t) TYPE_RTS));
+      SendPacket (pkt, GetControlMode ());
 
     }
   m_state = RTSSENT;
@@ -769,4 +867,61 @@ UanMacRc::BlockRtsing (void)
   m_rtsBlocked = true;
 }
 
+void
+UanMacRc::SelectGateway (void)
+{
+  if (m_gateways.size () < 2)
+    {
+      return;
+    }
+  std::map<UanAddress, GatewayInfo>::iterator current = m_gateways.find (m_assocAddr);
+  std::map<UanAddress, GatewayInfo>::iterator best = m_gateways.end ();
+  double bestCost = 0;
+  for (std::map<UanAddress, GatewayInfo>::iterator it = m_gateways.begin (); it != m_gateways.end (); it++)
+    {
+      double cost = 2 * it->second.propDelay.GetSeconds () + it->second.load * m_reservationCost.GetSeconds ();
+      if (best == m_gateways.end () || cost < bestCost)
+        {
+          best = it;
+          bestCost = cost;
+        }
+    }
+  if (best == current)
+    {
+      return;
+    }
+  if (current != m_gateways.end ())
+    {
+      double currentCost = 2 * current->second.propDelay.GetSeconds () + current->second.load * m_reservationCost.GetSeconds ();
+      UniformVariable uv (0, 1);
+      if (currentCost <= 0 || uv.GetValue () >= 1 - bestCost / currentCost)
+        {
+          return;
+        }
+    }
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Node " << m_address << " switching from gateway " << m_assocAddr << " to " << best->first);
+  m_assocAddr = best->first;
+  UseGateway (best->second);
+}
+
+void
+UanMacRc::UseGateway (const GatewayInfo &info)
+{
+  m_currentRate = info.rateNum;
+  m_retryRate = info.retryRate;
+  m_blockRtsEvent.Cancel ();
+  Time now = Simulator::Now ();
+  m_rtsBlocked = info.windowEnd <= now;
+  if (!m_rtsBlocked)
+    {
+      m_blockRtsEvent = Simulator::Schedule (info.windowEnd - now, &UanMacRc::BlockRtsing, this);
+    }
+}
+
+uint32_t
+UanMacRc::GetControlMode (void) const
+{
+  return m_currentRate + m_numRateSets * m_numRates;
+}
+
 } // namespace ns3
@@ -29,7 +29,8 @@
 #include "ns3/traced-callback.h"
 #include "ns3/event-id.h"
 
-#include <list>
+#include <deque>
+#include <map>
 #include <utility>
 #include <vector>
 
@@ -41,6 +42,7 @@ class UanTxMode;
 class UanHeaderRcRts;
 class UanHeaderRcCts;
 class UanHeaderRcCtsGlobal;
+class UanHeaderRcAck;
 class UanPhy;
 
 
@@ -56,12 +58,12 @@ public:
    */
   Reservation ();
   /**
-   * \brief Create Reservation object with given packet list, frame number and max packets
-   * \param list List of packets for assigned to reservation
+   * \brief Create Reservation object with given frames and frame number
+   * \param frames Indices of the frames of the reservation in the MAC's frame pool
+   * \param length Total byte length of the frames (with headers)
    * \param frameNo Frame number of reservation transmission
-   * \param maxPkts Maximum number of packets to assign to reservation from packet list (0 = no maximum)
    */
-  Reservation (std::list<std::pair <Ptr<Packet>, UanAddress > > &list, uint8_t frameNo, uint32_t maxPkts = 0);
+  Reservation (const std::vector<uint32_t> &frames, uint32_t length, uint8_t frameNo);
   ~Reservation ();
   /**
    * \returns number of frames in reservation
@@ -72,9 +74,9 @@ public:
    */
   uint32_t GetLength () const;
   /**
-   * \returns reference to list of packets in this reservation
+   * \returns Frame pool indices of the frames in this reservation
    */
-  const std::list<std::pair <Ptr<Packet>, UanAddress > > &GetPktList (void) const;
+  const std::vector<uint32_t> &GetFrames (void) const;
   /**
    * \returns Frame number of reservation
    */
@@ -110,7 +112,7 @@ public:
    */
   void SetTransmitted (bool t = true);
 private:
-  std::list<std::pair <Ptr<Packet>, UanAddress > > m_pktList;
+  std::vector<uint32_t> m_frames;
   uint32_t m_length;
   uint8_t m_frameNo;
   std::vector<Time> m_timestamp;
@@ -126,8 +128,19 @@ private:
  *
  * This MAC protocol assumes a network topology where all traffic
  * is destined for a set of GW nodes which are connected via
- * some out of band (RF?) means.  This particular implementation
- * assumes that there is only a single gateway.
+ * some out of band (RF?) means.
+ *
+ * Each gateway broadcasts a CTS at the start of its cycles.  From these
+ * the node keeps, per gateway, the rate and retry rate assigned, the
+ * reservation window, the propagation delay and the number of
+ * reservations scheduled (the load).  When it starts a new reservation
+ * it chooses the gateway with the lowest cost, twice the propagation
+ * delay plus ReservationCost per reservation in the gateway's last
+ * cycle.  To keep all nodes from moving to the same gateway at once a
+ * node leaves its current gateway only with probability
+ * 1 - bestCost / currentCost.  RTS and GWPING packets are addressed to
+ * the chosen gateway (broadcast before any CTS was heard).  With several
+ * gateways NumberOfRates and NumberOfRateSets must match the gateways'.
  *
  * For more information on class operation email
  * lentracy@u.washington.edu
@@ -137,7 +150,7 @@ class UanMacRc : public UanMac
 {
 public:
   enum {
-    TYPE_DATA, TYPE_GWPING, TYPE_RTS, TYPE_CTS, TYPE_ACK
+    TYPE_DATA, TYPE_GWPING, TYPE_RTS, TYPE_CTS, TYPE_ACK, TYPE_ACKAGG
   };
   UanMacRc ();
   virtual ~UanMacRc ();
@@ -158,6 +171,28 @@ private:
     UNASSOCIATED, GWPSENT, IDLE, RTSSENT, DATATX
   };
 
+  /**
+   * \brief What a node learned about a gateway from its last CTS
+   */
+  struct GatewayInfo
+  {
+    uint32_t rateNum;
+    double retryRate;
+    Time windowEnd;
+    Time propDelay;
+    uint32_t load;
+  };
+
+  /**
+   * \brief Data packet held in the frame pool until it is acknowledged
+   */
+  struct Frame
+  {
+    Ptr<Packet> packet;
+    UanAddress dest;
+    Time enqueueTime;
+  };
+
   State m_state;
   bool m_rtsBlocked;
 
@@ -167,6 +202,8 @@ private:
   UanAddress m_assocAddr;
   Ptr<UanPhy> m_phy;
   uint32_t m_numRates;
+  uint32_t m_numRateSets;
+  Time m_reservationCost;
   uint32_t m_currentRate;
   uint32_t m_maxFrames;
   uint32_t m_queueLimit;
@@ -183,16 +220,26 @@ private:
 
   bool m_cleared;
 
-  std::list<std::pair <Ptr<Packet>, UanAddress > > m_pktQueue;
-  std::list<Reservation> m_resList;
+  /// Frame pool; reservations and the queue refer to frames by index
+  std::vector<Frame> m_frames;
+  std::vector<uint32_t> m_freeFrames;
+  /// Frames waiting for a reservation (NACKed frames go to the front)
+  std::deque<uint32_t> m_pktQueue;
+  /// Outstanding reservations indexed by frame number
+  std::vector<Reservation> m_resRing;
+  std::vector<bool> m_resValid;
+  std::map<UanAddress, GatewayInfo> m_gateways;
 
   Callback<void, Ptr<Packet>, const UanAddress& > m_forwardUpCb;
 
   TracedCallback<Ptr<const Packet>, UanTxMode > m_rxLogger;
   TracedCallback<Ptr<const Packet>, uint16_t > m_enqueueLogger;
   TracedCallback<Ptr<const Packet>, uint16_t > m_dequeueLogger;
+  TracedCallback<Ptr<const Packet>, Time> m_dequeueLatencyLogger;
+  TracedCallback<Ptr<const Packet>, Time> m_ackLatencyLogger;
 
   EventId m_rtsEvent;
+  EventId m_blockRtsEvent;
   void ReceiveOkFromPhy (Ptr<Packet>, double sinr, UanTxMode mode);
 
   void Associate (void);
@@ -200,11 +247,46 @@ private:
   void SendRts (void);
   void RtsTimeout (void);
   UanHeaderRcRts CreateRtsHeader (const Reservation &res);
-  void ScheduleData (const UanHeaderRcCts &ctsh, const UanHeaderRcCtsGlobal &ctsg, uint32_t ctsBytes);
-  void ProcessAck (Ptr<Packet> ack);
+  void ScheduleData (const UanHeaderRcCts &ctsh, const UanHeaderRcCtsGlobal &ctsg, uint32_t ctsBytes, UanAddress gateway);
+  void ProcessAck (const UanHeaderRcAck &ah);
+  /**
+   * Moves up to MaxFrames frames from the queue into a new reservation
+   * with the next frame number
+   * \returns The new reservation
+   */
+  Reservation &CreateReservation (void);
+  /**
+   * Gives up an outstanding reservation whose ACK was lost and puts its
+   * frames back at the front of the queue
+   * \param frameNo Frame number of reservation
+   */
+  void ExpireReservation (uint8_t frameNo);
+  /**
+   * \param frameNo Frame number
+   * \returns Outstanding reservation with frame number frameNo, 0 if none
+   */
+  Reservation *FindReservation (uint8_t frameNo);
+  /**
+   * \returns Most recently created reservation, 0 if it is no longer outstanding
+   */
+  Reservation *GetLastReservation (void);
+  void SendData (Ptr<Packet> pkt, uint32_t rate, Time enqueueTime);
   void SendPacket (Ptr<Packet> pkt, uint32_t rate);
   bool IsPhy1Ok (void);
   void BlockRtsing (void);
+  /**
+   * Chooses the gateway for the next reservation
+   */
+  void SelectGateway (void);
+  /**
+   * Takes over rate, retry rate and reservation window of a gateway
+   * \param info Gateway to use
+   */
+  void UseGateway (const GatewayInfo &info);
+  /**
+   * \returns PHY mode number for RTS and GWPING packets
+   */
+  uint32_t GetControlMode (void) const;
 
   static uint32_t m_cntrlSends;
 
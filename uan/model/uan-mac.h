@@ -24,6 +24,7 @@
 #include "ns3/address.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
+#include "ns3/callback.h"
 
 #include "ns3/address.h"
 #include "ns3/nstime.h"
@@ -89,6 +90,30 @@ public:
    */
   virtual void Clear (void) = 0;
 
+  /**
+   * \param cb Callback to be called when the MAC can accept a packet
+   * again after refusing one (or after holding one) in Enqueue
+   */
+  void SetTxReadyCb (Callback<void> cb)
+  {
+    m_txReadyCb = cb;
+  }
+
+protected:
+  /**
+   * Called by MACs whenever a slot for a new packet becomes free.
+   * Must not be called from within Enqueue.
+   */
+  void NotifyTxReady (void)
+  {
+    if (!m_txReadyCb.IsNull ())
+      {
+        m_txReadyCb ();
+      }
+  }
+
+private:
+  Callback<void> m_txReadyCb;
 };
 
 }
@@ -22,12 +22,14 @@
 #include "ns3/traced-callback.h"
 #include "ns3/pointer.h"
 #include "ns3/node.h"
+#include "ns3/simulator.h"
 #include "ns3/assert.h"
 #include "uan-net-device.h"
 #include "uan-phy.h"
 #include "uan-mac.h"
 #include "uan-channel.h"
 #include "uan-transducer.h"
+#include "uan-tx-queue.h"
 #include "ns3/log.h"
 
 NS_LOG_COMPONENT_DEFINE ("UanNetDevice");
@@ -76,6 +78,12 @@ UanNetDevice::Clear ()
       m_trans->Clear ();
       m_trans = 0;
     }
+  if (m_txQueue)
+    {
+      m_txQueue->Clear ();
+      m_txQueue = 0;
+    }
+  m_txReadyEvent.Cancel ();
 }
 
 void
@@ -109,9 +117,14 @@ UanNetDevice::GetTypeId ()
                    MakePointerAccessor (&UanNetDevice::GetTransducer,
                                         &UanNetDevice::SetTransducer),
                    MakePointerChecker<UanTransducer> ())
+    .AddAttribute ("TxQueue", "The transmit queue of this device (none by default).",
+                   PointerValue (),
+                   MakePointerAccessor (&UanNetDevice::GetTxQueue,
+                                        &UanNetDevice::SetTxQueue),
+                   MakePointerChecker<UanTxQueue> ())
     .AddTraceSource ("Rx", "Received payload from the MAC layer.",
                      MakeTraceSourceAccessor (&UanNetDevice::m_rxLogger))
-    .AddTraceSource ("Tx", "Send payload to the MAC layer.",
+    .AddTraceSource ("Tx", "Payload accepted for transmission.",
                      MakeTraceSourceAccessor (&UanNetDevice::m_txLogger))
   ;
   return tid;
@@ -132,6 +145,7 @@ UanNetDevice::SetMac (Ptr<UanMac> mac)
           NS_LOG_DEBUG ("Attached MAC to PHY");
         }
       m_mac->SetForwardUpCb (MakeCallback (&UanNetDevice::ForwardUp, this));
+      m_mac->SetTxReadyCb (MakeCallback (&UanNetDevice::TxReady, this));
     }
 
 }
@@ -290,7 +304,58 @@ UanNetDevice::IsPointToPoint () const
 bool
 UanNetDevice::Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber)
 {
-  return m_mac->Enqueue (packet, dest, protocolNumber);
+  if (m_txQueue == 0)
+    {
+      // The MAC adds its headers on Enqueue, so trace the payload as given
+      Ptr<const Packet> payload = packet->Copy ();
+      if (!m_mac->Enqueue (packet, dest, protocolNumber))
+        {
+          return false;
+        }
+      m_txLogger (payload, UanAddress::ConvertFrom (dest));
+      return true;
+    }
+  if (!m_txQueue->Enqueue (packet, dest, protocolNumber))
+    {
+      return false;
+    }
+  m_txLogger (packet, UanAddress::ConvertFrom (dest));
+  SendFromQueue ();
+  return true;
+}
+
+void
+UanNetDevice::SendFromQueue (void)
+{
+  while (!m_txQueue->IsEmpty ())
+    {
+      const UanTxQueue::Item &item = m_txQueue->Peek ();
+      if (!m_mac->Enqueue (item.packet, item.dest, item.protocolNumber))
+        {
+          return;
+        }
+      m_txQueue->Dequeue ();
+    }
+}
+
+void
+UanNetDevice::TxReady (void)
+{
+  // The MAC may still be in the middle of changing state
+  if (!m_txReadyEvent.IsRunning ())
+    {
+      m_txReadyEvent = Simulator::ScheduleNow (&UanNetDevice::DoTxReady, this);
+    }
+}
+
+void
+UanNetDevice::DoTxReady (void)
+{
+  if (m_txQueue != 0)
+    {
+      SendFromQueue ();
+    }
+  m_txReady ();
 }
 
 bool
@@ -362,12 +427,30 @@ UanNetDevice::SetTransducer (Ptr<UanTransducer> trans)
 
 }
 
+Ptr<UanTxQueue>
+UanNetDevice::GetTxQueue (void) const
+{
+  return m_txQueue;
+}
+
+void
+UanNetDevice::SetTxQueue (Ptr<UanTxQueue> queue)
+{
+  m_txQueue = queue;
+}
+
 void
 UanNetDevice::AddLinkChangeCallback (Callback<void> callback)
 {
   m_linkChanges.ConnectWithoutContext (callback);
 }
 
+void
+UanNetDevice::AddTxReadyCallback (Callback<void> callback)
+{
+  m_txReady.ConnectWithoutContext (callback);
+}
+
 
 void
 UanNetDevice::SetPromiscReceiveCallback (PromiscReceiveCallback cb)
@@ -24,6 +24,7 @@
 #include "ns3/net-device.h"
 #include "ns3/pointer.h"
 #include "ns3/traced-callback.h"
+#include "ns3/event-id.h"
 #include "uan-address.h"
 #include <list>
 
@@ -33,11 +34,21 @@ class UanChannel;
 class UanPhy;
 class UanMac;
 class UanTransducer;
+class UanTxQueue;
 
 /**
  * \class UanNetDevice
  *
  * \brief Net device for UAN models
+ *
+ * If a UanTxQueue is set (attribute TxQueue), packets sent are queued in
+ * the device and handed to the MAC whenever it can accept them, so
+ * packets refused by a busy MAC are not lost.  Without a queue, Send
+ * returns false when the MAC refuses the packet.
+ *
+ * Upper layers which want to pace themselves can register with
+ * AddTxReadyCallback to be woken each time the MAC can accept the next
+ * packet (after queued packets have been handed to it).
  */
 class UanNetDevice : public NetDevice
 {
@@ -89,6 +100,18 @@ public:
    * \param trans Transducer to use in this net device
    */
   void SetTransducer (Ptr<UanTransducer> trans);
+  /**
+   * \returns Transmit queue of this device (0 if packets go to the MAC directly)
+   */
+  Ptr<UanTxQueue> GetTxQueue (void) const;
+  /**
+   * \param queue Transmit queue to use in this net device
+   */
+  void SetTxQueue (Ptr<UanTxQueue> queue);
+  /**
+   * \param callback Callback invoked whenever the MAC can accept the next packet
+   */
+  void AddTxReadyCallback (Callback<void> callback);
 
   /**
    * Clears all pointer references
@@ -123,18 +146,33 @@ public:
 private:
   virtual void ForwardUp (Ptr<Packet> pkt, const UanAddress &src);
   Ptr<UanChannel> DoGetChannel (void) const;
+  /**
+   * Called by the MAC when it can accept a packet again
+   */
+  void TxReady (void);
+  /**
+   * Hands queued packets to the MAC until it refuses one
+   */
+  void SendFromQueue (void);
+  /**
+   * Empties the queue into the MAC as far as possible and wakes upper layers
+   */
+  void DoTxReady (void);
 
   Ptr<UanTransducer> m_trans;
   Ptr<Node> m_node;
   Ptr<UanChannel> m_channel;
   Ptr<UanMac> m_mac;
   Ptr<UanPhy> m_phy;
+  Ptr<UanTxQueue> m_txQueue;
+  EventId m_txReadyEvent;
 
   std::string m_name;
   uint32_t m_ifIndex;
   uint16_t m_mtu;
   bool m_linkup;
   TracedCallback<> m_linkChanges;
+  TracedCallback<> m_txReady;
   ReceiveCallback m_forwardUp;
 
   TracedCallback<Ptr<const Packet>, UanAddress> m_rxLogger;
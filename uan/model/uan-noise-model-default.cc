@@ -20,14 +20,27 @@
 
 #include "uan-noise-model-default.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
 
 #include <cmath>
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("UanNoiseModelDefault");
 
 namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (UanNoiseModelDefault);
 
+// Tabulated range, log10 of frequency in kHz (10 Hz to 1 MHz)
+static const double MIN_LOG_F = -2.0;
+static const double MAX_LOG_F = 3.0;
+
 UanNoiseModelDefault::UanNoiseModelDefault ()
+  : m_wind (1),
+    m_shipping (0),
+    m_useTable (false),
+    m_tableStep (0.01)
 {
 
 }
@@ -44,20 +57,156 @@ UanNoiseModelDefault::GetTypeId (void)
     .AddConstructor<UanNoiseModelDefault> ()
     .AddAttribute ("Wind", "Wind speed in m/s",
                    DoubleValue (1),
-                   MakeDoubleAccessor (&UanNoiseModelDefault::m_wind),
+                   MakeDoubleAccessor (&UanNoiseModelDefault::SetWind,
+                                       &UanNoiseModelDefault::GetWind),
                    MakeDoubleChecker<double> (0))
     .AddAttribute ("Shipping", "Shipping contribution to noise between 0 and 1",
                    DoubleValue (0),
-                   MakeDoubleAccessor (&UanNoiseModelDefault::m_shipping),
+                   MakeDoubleAccessor (&UanNoiseModelDefault::SetShipping,
+                                       &UanNoiseModelDefault::GetShipping),
                    MakeDoubleChecker<double> (0,1))
+    .AddAttribute ("UseTable", "Interpolate noise from a precomputed spectrum table",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UanNoiseModelDefault::SetUseTable,
+                                        &UanNoiseModelDefault::GetUseTable),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TableStep", "Spacing of noise table entries in decades of frequency",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&UanNoiseModelDefault::SetTableStep,
+                                       &UanNoiseModelDefault::GetTableStep),
+                   MakeDoubleChecker<double> (1e-4, 0.5))
   ;
   return tid;
 }
 
+void
+UanNoiseModelDefault::SetWind (double wind)
+{
+  m_wind = wind;
+  Invalidate ();
+}
+
+double
+UanNoiseModelDefault::GetWind (void) const
+{
+  return m_wind;
+}
+
+void
+UanNoiseModelDefault::SetShipping (double shipping)
+{
+  m_shipping = shipping;
+  Invalidate ();
+}
+
+double
+UanNoiseModelDefault::GetShipping (void) const
+{
+  return m_shipping;
+}
+
+void
+UanNoiseModelDefault::SetUseTable (bool useTable)
+{
+  m_useTable = useTable;
+  Invalidate ();
+}
+
+bool
+UanNoiseModelDefault::GetUseTable (void) const
+{
+  return m_useTable;
+}
+
+void
+UanNoiseModelDefault::SetTableStep (double step)
+{
+  m_tableStep = step;
+  Invalidate ();
+}
+
+double
+UanNoiseModelDefault::GetTableStep (void) const
+{
+  return m_tableStep;
+}
+
+void
+UanNoiseModelDefault::Invalidate (void)
+{
+  m_table.clear ();
+  m_bandCache.clear ();
+}
+
+void
+UanNoiseModelDefault::BuildTable (void) const
+{
+  uint32_t n = (uint32_t) std::ceil ((MAX_LOG_F - MIN_LOG_F) / m_tableStep) + 1;
+  NS_LOG_DEBUG ("Building " << n << " entry noise table, wind " << m_wind
+                            << " shipping " << m_shipping);
+  m_table.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_table[i] = CalcNoiseDbHz (std::pow (10.0, MIN_LOG_F + i * m_tableStep));
+    }
+}
+
+double
+UanNoiseModelDefault::GetNoiseDb (double fKhz, UanTxMode mode)
+{
+  uint32_t uid = mode.GetUid ();
+  if (uid >= m_bandCache.size ())
+    {
+      BandEntry empty;
+      empty.m_valid = false;
+      empty.m_fKhz = 0;
+      empty.m_bwHz = 0;
+      empty.m_noiseDb = 0;
+      m_bandCache.resize (uid + 1, empty);
+    }
+
+  // Frequency is passed separately from the mode and a mode may be
+  // redefined, so both are checked against the cached entry
+  uint32_t bwHz = mode.GetBandwidthHz ();
+  BandEntry &entry = m_bandCache[uid];
+  if (!entry.m_valid || entry.m_fKhz != fKhz || entry.m_bwHz != bwHz)
+    {
+      entry.m_valid = true;
+      entry.m_fKhz = fKhz;
+      entry.m_bwHz = bwHz;
+      entry.m_noiseDb = GetNoiseDbHz (fKhz) + 10 * log10 (bwHz);
+    }
+  return entry.m_noiseDb;
+}
+
+double
+UanNoiseModelDefault::GetNoiseDbHz (double fKhz) const
+{
+  if (!m_useTable)
+    {
+      return CalcNoiseDbHz (fKhz);
+    }
+
+  double logF = log10 (fKhz);
+  if (!(logF >= MIN_LOG_F && logF <= MAX_LOG_F))
+    {
+      return CalcNoiseDbHz (fKhz);
+    }
+  if (m_table.empty ())
+    {
+      BuildTable ();
+    }
+
+  double pos = (logF - MIN_LOG_F) / m_tableStep;
+  uint32_t i = std::min ((uint32_t) pos, (uint32_t) m_table.size () - 2);
+  double frac = pos - i;
+  return m_table[i] + frac * (m_table[i + 1] - m_table[i]);
+}
+
 // Common acoustic noise formulas.  These can be found
 // in "Priniciples of Underwater Sound" by Robert J. Urick
 double
-UanNoiseModelDefault::GetNoiseDbHz (double fKhz) const
+UanNoiseModelDefault::CalcNoiseDbHz (double fKhz) const
 {
   double turb, win, ship, thermal, noise;
   turb = 17.0 - 30.0 * log10 (fKhz);
@@ -67,7 +216,7 @@ UanNoiseModelDefault::GetNoiseDbHz (double fKhz) const
   ship = pow (10.0, (ship * 0.1));
 
   win = 50.0 + 7.5 * pow (m_wind, 0.5) + 20.0 * log10 (fKhz) - 40.0 * log10 (fKhz + 0.4);
-  win = pow (10.0, m_wind * 0.1);
+  win = pow (10.0, win * 0.1);
 
   thermal = -15 + 20 * log10 (fKhz);
   thermal = pow (10, thermal * 0.1);
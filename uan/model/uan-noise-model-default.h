@@ -25,6 +25,8 @@
 #include "ns3/attribute.h"
 #include "ns3/object.h"
 
+#include <vector>
+
 namespace ns3 {
 
 /**
@@ -41,6 +43,12 @@ namespace ns3 {
  *
  * Which uses the noise model also given in the book
  * "Principles of Underwater Sound" by Urick
+ *
+ * If UseTable is set, the spectrum is tabulated in dB against log10 of
+ * frequency between 10 Hz and 1 MHz and linearly interpolated.  The table
+ * is built on first use and rebuilt if Wind or Shipping change.
+ * Band-integrated noise returned by GetNoiseDb is cached per mode uid
+ * and discarded whenever any attribute changes.
  */
 class UanNoiseModelDefault : public UanNoiseModel
 {
@@ -54,10 +62,48 @@ public:
    * \param fKhz Frequency in kHz
    */
   virtual double GetNoiseDbHz (double fKhz) const;
+  /**
+   * \param fKhz Frequency in kHz at which noise is evaluated
+   * \param mode Mode whose bandwidth noise is integrated over
+   * \returns Noise power in dB re 1uPa within the bandwidth of mode
+   */
+  virtual double GetNoiseDb (double fKhz, UanTxMode mode);
+
+  /**
+   * \param fKhz Frequency in kHz
+   * \returns Noise power in dB re 1uPa/Hz computed directly from the Urick formulas
+   */
+  double CalcNoiseDbHz (double fKhz) const;
 
 private:
+  void SetWind (double wind);
+  double GetWind (void) const;
+  void SetShipping (double shipping);
+  double GetShipping (void) const;
+  void SetUseTable (bool useTable);
+  bool GetUseTable (void) const;
+  void SetTableStep (double step);
+  double GetTableStep (void) const;
+  void Invalidate (void);
+  void BuildTable (void) const;
+
+  struct BandEntry
+  {
+    bool m_valid;
+    double m_fKhz;
+    uint32_t m_bwHz;
+    double m_noiseDb;
+  };
+
   double m_wind;
   double m_shipping;
+  bool m_useTable;
+  double m_tableStep;
+
+  /// Noise in dB/Hz at 10^(MIN_LOG_F + i * m_tableStep) kHz
+  mutable std::vector<double> m_table;
+  /// Band-integrated noise indexed by mode uid
+  std::vector<BandEntry> m_bandCache;
 
 };
 
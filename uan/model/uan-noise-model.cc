@@ -20,8 +20,16 @@
 
 #include "uan-noise-model.h"
 
+#include <cmath>
+
 namespace ns3 {
 
+double
+UanNoiseModel::GetNoiseDb (double fKhz, UanTxMode mode)
+{
+  return GetNoiseDbHz (fKhz) + 10 * log10 (mode.GetBandwidthHz ());
+}
+
 void 
 UanNoiseModel::Clear (void)
 {
@@ -22,6 +22,7 @@
 #define UANNOISEMODEL_H
 
 #include "ns3/object.h"
+#include "ns3/uan-tx-mode.h"
 
 namespace ns3 {
 
@@ -34,6 +35,16 @@ public:
    */
   virtual double GetNoiseDbHz (double fKhz) const = 0;
 
+  /**
+   * Default implementation integrates GetNoiseDbHz over the mode bandwidth
+   * as a flat spectrum.
+   *
+   * \param fKhz Frequency in kHz at which noise is evaluated
+   * \param mode Mode whose bandwidth noise is integrated over
+   * \returns Noise power in dB re 1uPa within the bandwidth of mode
+   */
+  virtual double GetNoiseDb (double fKhz, UanTxMode mode);
+
   /**
    * Clears all pointer references
    */
@@ -30,8 +30,6 @@
 #include "ns3/traced-callback.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/simulator.h"
-#include "uan-header-common.h"
-#include "uan-mac-rc.h"
 
 #include <cmath>
 
@@ -82,26 +80,8 @@ UanPhyCalcSinrDual::CalcSinrDb (Ptr<Packet> pkt,
   for (; it != arrivalList.end (); it++)
     {
       // Only count interference if there is overlap in incoming frequency
-      if (std::abs ( (double) it->GetTxMode ().GetCenterFreqHz () - (double) mode.GetCenterFreqHz ())
-          < (double)(it->GetTxMode ().GetBandwidthHz () / 2 + mode.GetBandwidthHz () / 2) - 0.5)
+      if (UanTransducer::BandsOverlap (it->GetTxMode (), mode))
         {
-          UanHeaderCommon ch, ch2;
-          if (pkt)
-            {
-              pkt->PeekHeader (ch);
-            }
-          it->GetPacket ()->PeekHeader (ch2);
-
-          if (pkt)
-            {
-              if (ch.GetType () == UanMacRc::TYPE_DATA)
-                {
-                  NS_LOG_DEBUG ("Adding interferer from " << ch2.GetSrc () << " against " << ch.GetSrc () << ": PktRxMode: "
-                                                          << mode.GetName () << " Int mode: " << it->GetTxMode ().GetName () << " Separation: "
-                                                          << std::abs ( (double) it->GetTxMode ().GetCenterFreqHz () - (double) mode.GetCenterFreqHz ())
-                                                          << " Combined bandwidths: " << (double)(it->GetTxMode ().GetBandwidthHz () / 2 + mode.GetBandwidthHz () / 2) - 0.5);
-                }
-            }
           intKp += DbToKp (it->GetRxPowerDb ());
         }
     }
@@ -112,6 +92,28 @@ UanPhyCalcSinrDual::CalcSinrDb (Ptr<Packet> pkt,
   return rxPowerDb - totalIntDb;
 }
 
+double
+UanPhyCalcSinrDual::CalcSinrDbFromTransducer (Ptr<Packet> pkt,
+                                              Time arrTime,
+                                              double rxPowerDb,
+                                              double ambNoiseDb,
+                                              UanTxMode mode,
+                                              UanPdp pdp,
+                                              Ptr<UanTransducer> transducer) const
+{
+  if (mode.GetModType () != UanTxMode::OTHER)
+    {
+      NS_LOG_WARN ("Calculating SINR for unsupported modulation type");
+    }
+
+  // This packet is among the arrivals summed by the transducer
+  double intKp = transducer->GetBandPowerKp (mode) - DbToKp (rxPowerDb);
+  double totalIntDb = KpToDb (intKp + DbToKp (ambNoiseDb));
+
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Calculating SINR:  RxPower = " << rxPowerDb << " dB.  Interference + noise power = " << totalIntDb << " dB.  SINR = " << rxPowerDb - totalIntDb << " dB.");
+  return rxPowerDb - totalIntDb;
+}
+
 UanPhyDual::UanPhyDual ()
   :  UanPhy ()
 {
@@ -38,6 +38,8 @@ class UanModesList;
  * Considers interfering packet power as additional ambient noise only
  * if there is overlap in frequency band as found from supplied UanTxMode.
  * If there is no overlap, then the packets are considered not to interfere.
+ * Called from UanPhyGen it uses the per band power sums of the transducer,
+ * so the two PHYs of a UanPhyDual do not each go over the arrivals.
  */
 class UanPhyCalcSinrDual : public UanPhyCalcSinr
 {
@@ -53,6 +55,14 @@ public:
                              UanPdp pdp,
                              const UanTransducer::ArrivalList &arrivalList
                              ) const;
+  virtual double CalcSinrDbFromTransducer (Ptr<Packet> pkt,
+                                           Time arrTime,
+                                           double rxPowerDb,
+                                           double ambNoiseDb,
+                                           UanTxMode mode,
+                                           UanPdp pdp,
+                                           Ptr<UanTransducer> transducer
+                                           ) const;
 };
 
 /**
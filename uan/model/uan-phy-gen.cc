@@ -22,6 +22,8 @@
 #include "uan-transducer.h"
 #include "uan-channel.h"
 #include "uan-net-device.h"
+#include "uan-counters.h"
+#include "uan-doppler-tag.h"
 #include "ns3/simulator.h"
 #include "ns3/traced-callback.h"
 #include "ns3/ptr.h"
@@ -32,6 +34,10 @@
 #include "ns3/node.h"
 #include "ns3/uinteger.h"
 #include "ns3/random-variable.h"
+#include "ns3/boolean.h"
+
+#include <cmath>
+#include <algorithm>
 
 
 NS_LOG_COMPONENT_DEFINE ("UanPhyGen");
@@ -136,61 +142,41 @@ UanPhyCalcSinrFhFsk::CalcSinrDb (Ptr<Packet> pkt,
   double clearingTime = (m_hops - 1.0) * ts;
   double csp = pdp.SumTapsFromMaxNc (Seconds (0), Seconds (ts));
 
-  UanPdp::Iterator tmpIt = pdp.GetBegin ();
-
-  // Get maximum arrival offset
-  double maxAmp = -1;
+  // Get maximum arrival offset (a PDP without taps has no delay spread)
   double maxTapDelay = 0.0;
-  UanPdp::Iterator pit = pdp.GetBegin ();
-  for (; pit != pdp.GetEnd (); pit++)
+  if (pdp.GetNTaps () > 0)
     {
-      if (abs (pit->GetAmp ()) > maxAmp)
-        {
-          maxAmp = abs (pit->GetAmp ());
-          maxTapDelay = pit->GetDelay ().GetSeconds ();
-        }
+      maxTapDelay = pdp.GetTap (pdp.GetMaxTapIndex ()).GetDelay ().GetSeconds ();
     }
 
 
   double effRxPowerDb = rxPowerDb + KpToDb (csp);
 
-  double isiUpa = rxPowerDb * pdp.SumTapsFromMaxNc (Seconds (ts + clearingTime), Seconds (ts));
+  double period = ts + clearingTime;
+  double isiUpa = rxPowerDb * pdp.SumTapsFromMaxNc (Seconds (period), Seconds (ts));
+  double rxTime = arrTime.GetSeconds () + maxTapDelay;
   UanTransducer::ArrivalList::const_iterator it = arrivalList.begin ();
   double intKp = -DbToKp (effRxPowerDb);
   for (; it != arrivalList.end (); it++)
     {
-      UanPdp intPdp = it->GetPdp ();
-      double tDelta = std::abs (arrTime.GetSeconds () + maxTapDelay - it->GetArrivalTime ().GetSeconds ());
+      double intArrTime = it->GetArrivalTime ().GetSeconds ();
       // We want tDelta in terms of a single symbol (i.e. if tDelta = 7.3 symbol+clearing
       // times, the offset in terms of the arriving symbol power is
       // 0.3 symbol+clearing times.
-
-      int32_t syms = (uint32_t)( (double) tDelta / (ts + clearingTime));
-      tDelta = tDelta - syms * (ts + clearingTime);
+      double tDelta = std::fmod (std::abs (rxTime - intArrTime), period);
 
       // Align to pktRx
-      if (arrTime + Seconds (maxTapDelay)  > it->GetArrivalTime ())
-        {
-          tDelta = ts + clearingTime - tDelta;
-        }
-
-      double intPower = 0.0;
-      if (tDelta < ts)
+      if (rxTime > intArrTime)
         {
-          intPower += intPdp.SumTapsNc (Seconds (0), Seconds (ts - tDelta));
-          intPower += intPdp.SumTapsNc (Seconds (ts - tDelta + clearingTime),
-                                        Seconds (2 * ts - tDelta + clearingTime));
+          tDelta = period - tDelta;
         }
-      else
-        {
-          Time start = Seconds (ts + clearingTime - tDelta);
-          Time end = start + Seconds (ts);
-          intPower += intPdp.SumTapsNc (start, end);
 
-          start = start + Seconds (ts + clearingTime);
-          end = start + Seconds (ts);
-          intPower += intPdp.SumTapsNc (start, end);
-        }
+      // Interfering taps fall in the symbol starting at offset and in the
+      // one a symbol+clearing time later
+      double offset = tDelta < ts ? -tDelta : period - tDelta;
+      const UanPdp &intPdp = it->GetPdp ();
+      double intPower = intPdp.SumTapsNc (Seconds (std::max (offset, 0.0)), Seconds (offset + ts))
+        + intPdp.SumTapsNc (Seconds (offset + period), Seconds (offset + period + ts));
       intKp += DbToKp (it->GetRxPowerDb ()) * intPower;
     }
 
@@ -241,6 +227,9 @@ UanPhyPerGenDefault::CalcPer (Ptr<Packet> pkt, double sinrDb, UanTxMode mode)
 
 /*************** UanPhyPerUmodem definition *****************/
 UanPhyPerUmodem::UanPhyPerUmodem ()
+  : m_useTable (false),
+    m_tableStepDb (0.01),
+    m_builtStepDb (0)
 {
 
 }
@@ -254,6 +243,17 @@ TypeId UanPhyPerUmodem::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::UanPhyPerUmodem")
     .SetParent<Object> ()
     .AddConstructor<UanPhyPerUmodem> ()
+    .AddAttribute ("UseTable",
+                   "Interpolate bit error probability from a precomputed table instead of "
+                   "evaluating the code weight spectrum for every packet",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UanPhyPerUmodem::m_useTable),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TableStep",
+                   "SINR spacing, in dB, of the bit error probability table",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&UanPhyPerUmodem::m_tableStepDb),
+                   MakeDoubleChecker<double> (1e-6, 1.0))
   ;
   return tid;
 }
@@ -279,7 +279,7 @@ UanPhyPerUmodem::NChooseK (uint32_t n, uint32_t k)
 }
 
 double
-UanPhyPerUmodem::CalcPer (Ptr<Packet> pkt, double sinr, UanTxMode mode)
+UanPhyPerUmodem::CalcPb (double sinr)
 {
   uint32_t d[] =
   { 12, 14, 16, 18, 20, 22, 24, 26, 28 };
@@ -294,15 +294,6 @@ UanPhyPerUmodem::CalcPer (Ptr<Packet> pkt, double sinr, UanTxMode mode)
   double perror = 1.0 / (2.0 + ebno);
   double P[9];
 
-  if (sinr >= 10)
-    {
-      return 0;
-    }
-  if (sinr <= 6)
-    {
-      return 1;
-    }
-
   for (uint32_t r = 0; r < 9; r++)
     {
       double sumd = 0;
@@ -319,16 +310,60 @@ UanPhyPerUmodem::CalcPer (Ptr<Packet> pkt, double sinr, UanTxMode mode)
     {
       Pb = Pb + Bd[r] * P[r];
     }
+  return Pb;
+}
+
+void
+UanPhyPerUmodem::BuildTable (void)
+{
+  uint32_t nPoints = static_cast<uint32_t> (std::ceil ((10.0 - 6.0) / m_tableStepDb)) + 1;
+  m_logPbTable.resize (nPoints);
+  for (uint32_t i = 0; i < nPoints; i++)
+    {
+      m_logPbTable[i] = std::log (CalcPb (6.0 + i * m_tableStepDb));
+    }
+  m_builtStepDb = m_tableStepDb;
+  NS_LOG_DEBUG ("Built Umodem Pb table with " << nPoints << " points, step " << m_tableStepDb << " dB");
+}
+
+double
+UanPhyPerUmodem::LookupPb (double sinr)
+{
+  if (m_builtStepDb != m_tableStepDb)
+    {
+      BuildTable ();
+    }
+
+  double x = (sinr - 6.0) / m_tableStepDb;
+  uint32_t i = std::min (static_cast<uint32_t> (x),
+                         static_cast<uint32_t> (m_logPbTable.size () - 2));
+  double frac = x - i;
+  return std::exp (m_logPbTable[i] + frac * (m_logPbTable[i + 1] - m_logPbTable[i]));
+}
+
+double
+UanPhyPerUmodem::CalcPer (Ptr<Packet> pkt, double sinr, UanTxMode mode)
+{
+  if (sinr >= 10)
+    {
+      return 0;
+    }
+  if (sinr <= 6)
+    {
+      return 1;
+    }
+
+  double Pb = m_useTable ? LookupPb (sinr) : CalcPb (sinr);
 
   // cout << "Pb = " << Pb << endl;
   uint32_t bits = pkt->GetSize () * 8;
 
+  // Probability of zero bit errors plus probability of a single
+  // (correctable) bit error, sharing the (1 - Pb)^(bits - 1) term.
   double Ppacket = 1;
-  double temp = NChooseK (bits, 0);
-  temp *= std::pow ( (1 - Pb), (double) bits);
-  Ppacket -= temp;
-  temp = NChooseK (288, 1) * Pb * std::pow ( (1 - Pb), bits - 1.0);
-  Ppacket -= temp;
+  double temp = std::pow ( (1 - Pb), bits - 1.0);
+  Ppacket -= temp * (1 - Pb);
+  Ppacket -= NChooseK (288, 1) * Pb * temp;
 
   if (Ppacket > 1)
     {
@@ -572,8 +607,10 @@ UanPhyGen::StartRxPacket (Ptr<Packet> pkt, double rxPowerDb, UanTxMode txMode, U
             m_pktRxArrTime = Simulator::Now ();
             m_pktRxMode = txMode;
             m_pktRxPdp = pdp;
-            double txdelay = pkt->GetSize () * 8.0 / txMode.GetDataRateBps ();
-            Simulator::Schedule (Seconds (txdelay), &UanPhyGen::RxEndEvent, this, pkt, rxPowerDb, txMode);
+            UanDopplerTag doppler;
+            double factor = pkt->PeekPacketTag (doppler) ? doppler.GetDopplerFactor () : 1.0;
+            double rxdelay = pkt->GetSize () * 8.0 / (txMode.GetDataRateBps () * factor);
+            Simulator::Schedule (Seconds (rxdelay), &UanPhyGen::RxEndEvent, this, pkt, rxPowerDb, txMode);
             NotifyListenersRxStart ();
           }
 
@@ -609,6 +646,7 @@ UanPhyGen::RxEndEvent (Ptr<Packet> pkt, double rxPowerDb, UanTxMode txMode)
 
   UniformVariable pg;
 
+  UanCounters::Increment (UanCounters::PER_EVAL);
   if (pg.GetValue (0, 1) > m_per->CalcPer (m_pktRx, m_minRxSinrDb, txMode))
     {
       m_rxOkLogger (pkt, m_minRxSinrDb, txMode);
@@ -781,28 +819,38 @@ UanPhyGen::NotifyIntChange (void)
 double
 UanPhyGen::CalculateSinrDb (Ptr<Packet> pkt, Time arrTime, double rxPowerDb, UanTxMode mode, UanPdp pdp)
 {
-  const UanTransducer::ArrivalList &arrivalList = m_transducer->GetArrivalList ();
-
-
-  UanTransducer::ArrivalList::const_iterator it;
-
-  UanTransducer::ArrivalList newArrivalList;
-  for (it = arrivalList.begin (); it != arrivalList.end (); it++) {
-    if (it->GetTxMode ().GetUid () == mode.GetUid ())
-      newArrivalList.push_back (*it);
-  }
-
   bool isCumac = m_mac->GetInstanceTypeId () == TypeId::LookupByName ("ns3::UanMacCumac");
 
   uint32_t freqHz = isCumac ? 10000 : mode.GetCenterFreqHz ();
 
-  double noiseDb = m_channel->GetNoiseDbHz ((double) freqHz / 1000.0) + 10 * log10 (mode.GetBandwidthHz ());
-  return m_sinr->CalcSinrDb (pkt, arrTime, rxPowerDb, noiseDb, mode, pdp, isCumac ? newArrivalList : arrivalList);
+  double noiseDb = m_channel->GetNoiseDb ((double) freqHz / 1000.0, mode);
+  UanCounters::Increment (UanCounters::SINR_EVAL);
+  if (isCumac)
+    {
+      const UanTransducer::ArrivalList &arrivalList = m_transducer->GetArrivalList ();
+      UanTransducer::ArrivalList newArrivalList;
+      UanTransducer::ArrivalList::const_iterator it;
+      for (it = arrivalList.begin (); it != arrivalList.end (); it++)
+        {
+          if (it->GetTxMode ().GetUid () == mode.GetUid ())
+            {
+              newArrivalList.push_back (*it);
+            }
+        }
+      return m_sinr->CalcSinrDb (pkt, arrTime, rxPowerDb, noiseDb, mode, pdp, newArrivalList);
+    }
+  return m_sinr->CalcSinrDbFromTransducer (pkt, arrTime, rxPowerDb, noiseDb, mode, pdp, m_transducer);
 }
 
 double
 UanPhyGen::GetInterferenceDb (Ptr<Packet> pkt)
 {
+  bool isCumac = m_mac->GetInstanceTypeId () == TypeId::LookupByName ("ns3::UanMacCumac");
+  if (!isCumac && !pkt)
+    {
+      // Total power of all arrivals, shared with the other PHYs on the transducer
+      return KpToDb (m_transducer->GetTotalPowerKp ());
+    }
 
   const UanTransducer::ArrivalList &arrivalList = m_transducer->GetArrivalList ();
 
@@ -820,8 +868,6 @@ UanPhyGen::GetInterferenceDb (Ptr<Packet> pkt)
       }
     }
 
-    bool isCumac = m_mac->GetInstanceTypeId () == TypeId::LookupByName ("ns3::UanMacCumac");
-
     if ((!isCumac || hasmode) && pkt != it->GetPacket ()) {
         interfPower += DbToKp (it->GetRxPowerDb ());
     }
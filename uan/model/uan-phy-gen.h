@@ -26,6 +26,7 @@
 #include "ns3/traced-callback.h"
 #include "ns3/nstime.h"
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -53,6 +54,11 @@ private:
  * \brief Packet error rate calculation assuming WHOI Micromodem like PHY
  * Calculates PER assuming rate 1/2 convolutional code with constraint length 9
  * with soft decision viterbi decoding and a CRC capable of correcting 1 bit error
+ *
+ * The bit error probability depends only on SINR, so when the UseTable
+ * attribute is set it is tabulated once (in the log domain) over the
+ * 6-10 dB region where the PER is neither 0 nor 1, and interpolated
+ * on every call.
  */
 class UanPhyPerUmodem : public UanPhyPer
 {
@@ -78,6 +84,22 @@ public:
   virtual double CalcPer (Ptr<Packet> pkt, double sinrDb, UanTxMode mode);
 private:
   double NChooseK (uint32_t n, uint32_t k);
+  /**
+   * \param sinrDb SINR at receiver
+   * \returns Decoded bit error probability computed from the code weight spectrum
+   */
+  double CalcPb (double sinrDb);
+  /**
+   * \param sinrDb SINR at receiver
+   * \returns Decoded bit error probability interpolated from m_logPbTable
+   */
+  double LookupPb (double sinrDb);
+  void BuildTable (void);
+
+  bool m_useTable;
+  double m_tableStepDb;
+  double m_builtStepDb;
+  std::vector<double> m_logPbTable;
 
 };
 /**
@@ -0,0 +1,567 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-phy-multi.h"
+#include "uan-phy-gen.h"
+#include "uan-phy-dual.h"
+#include "uan-tx-mode.h"
+#include "uan-channel.h"
+#include "uan-net-device.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("UanPhyMulti");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanPhyMulti);
+
+UanPhyMulti::UanPhyMulti ()
+  : UanPhy (),
+    m_modesPerChain (1),
+    m_txPwrDb (190),
+    m_rxGainDb (0),
+    m_rxThreshDb (10),
+    m_ccaThreshDb (10)
+{
+}
+
+UanPhyMulti::~UanPhyMulti ()
+{
+}
+
+void
+UanPhyMulti::Clear ()
+{
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->Clear ();
+    }
+  m_chains.clear ();
+  m_listeners.clear ();
+  m_channel = 0;
+  m_device = 0;
+  m_mac = 0;
+  m_transducer = 0;
+  m_per = 0;
+  m_sinr = 0;
+}
+
+void
+UanPhyMulti::DoDispose ()
+{
+  Clear ();
+  UanPhy::DoDispose ();
+}
+
+TypeId
+UanPhyMulti::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UanPhyMulti")
+    .SetParent<UanPhy> ()
+    .AddConstructor<UanPhyMulti> ()
+    .AddAttribute ("SupportedModes",
+                   "List of modes supported by this PHY, spread over the chains in order",
+                   UanModesListValue (UanPhyGen::GetDefaultModes ()),
+                   MakeUanModesListAccessor (&UanPhyMulti::GetModes, &UanPhyMulti::SetModes),
+                   MakeUanModesListChecker ())
+    .AddAttribute ("ModesPerChain",
+                   "Number of consecutive modes handled by each receive chain (the last chain takes any remainder)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&UanPhyMulti::GetModesPerChain, &UanPhyMulti::SetModesPerChain),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("CcaThreshold",
+                   "Aggregate energy of incoming signals to move a chain to CCA Busy state dB",
+                   DoubleValue (10),
+                   MakeDoubleAccessor (&UanPhyMulti::GetCcaThresholdDb, &UanPhyMulti::SetCcaThresholdDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("TxPower",
+                   "Transmission output power in dB of every chain",
+                   DoubleValue (190),
+                   MakeDoubleAccessor (&UanPhyMulti::GetTxPowerDb, &UanPhyMulti::SetTxPowerDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("RxGain",
+                   "Gain added to incoming signal at receiver of every chain",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&UanPhyMulti::GetRxGainDb, &UanPhyMulti::SetRxGainDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("PerModel",
+                   "Functor to calculate PER based on SINR and TxMode, used by every chain",
+                   PointerValue (CreateObject<UanPhyPerGenDefault> ()),
+                   MakePointerAccessor (&UanPhyMulti::GetPerModel, &UanPhyMulti::SetPerModel),
+                   MakePointerChecker<UanPhyPer> ())
+    .AddAttribute ("SinrModel",
+                   "Functor to calculate SINR based on pkt arrivals and modes, used by every chain",
+                   PointerValue (CreateObject<UanPhyCalcSinrDual> ()),
+                   MakePointerAccessor (&UanPhyMulti::GetSinrModel, &UanPhyMulti::SetSinrModel),
+                   MakePointerChecker<UanPhyCalcSinr> ())
+    .AddTraceSource ("RxOk",
+                     "A packet was received successfully on one of the chains",
+                     MakeTraceSourceAccessor (&UanPhyMulti::m_rxOkLogger))
+    .AddTraceSource ("RxError",
+                     "A packet was received unsuccessfully on one of the chains",
+                     MakeTraceSourceAccessor (&UanPhyMulti::m_rxErrLogger))
+    .AddTraceSource ("Tx",
+                     "Packet transmission beginning on one of the chains",
+                     MakeTraceSourceAccessor (&UanPhyMulti::m_txLogger))
+  ;
+  return tid;
+}
+
+void
+UanPhyMulti::BuildChains (void)
+{
+  if (m_transducer)
+    {
+      NS_FATAL_ERROR ("UanPhyMulti: modes can not be changed after the PHY is attached to a transducer");
+    }
+
+  m_chains.clear ();
+  m_modeChain.clear ();
+  m_modeIndex.clear ();
+
+  uint32_t nModes = m_modes.GetNModes ();
+  uint32_t nChains = std::max (nModes / m_modesPerChain, (uint32_t) 1);
+  for (uint32_t c = 0; c < nChains; c++)
+    {
+      uint32_t first = c * m_modesPerChain;
+      uint32_t last = (c == nChains - 1) ? nModes : first + m_modesPerChain;
+      UanModesList chainModes;
+      for (uint32_t m = first; m < last; m++)
+        {
+          chainModes.AppendMode (m_modes[m]);
+          m_modeChain.push_back (c);
+          m_modeIndex.push_back (m - first);
+        }
+
+      Ptr<UanPhyGen> phy = CreateObject<UanPhyGen> ();
+      phy->SetAttribute ("SupportedModes", UanModesListValue (chainModes));
+      if (m_per)
+        {
+          phy->SetAttribute ("PerModel", PointerValue (m_per));
+        }
+      if (m_sinr)
+        {
+          phy->SetAttribute ("SinrModel", PointerValue (m_sinr));
+        }
+      phy->SetTxPowerDb (m_txPwrDb);
+      phy->SetRxGainDb (m_rxGainDb);
+      phy->SetCcaThresholdDb (m_ccaThreshDb);
+      if (m_channel)
+        {
+          phy->SetChannel (m_channel);
+        }
+      if (m_device)
+        {
+          phy->SetDevice (m_device);
+        }
+      if (m_mac)
+        {
+          phy->SetMac (m_mac);
+        }
+      phy->SetReceiveOkCallback (m_recOkCb);
+      phy->SetReceiveErrorCallback (m_recErrCb);
+      for (uint32_t i = 0; i < m_listeners.size (); i++)
+        {
+          phy->RegisterListener (m_listeners[i]);
+        }
+      phy->TraceConnectWithoutContext ("RxOk", MakeCallback (&UanPhyMulti::RxOkFromChain, this));
+      phy->TraceConnectWithoutContext ("RxError", MakeCallback (&UanPhyMulti::RxErrFromChain, this));
+      phy->TraceConnectWithoutContext ("Tx", MakeCallback (&UanPhyMulti::TxFromChain, this));
+      m_chains.push_back (phy);
+    }
+  NS_LOG_DEBUG ("Built " << nChains << " chains for " << nModes << " modes");
+}
+
+void
+UanPhyMulti::SendPacket (Ptr<Packet> pkt, uint32_t modeNum)
+{
+  NS_ASSERT (modeNum < m_modeChain.size ());
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Sending packet on chain " << m_modeChain[modeNum]
+                                                << " with mode number " << m_modeIndex[modeNum]);
+  m_chains[m_modeChain[modeNum]]->SendPacket (pkt, m_modeIndex[modeNum]);
+}
+
+void
+UanPhyMulti::RegisterListener (UanPhyListener *listener)
+{
+  m_listeners.push_back (listener);
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->RegisterListener (listener);
+    }
+}
+
+void
+UanPhyMulti::StartRxPacket (Ptr<Packet> pkt, double rxPowerDb, UanTxMode txMode, UanPdp pdp)
+{
+  // Not called.  The chains are attached to the transducer directly.
+}
+
+void
+UanPhyMulti::SetReceiveOkCallback (RxOkCallback cb)
+{
+  m_recOkCb = cb;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetReceiveOkCallback (cb);
+    }
+}
+
+void
+UanPhyMulti::SetReceiveErrorCallback (RxErrCallback cb)
+{
+  m_recErrCb = cb;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetReceiveErrorCallback (cb);
+    }
+}
+
+void
+UanPhyMulti::SetRxGainDb (double gain)
+{
+  m_rxGainDb = gain;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetRxGainDb (gain);
+    }
+}
+
+void
+UanPhyMulti::SetTxPowerDb (double txpwr)
+{
+  m_txPwrDb = txpwr;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetTxPowerDb (txpwr);
+    }
+}
+
+void
+UanPhyMulti::SetRxThresholdDb (double thresh)
+{
+  NS_LOG_WARN ("SetRxThresholdDb is deprecated and has no effect.  Look at PER Functor attribute");
+  m_rxThreshDb = thresh;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetRxThresholdDb (thresh);
+    }
+}
+
+void
+UanPhyMulti::SetCcaThresholdDb (double thresh)
+{
+  m_ccaThreshDb = thresh;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetCcaThresholdDb (thresh);
+    }
+}
+
+double
+UanPhyMulti::GetRxGainDb (void)
+{
+  return m_rxGainDb;
+}
+
+double
+UanPhyMulti::GetTxPowerDb (void)
+{
+  return m_txPwrDb;
+}
+
+double
+UanPhyMulti::GetRxThresholdDb (void)
+{
+  return m_rxThreshDb;
+}
+
+double
+UanPhyMulti::GetCcaThresholdDb (void)
+{
+  return m_ccaThreshDb;
+}
+
+bool
+UanPhyMulti::IsStateIdle (void)
+{
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      if (!m_chains[i]->IsStateIdle ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+UanPhyMulti::IsStateBusy (void)
+{
+  return !IsStateIdle ();
+}
+
+bool
+UanPhyMulti::IsStateRx (void)
+{
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      if (m_chains[i]->IsStateRx ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+UanPhyMulti::IsStateTx (void)
+{
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      if (m_chains[i]->IsStateTx ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+UanPhyMulti::IsStateCcaBusy (void)
+{
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      if (m_chains[i]->IsStateCcaBusy ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+Ptr<UanChannel>
+UanPhyMulti::GetChannel (void) const
+{
+  return m_channel;
+}
+
+Ptr<UanNetDevice>
+UanPhyMulti::GetDevice (void)
+{
+  return m_device;
+}
+
+void
+UanPhyMulti::SetChannel (Ptr<UanChannel> channel)
+{
+  m_channel = channel;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetChannel (channel);
+    }
+}
+
+void
+UanPhyMulti::SetDevice (Ptr<UanNetDevice> device)
+{
+  m_device = device;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetDevice (device);
+    }
+}
+
+void
+UanPhyMulti::SetMac (Ptr<UanMac> mac)
+{
+  m_mac = mac;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetMac (mac);
+    }
+}
+
+void
+UanPhyMulti::NotifyTransStartTx (Ptr<Packet> packet, double txPowerDb, UanTxMode txMode)
+{
+  // The chains are notified by the transducer directly
+}
+
+void
+UanPhyMulti::NotifyIntChange (void)
+{
+  // The chains are notified by the transducer directly
+}
+
+void
+UanPhyMulti::SetTransducer (Ptr<UanTransducer> trans)
+{
+  m_transducer = trans;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetTransducer (trans);
+    }
+}
+
+Ptr<UanTransducer>
+UanPhyMulti::GetTransducer (void)
+{
+  return m_transducer;
+}
+
+uint32_t
+UanPhyMulti::GetNModes (void)
+{
+  return m_modes.GetNModes ();
+}
+
+UanTxMode
+UanPhyMulti::GetMode (uint32_t n)
+{
+  NS_ASSERT (n < m_modes.GetNModes ());
+  return m_modes[n];
+}
+
+Ptr<Packet>
+UanPhyMulti::GetPacketRx (void) const
+{
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      if (m_chains[i]->GetPacketRx ())
+        {
+          return m_chains[i]->GetPacketRx ();
+        }
+    }
+  return 0;
+}
+
+uint32_t
+UanPhyMulti::GetNChains (void) const
+{
+  return m_chains.size ();
+}
+
+Ptr<UanPhyGen>
+UanPhyMulti::GetChain (uint32_t chain) const
+{
+  NS_ASSERT (chain < m_chains.size ());
+  return m_chains[chain];
+}
+
+uint32_t
+UanPhyMulti::GetChainOfMode (uint32_t modeNum) const
+{
+  NS_ASSERT (modeNum < m_modeChain.size ());
+  return m_modeChain[modeNum];
+}
+
+Ptr<Packet>
+UanPhyMulti::GetChainPacketRx (uint32_t chain) const
+{
+  NS_ASSERT (chain < m_chains.size ());
+  return m_chains[chain]->GetPacketRx ();
+}
+
+UanModesList
+UanPhyMulti::GetModes (void) const
+{
+  return m_modes;
+}
+
+void
+UanPhyMulti::SetModes (UanModesList modes)
+{
+  m_modes = modes;
+  BuildChains ();
+}
+
+uint32_t
+UanPhyMulti::GetModesPerChain (void) const
+{
+  return m_modesPerChain;
+}
+
+void
+UanPhyMulti::SetModesPerChain (uint32_t modesPerChain)
+{
+  NS_ASSERT (modesPerChain > 0);
+  m_modesPerChain = modesPerChain;
+  BuildChains ();
+}
+
+Ptr<UanPhyPer>
+UanPhyMulti::GetPerModel (void) const
+{
+  return m_per;
+}
+
+void
+UanPhyMulti::SetPerModel (Ptr<UanPhyPer> per)
+{
+  m_per = per;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetAttribute ("PerModel", PointerValue (per));
+    }
+}
+
+Ptr<UanPhyCalcSinr>
+UanPhyMulti::GetSinrModel (void) const
+{
+  return m_sinr;
+}
+
+void
+UanPhyMulti::SetSinrModel (Ptr<UanPhyCalcSinr> sinr)
+{
+  m_sinr = sinr;
+  for (uint32_t i = 0; i < m_chains.size (); i++)
+    {
+      m_chains[i]->SetAttribute ("SinrModel", PointerValue (sinr));
+    }
+}
+
+void
+UanPhyMulti::RxOkFromChain (Ptr<const Packet> pkt, double sinr, UanTxMode mode)
+{
+  m_rxOkLogger (pkt, sinr, mode);
+}
+
+void
+UanPhyMulti::RxErrFromChain (Ptr<const Packet> pkt, double sinr, UanTxMode mode)
+{
+  m_rxErrLogger (pkt, sinr, mode);
+}
+
+void
+UanPhyMulti::TxFromChain (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode)
+{
+  m_txLogger (pkt, txPowerDb, mode);
+}
+
+} // namespace ns3
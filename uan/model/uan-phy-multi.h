@@ -0,0 +1,193 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANPHYMULTI_H
+#define UANPHYMULTI_H
+
+#include "ns3/uan-phy.h"
+#include "ns3/traced-callback.h"
+
+#include <vector>
+
+namespace ns3 {
+
+class UanPhyGen;
+
+/**
+ * \class UanPhyMulti
+ * \brief PHY with several receive chains sharing one transducer
+ *
+ * Wraps a number of generic PHYs (UanPhyGen), the chains, which are all
+ * attached to the same transducer.  Each chain receives (and transmits)
+ * independently on its own modes, so a MAC can listen on a control
+ * channel and on a data channel at the same time.
+ *
+ * The modes of the PHY are given in SupportedModes.  Mode n is handled
+ * by chain n / ModesPerChain, the last chain taking any remainder.  The
+ * mode to chain routing is computed when the modes are set, not on every
+ * packet.  TxPower, RxGain, CcaThreshold, PerModel and SinrModel apply to
+ * every chain; single chains can be configured through GetChain.
+ *
+ * The Rx and Tx trace sources of all chains are forwarded to those of
+ * this PHY.  As with UanPhyDual, listeners receive the state changes of
+ * every chain.
+ */
+class UanPhyMulti : public UanPhy
+{
+public:
+  UanPhyMulti ();
+  virtual ~UanPhyMulti ();
+
+  static TypeId GetTypeId (void);
+
+  virtual void SendPacket (Ptr<Packet> pkt, uint32_t modeNum);
+  virtual void RegisterListener (UanPhyListener *listener);
+  virtual void StartRxPacket (Ptr<Packet> pkt, double rxPowerDb, UanTxMode txMode, UanPdp pdp);
+  virtual void SetReceiveOkCallback (RxOkCallback cb);
+  virtual void SetReceiveErrorCallback (RxErrCallback cb);
+  virtual void SetRxGainDb (double gain);
+  virtual void SetTxPowerDb (double txpwr);
+  virtual void SetRxThresholdDb (double thresh);
+  virtual void SetCcaThresholdDb (double thresh);
+  virtual double GetRxGainDb (void);
+  virtual double GetTxPowerDb (void);
+  virtual double GetRxThresholdDb (void);
+  virtual double GetCcaThresholdDb (void);
+  virtual bool IsStateIdle (void);
+  virtual bool IsStateBusy (void);
+  virtual bool IsStateRx (void);
+  virtual bool IsStateTx (void);
+  virtual bool IsStateCcaBusy (void);
+  virtual Ptr<UanChannel> GetChannel (void) const;
+  virtual Ptr<UanNetDevice> GetDevice (void);
+  virtual void SetChannel (Ptr<UanChannel> channel);
+  virtual void SetDevice (Ptr<UanNetDevice> device);
+  virtual void SetMac (Ptr<UanMac> mac);
+  virtual void NotifyTransStartTx (Ptr<Packet> packet, double txPowerDb, UanTxMode txMode);
+  virtual void NotifyIntChange (void);
+  virtual void SetTransducer (Ptr<UanTransducer> trans);
+  virtual Ptr<UanTransducer> GetTransducer (void);
+  virtual uint32_t GetNModes (void);
+  virtual UanTxMode GetMode (uint32_t n);
+  /**
+   * \returns Packet being received on the first chain which is receiving
+   * (Null Ptr if none)
+   */
+  virtual Ptr<Packet> GetPacketRx (void) const;
+  virtual void Clear (void);
+
+  /**
+   * \returns Number of receive chains
+   */
+  uint32_t GetNChains (void) const;
+  /**
+   * \param chain Chain number
+   * \returns PHY of chain
+   */
+  Ptr<UanPhyGen> GetChain (uint32_t chain) const;
+  /**
+   * \param modeNum Mode number
+   * \returns Number of the chain handling mode modeNum
+   */
+  uint32_t GetChainOfMode (uint32_t modeNum) const;
+  /**
+   * \param chain Chain number
+   * \returns Packet currently being received on chain (Null Ptr if none)
+   */
+  Ptr<Packet> GetChainPacketRx (uint32_t chain) const;
+
+  // Attribute getters and setters
+  /**
+   * \returns List of all modes, index corresponds to mode number
+   */
+  UanModesList GetModes (void) const;
+  /**
+   * \param modes List of all modes, index corresponds to mode number
+   */
+  void SetModes (UanModesList modes);
+  /**
+   * \returns Number of modes per chain
+   */
+  uint32_t GetModesPerChain (void) const;
+  /**
+   * \param modesPerChain Number of modes per chain
+   */
+  void SetModesPerChain (uint32_t modesPerChain);
+  /**
+   * \returns PER model of the chains
+   */
+  Ptr<UanPhyPer> GetPerModel (void) const;
+  /**
+   * \param per PER model to use on every chain
+   */
+  void SetPerModel (Ptr<UanPhyPer> per);
+  /**
+   * \returns SINR model of the chains
+   */
+  Ptr<UanPhyCalcSinr> GetSinrModel (void) const;
+  /**
+   * \param sinr SINR model to use on every chain
+   */
+  void SetSinrModel (Ptr<UanPhyCalcSinr> sinr);
+
+protected:
+  virtual void DoDispose ();
+
+private:
+  /**
+   * Creates the chains for the current modes and builds the mode to
+   * chain routing table
+   */
+  void BuildChains (void);
+  void RxOkFromChain (Ptr<const Packet> pkt, double sinr, UanTxMode mode);
+  void RxErrFromChain (Ptr<const Packet> pkt, double sinr, UanTxMode mode);
+  void TxFromChain (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode);
+
+  UanModesList m_modes;
+  uint32_t m_modesPerChain;
+  std::vector<Ptr<UanPhyGen> > m_chains;
+  /// Chain of each mode number
+  std::vector<uint32_t> m_modeChain;
+  /// Mode number within its chain of each mode number
+  std::vector<uint32_t> m_modeIndex;
+
+  double m_txPwrDb;
+  double m_rxGainDb;
+  double m_rxThreshDb;
+  double m_ccaThreshDb;
+  Ptr<UanPhyPer> m_per;
+  Ptr<UanPhyCalcSinr> m_sinr;
+
+  Ptr<UanChannel> m_channel;
+  Ptr<UanNetDevice> m_device;
+  Ptr<UanMac> m_mac;
+  Ptr<UanTransducer> m_transducer;
+  RxOkCallback m_recOkCb;
+  RxErrCallback m_recErrCb;
+  std::vector<UanPhyListener *> m_listeners;
+
+  TracedCallback<Ptr<const Packet>, double, UanTxMode > m_rxOkLogger;
+  TracedCallback<Ptr<const Packet>, double, UanTxMode > m_rxErrLogger;
+  TracedCallback<Ptr<const Packet>, double, UanTxMode > m_txLogger;
+};
+
+}
+
+#endif // UANPHYMULTI_H
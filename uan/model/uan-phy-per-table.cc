@@ -0,0 +1,213 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-phy-per-table.h"
+#include "uan-tx-mode.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("UanPhyPerTable");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanPhyPerTable);
+
+/*************** UanPerCurve definition *****************/
+UanPerCurve::UanPerCurve ()
+  : m_sinrMinDb (0),
+    m_sinrStepDb (1),
+    m_nSinr (0),
+    m_lenMinBytes (0),
+    m_lenStepBytes (1),
+    m_nLen (0)
+{
+}
+
+double
+UanPerCurve::GetPer (double sinrDb, uint32_t bytes) const
+{
+  // Fractional grid positions, clamped so the outermost cell is used
+  // (with fraction 0 or 1) outside of the tabulated range.
+  double x = (sinrDb - m_sinrMinDb) / m_sinrStepDb;
+  double y = (bytes - m_lenMinBytes) / m_lenStepBytes;
+  x = std::min (std::max (x, 0.0), m_nSinr - 1.0);
+  y = std::min (std::max (y, 0.0), m_nLen - 1.0);
+
+  uint32_t i = std::min (static_cast<uint32_t> (x), m_nSinr > 1 ? m_nSinr - 2 : 0);
+  uint32_t j = std::min (static_cast<uint32_t> (y), m_nLen > 1 ? m_nLen - 2 : 0);
+  double fx = x - i;
+  double fy = y - j;
+  uint32_t i1 = std::min (i + 1, m_nSinr - 1);
+  uint32_t j1 = std::min (j + 1, m_nLen - 1);
+
+  const double *row0 = &m_per[j * m_nSinr];
+  const double *row1 = &m_per[j1 * m_nSinr];
+  double p0 = row0[i] + fx * (row0[i1] - row0[i]);
+  double p1 = row1[i] + fx * (row1[i1] - row1[i]);
+  return p0 + fy * (p1 - p0);
+}
+
+/*************** UanPerTableFile definition *****************/
+UanPerTableFile::UanPerTableFile ()
+{
+}
+
+const UanPerTableFile &
+UanPerTableFile::Get (std::string fileName)
+{
+  static std::map<std::string, UanPerTableFile> cache;
+
+  std::map<std::string, UanPerTableFile>::iterator it = cache.find (fileName);
+  if (it == cache.end ())
+    {
+      it = cache.insert (std::make_pair (fileName, UanPerTableFile ())).first;
+      it->second.Load (fileName);
+    }
+  return it->second;
+}
+
+void
+UanPerTableFile::Load (std::string fileName)
+{
+  std::ifstream file (fileName.c_str ());
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open UanPhyPerTable file " << fileName);
+    }
+
+  // Strip comments and commas so the remainder can be read as a token stream
+  std::stringstream ss;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      line = line.substr (0, line.find ('#'));
+      std::replace (line.begin (), line.end (), ',', ' ');
+      ss << line << '\n';
+    }
+
+  std::string keyword;
+  while (ss >> keyword)
+    {
+      if (keyword != "MODE")
+        {
+          NS_FATAL_ERROR ("UanPhyPerTable file " << fileName << " corrupted: expected MODE, got " << keyword);
+        }
+      std::string name;
+      UanPerCurve curve;
+      ss >> name >> curve.m_sinrMinDb >> curve.m_sinrStepDb >> curve.m_nSinr
+      >> curve.m_lenMinBytes >> curve.m_lenStepBytes >> curve.m_nLen;
+      if (!ss || curve.m_nSinr == 0 || curve.m_nLen == 0
+          || curve.m_sinrStepDb <= 0 || curve.m_lenStepBytes <= 0)
+        {
+          NS_FATAL_ERROR ("UanPhyPerTable file " << fileName << " corrupted at MODE " << name);
+        }
+
+      curve.m_per.resize (curve.m_nSinr * curve.m_nLen);
+      for (uint32_t i = 0; i < curve.m_per.size (); i++)
+        {
+          if (!(ss >> curve.m_per[i]))
+            {
+              NS_FATAL_ERROR ("UanPhyPerTable file " << fileName << " corrupted at MODE "
+                                                     << name << " value " << i);
+            }
+        }
+      NS_LOG_DEBUG ("Loaded " << curve.m_nLen << "x" << curve.m_nSinr << " PER curve for mode " << name);
+      m_curves[name] = curve;
+    }
+}
+
+const UanPerCurve *
+UanPerTableFile::GetCurve (const UanTxMode &mode) const
+{
+  uint32_t uid = mode.GetUid ();
+  if (uid >= m_byUid.size ())
+    {
+      m_byUid.resize (uid + 1, 0);
+      m_uidResolved.resize (uid + 1, false);
+    }
+  if (!m_uidResolved[uid])
+    {
+      std::map<std::string, UanPerCurve>::const_iterator it = m_curves.find (mode.GetName ());
+      m_byUid[uid] = (it == m_curves.end ()) ? 0 : &it->second;
+      m_uidResolved[uid] = true;
+    }
+  return m_byUid[uid];
+}
+
+/*************** UanPhyPerTable definition *****************/
+UanPhyPerTable::UanPhyPerTable ()
+  : m_table (0)
+{
+}
+
+UanPhyPerTable::~UanPhyPerTable ()
+{
+}
+
+TypeId
+UanPhyPerTable::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UanPhyPerTable")
+    .SetParent<Object> ()
+    .AddConstructor<UanPhyPerTable> ()
+    .AddAttribute ("FileName",
+                   "Name of file holding PER vs. SINR vs. packet length curves",
+                   StringValue (""),
+                   MakeStringAccessor (&UanPhyPerTable::SetFileName),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+void
+UanPhyPerTable::SetFileName (std::string fileName)
+{
+  m_fileName = fileName;
+  m_table = 0;
+}
+
+double
+UanPhyPerTable::CalcPer (Ptr<Packet> pkt, double sinrDb, UanTxMode mode)
+{
+  if (m_table == 0)
+    {
+      m_table = &UanPerTableFile::Get (m_fileName);
+    }
+
+  const UanPerCurve *curve = m_table->GetCurve (mode);
+  if (curve == 0)
+    {
+      NS_FATAL_ERROR ("No PER curve for mode \"" << mode.GetName () << "\" in " << m_fileName);
+    }
+  return curve->GetPer (sinrDb, pkt->GetSize ());
+}
+
+void
+UanPhyPerTable::Clear (void)
+{
+  m_table = 0;
+}
+
+} // namespace ns3
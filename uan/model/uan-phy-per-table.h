@@ -0,0 +1,130 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANPHYPERTABLE_H
+#define UANPHYPERTABLE_H
+
+#include "uan-phy.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \class UanPerCurve
+ * \brief Tabulated PER of one TX mode, on a uniform SINR x packet length grid
+ */
+class UanPerCurve
+{
+public:
+  UanPerCurve ();
+
+  /**
+   * \param sinrDb SINR at receiver
+   * \param bytes Packet length in bytes
+   * \returns PER bilinearly interpolated from the grid (clamped at the grid edges)
+   */
+  double GetPer (double sinrDb, uint32_t bytes) const;
+
+private:
+  friend class UanPerTableFile;
+
+  double m_sinrMinDb;
+  double m_sinrStepDb;
+  uint32_t m_nSinr;
+  double m_lenMinBytes;
+  double m_lenStepBytes;
+  uint32_t m_nLen;
+  /// PER values, m_nSinr entries per packet length row
+  std::vector<double> m_per;
+};
+
+/**
+ * \class UanPerTableFile
+ * \brief Parsed contents of a PER table file, shared by all UanPhyPerTable objects
+ *
+ * Files are parsed the first time they are requested and kept
+ * for the lifetime of the process, so every PHY in a simulation
+ * refers to the same copy of the curves.
+ *
+ * The file is text, with '#' starting a comment and commas treated
+ * as white space.  Each TX mode is described by a header line
+ *
+ *   MODE name sinrMinDb sinrStepDb nSinr lenMinBytes lenStepBytes nLen
+ *
+ * followed by nLen rows (one per packet length, increasing) of nSinr
+ * PER values (one per SINR, increasing).  Modes are matched to
+ * UanTxMode objects by name.
+ */
+class UanPerTableFile
+{
+public:
+  /**
+   * \param fileName Name of table file
+   * \returns Table parsed from fileName (parsed on first request only)
+   */
+  static const UanPerTableFile &Get (std::string fileName);
+
+  /**
+   * \param mode TX mode
+   * \returns Curve for mode, or 0 if the file has no curve for mode
+   */
+  const UanPerCurve *GetCurve (const UanTxMode &mode) const;
+
+private:
+  UanPerTableFile ();
+  void Load (std::string fileName);
+
+  std::map<std::string, UanPerCurve> m_curves;
+  /// Curves indexed by UanTxMode uid, filled in as modes are looked up
+  mutable std::vector<const UanPerCurve *> m_byUid;
+  mutable std::vector<bool> m_uidResolved;
+};
+
+/**
+ * \class UanPhyPerTable
+ * \brief PER calculated from measured PER vs. SINR vs. packet length curves
+ *
+ * Curves are read from the file given by the FileName attribute
+ * (see UanPerTableFile for the format), on first use.
+ */
+class UanPhyPerTable : public UanPhyPer
+{
+public:
+  UanPhyPerTable ();
+  virtual ~UanPhyPerTable ();
+
+  static TypeId GetTypeId (void);
+
+  virtual double CalcPer (Ptr<Packet> pkt, double sinrDb, UanTxMode mode);
+  virtual void Clear (void);
+
+private:
+  void SetFileName (std::string fileName);
+
+  std::string m_fileName;
+  const UanPerTableFile *m_table;
+};
+
+} // namespace ns3
+
+#endif // UANPHYPERTABLE_H
@@ -22,6 +22,18 @@
 
 namespace ns3 {
 
+double
+UanPhyCalcSinr::CalcSinrDbFromTransducer (Ptr<Packet> pkt,
+                                          Time arrTime,
+                                          double rxPowerDb,
+                                          double ambNoiseDb,
+                                          UanTxMode mode,
+                                          UanPdp pdp,
+                                          Ptr<UanTransducer> transducer) const
+{
+  return CalcSinrDb (pkt, arrTime, rxPowerDb, ambNoiseDb, mode, pdp, transducer->GetArrivalList ());
+}
+
 void
 UanPhyCalcSinr::Clear ()
 {
@@ -59,6 +59,28 @@ public:
                              UanPdp pdp,
                              const UanTransducer::ArrivalList &arrivalList
                              ) const = 0;
+  /**
+   * Same as CalcSinrDb, for the arrivals at transducer.  Models that only
+   * need summed interference power can use the sums transducer keeps,
+   * shared by all PHYs attached to it.  The default evaluates CalcSinrDb
+   * on the arrival list of transducer.
+   *
+   * \param pkt Packet to calculate SINR for
+   * \param arrTime Arrival time of pkt
+   * \param rxPowerDb The received signal strength of the packet in dB re 1 uPa
+   * \param ambNoiseDb Ambient channel noise in dB re 1 uPa
+   * \param mode TX Mode of pkt
+   * \param pdp  Power delay profile of pkt
+   * \param transducer Transducer pkt is arriving at
+   */
+  virtual double CalcSinrDbFromTransducer (Ptr<Packet> pkt,
+                                           Time arrTime,
+                                           double rxPowerDb,
+                                           double ambNoiseDb,
+                                           UanTxMode mode,
+                                           UanPdp pdp,
+                                           Ptr<UanTransducer> transducer
+                                           ) const;
   /**
    * Clears all pointer references
    */
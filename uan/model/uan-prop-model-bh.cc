@@ -0,0 +1,582 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-prop-model-bh.h"
+#include "uan-tx-mode.h"
+#include "ns3/string.h"
+#include "ns3/log.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("UanPropModelBh");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanPropModelBh);
+
+static const char GRID_MAGIC[8] = { 'U', 'A', 'N', 'G', 'R', 'I', 'D', '\0' };
+static const uint32_t GRID_VERSION = 1;
+static const uint32_t GRID_BYTE_ORDER = 0x01020304;
+static const uint64_t GRID_ALIGN = 64;
+
+struct UanPropGrid::Header
+{
+  char m_magic[8];
+  uint32_t m_version;
+  uint32_t m_byteOrder;
+  uint32_t m_nFreq;
+  uint32_t m_nSrc;
+  uint32_t m_nRcv;
+  uint32_t m_nRange;
+  uint64_t m_axesOffset;
+  uint64_t m_cellsOffset;
+  uint64_t m_tapsOffset;
+  uint64_t m_nTaps;
+  uint64_t m_fileSize;
+};
+
+struct UanPropGrid::Cell
+{
+  double m_lossDb;
+  double m_delayS;
+  double m_resolutionS;
+  uint64_t m_firstTap;
+  uint32_t m_nTaps;
+  uint32_t m_reserved;
+};
+
+static uint64_t
+AlignUp (uint64_t offset)
+{
+  return (offset + GRID_ALIGN - 1) / GRID_ALIGN * GRID_ALIGN;
+}
+
+/**
+ * Finds the grid points around x on axis.  i0 and i1 are the indices of
+ * the points below and above x, and frac the position of x between them.
+ * Outside of the axis both indices refer to the end point.
+ */
+static void
+LocateOnAxis (const double *axis, uint32_t n, double x, uint32_t &i0, uint32_t &i1, double &frac)
+{
+  const double *it = std::upper_bound (axis, axis + n, x);
+  if (it == axis)
+    {
+      i0 = i1 = 0;
+      frac = 0;
+    }
+  else if (it == axis + n)
+    {
+      i0 = i1 = n - 1;
+      frac = 0;
+    }
+  else
+    {
+      i1 = it - axis;
+      i0 = i1 - 1;
+      frac = (x - axis[i0]) / (axis[i1] - axis[i0]);
+    }
+}
+
+static uint32_t
+NearestOnAxis (const double *axis, uint32_t n, double x)
+{
+  uint32_t i0, i1;
+  double frac;
+  LocateOnAxis (axis, n, x, i0, i1, frac);
+  return frac < 0.5 ? i0 : i1;
+}
+
+/*************** UanPropGrid definition *****************/
+UanPropGrid::UanPropGrid ()
+  : m_base (0),
+    m_size (0),
+    m_mapping (0),
+    m_nFreq (0),
+    m_nSrc (0),
+    m_nRcv (0),
+    m_nRange (0),
+    m_freqs (0),
+    m_srcDepths (0),
+    m_rcvDepths (0),
+    m_ranges (0),
+    m_cells (0),
+    m_taps (0),
+    m_nTaps (0)
+{
+}
+
+UanPropGrid::~UanPropGrid ()
+{
+  if (m_mapping != 0)
+    {
+      munmap (m_mapping, m_size);
+    }
+}
+
+const UanPropGrid &
+UanPropGrid::Get (std::string fileName)
+{
+  // Grids own their mapping and are not copyable, so the cache
+  // holds pointers and deletes the grids when the process exits.
+  static struct Cache
+  {
+    ~Cache ()
+    {
+      for (std::map<std::string, UanPropGrid *>::iterator it = m_grids.begin (); it != m_grids.end (); it++)
+        {
+          delete it->second;
+        }
+    }
+    std::map<std::string, UanPropGrid *> m_grids;
+  } cache;
+
+  std::map<std::string, UanPropGrid *>::iterator it = cache.m_grids.find (fileName);
+  if (it == cache.m_grids.end ())
+    {
+      UanPropGrid *grid = new UanPropGrid ();
+      grid->Load (fileName);
+      it = cache.m_grids.insert (std::make_pair (fileName, grid)).first;
+    }
+  return *it->second;
+}
+
+void
+UanPropGrid::Load (std::string fileName)
+{
+  std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open UanPropModelBh file " << fileName);
+    }
+
+  char magic[sizeof (GRID_MAGIC)];
+  if (file.read (magic, sizeof (magic)) && std::equal (magic, magic + sizeof (magic), GRID_MAGIC))
+    {
+      file.close ();
+      LoadBinary (fileName);
+    }
+  else
+    {
+      file.clear ();
+      file.seekg (0);
+      LoadText (file, fileName);
+    }
+  Attach (fileName);
+  NS_LOG_DEBUG ("Loaded " << m_nFreq << "x" << m_nSrc << "x" << m_nRcv << "x" << m_nRange
+                          << " grid from " << fileName << (m_mapping ? " (mapped)" : ""));
+}
+
+void
+UanPropGrid::LoadBinary (std::string fileName)
+{
+  int fd = open (fileName.c_str (), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat (fd, &st) != 0)
+    {
+      NS_FATAL_ERROR ("Could not open UanPropModelBh file " << fileName);
+    }
+  if (st.st_size <= 0)
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " is empty");
+    }
+  if ((uint64_t) st.st_size > std::numeric_limits<size_t>::max ())
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " is too large to load ("
+                                             << st.st_size << " bytes)");
+    }
+  m_size = st.st_size;
+
+  void *mapping = mmap (0, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (mapping != MAP_FAILED)
+    {
+      m_mapping = mapping;
+      m_base = static_cast<const char *> (mapping);
+    }
+  else
+    {
+      NS_LOG_WARN ("Could not map " << fileName << ", reading it instead");
+      m_image.resize ((m_size + sizeof (uint64_t) - 1) / sizeof (uint64_t));
+      char *dst = reinterpret_cast<char *> (&m_image[0]);
+      uint64_t done = 0;
+      while (done < m_size)
+        {
+          ssize_t n = pread (fd, dst + done, m_size - done, done);
+          if (n <= 0)
+            {
+              NS_FATAL_ERROR ("Could not read UanPropModelBh file " << fileName);
+            }
+          done += n;
+        }
+      m_base = dst;
+    }
+  close (fd);
+}
+
+void
+UanPropGrid::ReadAxis (std::istream &is, std::string keyword, std::vector<double> &axis, std::string fileName)
+{
+  std::string word;
+  uint32_t n = 0;
+  is >> word >> n;
+  if (!is || word != keyword || n == 0)
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " corrupted: expected " << keyword);
+    }
+  axis.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (!(is >> axis[i]) || (i > 0 && axis[i] <= axis[i - 1]))
+        {
+          NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " corrupted at " << keyword
+                                                 << " point " << i);
+        }
+    }
+}
+
+void
+UanPropGrid::LoadText (std::istream &file, std::string fileName)
+{
+  // Strip comments so the remainder can be read as a token stream
+  std::stringstream ss;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      ss << line.substr (0, line.find ('#')) << '\n';
+    }
+
+  std::vector<double> axes[4];
+  ReadAxis (ss, "FREQUENCIES", axes[0], fileName);
+  ReadAxis (ss, "SOURCEDEPTHS", axes[1], fileName);
+  ReadAxis (ss, "RECEIVERDEPTHS", axes[2], fileName);
+  ReadAxis (ss, "RANGES", axes[3], fileName);
+
+  std::string keyword;
+  ss >> keyword;
+  if (keyword != "CELLS")
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " corrupted: expected CELLS, got " << keyword);
+    }
+
+  uint64_t nCells = (uint64_t) axes[0].size () * axes[1].size () * axes[2].size () * axes[3].size ();
+  if (nCells > std::numeric_limits<size_t>::max () / sizeof (Cell))
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " has too many cells (" << nCells << ")");
+    }
+  std::vector<Cell> cells (nCells);
+  std::vector<double> taps;
+  for (uint64_t i = 0; i < nCells; i++)
+    {
+      UanPdp pdp;
+      ss >> cells[i].m_lossDb >> cells[i].m_delayS >> pdp;
+      if (!ss)
+        {
+          NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " corrupted at cell " << i);
+        }
+      cells[i].m_resolutionS = pdp.GetResolution ().GetSeconds ();
+      cells[i].m_firstTap = taps.size () / 2;
+      cells[i].m_nTaps = pdp.GetNTaps ();
+      cells[i].m_reserved = 0;
+      for (UanPdp::Iterator it = pdp.GetBegin (); it != pdp.GetEnd (); it++)
+        {
+          taps.push_back (it->GetAmp ().real ());
+          taps.push_back (it->GetAmp ().imag ());
+        }
+    }
+
+  // Lay the grid out exactly as in a binary file
+  Header header;
+  std::copy (GRID_MAGIC, GRID_MAGIC + sizeof (GRID_MAGIC), header.m_magic);
+  header.m_version = GRID_VERSION;
+  header.m_byteOrder = GRID_BYTE_ORDER;
+  header.m_nFreq = axes[0].size ();
+  header.m_nSrc = axes[1].size ();
+  header.m_nRcv = axes[2].size ();
+  header.m_nRange = axes[3].size ();
+  header.m_axesOffset = AlignUp (sizeof (Header));
+  uint64_t nAxis = axes[0].size () + axes[1].size () + axes[2].size () + axes[3].size ();
+  header.m_cellsOffset = AlignUp (header.m_axesOffset + nAxis * sizeof (double));
+  header.m_tapsOffset = AlignUp (header.m_cellsOffset + nCells * sizeof (Cell));
+  header.m_nTaps = taps.size () / 2;
+  header.m_fileSize = header.m_tapsOffset + taps.size () * sizeof (double);
+
+  m_size = header.m_fileSize;
+  if (m_size > std::numeric_limits<size_t>::max ())
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " is too large to load ("
+                                             << m_size << " bytes)");
+    }
+  m_image.assign ((m_size + sizeof (uint64_t) - 1) / sizeof (uint64_t), 0);
+  char *base = reinterpret_cast<char *> (&m_image[0]);
+  std::memcpy (base, &header, sizeof (header));
+  char *axisDst = base + header.m_axesOffset;
+  for (uint32_t a = 0; a < 4; a++)
+    {
+      std::memcpy (axisDst, &axes[a][0], axes[a].size () * sizeof (double));
+      axisDst += axes[a].size () * sizeof (double);
+    }
+  std::memcpy (base + header.m_cellsOffset, &cells[0], nCells * sizeof (Cell));
+  if (!taps.empty ())
+    {
+      std::memcpy (base + header.m_tapsOffset, &taps[0], taps.size () * sizeof (double));
+    }
+  m_base = base;
+}
+
+void
+UanPropGrid::Attach (std::string fileName)
+{
+  if (m_base == 0 || m_size == 0)
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " is empty");
+    }
+  if (m_size < sizeof (Header))
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " truncated");
+    }
+  const Header *header = reinterpret_cast<const Header *> (m_base);
+  if (header->m_byteOrder != GRID_BYTE_ORDER)
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " has the wrong byte order");
+    }
+  if (header->m_version != GRID_VERSION)
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " has unsupported version " << header->m_version);
+    }
+
+  m_nFreq = header->m_nFreq;
+  m_nSrc = header->m_nSrc;
+  m_nRcv = header->m_nRcv;
+  m_nRange = header->m_nRange;
+  m_nTaps = header->m_nTaps;
+  uint64_t nAxis = (uint64_t) m_nFreq + m_nSrc + m_nRcv + m_nRange;
+  // Bound every count by what the file could hold before it enters the
+  // offset arithmetic below, so a corrupted header cannot overflow it
+  uint64_t nCells = 1;
+  uint32_t dims[4] = { m_nFreq, m_nSrc, m_nRcv, m_nRange };
+  for (uint32_t d = 0; d < 4; d++)
+    {
+      if (dims[d] != 0 && nCells > m_size / sizeof (Cell) / dims[d])
+        {
+          NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " corrupted header: too many cells");
+        }
+      nCells *= dims[d];
+    }
+  if (m_nTaps > m_size / (2 * sizeof (double))
+      || header->m_axesOffset > m_size
+      || header->m_cellsOffset > m_size
+      || header->m_tapsOffset > m_size)
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " corrupted header");
+    }
+  if (m_nFreq == 0 || m_nSrc == 0 || m_nRcv == 0 || m_nRange == 0
+      || header->m_fileSize != m_size
+      || header->m_axesOffset % GRID_ALIGN != 0
+      || header->m_cellsOffset % GRID_ALIGN != 0
+      || header->m_tapsOffset % GRID_ALIGN != 0
+      || header->m_axesOffset + nAxis * sizeof (double) > header->m_cellsOffset
+      || header->m_cellsOffset + nCells * sizeof (Cell) > header->m_tapsOffset
+      || header->m_tapsOffset + m_nTaps * 2 * sizeof (double) > m_size)
+    {
+      NS_FATAL_ERROR ("UanPropModelBh file " << fileName << " corrupted header");
+    }
+
+  m_freqs = reinterpret_cast<const double *> (m_base + header->m_axesOffset);
+  m_srcDepths = m_freqs + m_nFreq;
+  m_rcvDepths = m_srcDepths + m_nSrc;
+  m_ranges = m_rcvDepths + m_nRcv;
+  m_cells = reinterpret_cast<const Cell *> (m_base + header->m_cellsOffset);
+  m_taps = reinterpret_cast<const double *> (m_base + header->m_tapsOffset);
+}
+
+void
+UanPropGrid::WriteBinary (std::string fileName) const
+{
+  std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary);
+  if (!file.is_open () || !file.write (m_base, m_size))
+    {
+      NS_FATAL_ERROR ("Could not write UanPropModelBh file " << fileName);
+    }
+}
+
+uint64_t
+UanPropGrid::GetCell (uint32_t f, uint32_t s, uint32_t r, uint32_t k) const
+{
+  return (((uint64_t) f * m_nSrc + s) * m_nRcv + r) * m_nRange + k;
+}
+
+uint32_t
+UanPropGrid::GetFreqIndex (double fKhz) const
+{
+  return NearestOnAxis (m_freqs, m_nFreq, fKhz);
+}
+
+double
+UanPropGrid::Interpolate (double Cell::*field, uint32_t freqIndex,
+                          double srcDepth, double rcvDepth, double range) const
+{
+  uint32_t s[2], r[2], k[2];
+  double fs, fr, fk;
+  LocateOnAxis (m_srcDepths, m_nSrc, srcDepth, s[0], s[1], fs);
+  LocateOnAxis (m_rcvDepths, m_nRcv, rcvDepth, r[0], r[1], fr);
+  LocateOnAxis (m_ranges, m_nRange, range, k[0], k[1], fk);
+
+  double sum = 0;
+  for (uint32_t c = 0; c < 8; c++)
+    {
+      double w = ((c & 1) ? fs : 1 - fs) * ((c & 2) ? fr : 1 - fr) * ((c & 4) ? fk : 1 - fk);
+      if (w != 0)
+        {
+          sum += w * (m_cells[GetCell (freqIndex, s[c & 1], r[(c >> 1) & 1], k[(c >> 2) & 1])].*field);
+        }
+    }
+  return sum;
+}
+
+double
+UanPropGrid::GetPathLossDb (uint32_t freqIndex, double srcDepth, double rcvDepth, double range) const
+{
+  return Interpolate (&Cell::m_lossDb, freqIndex, srcDepth, rcvDepth, range);
+}
+
+Time
+UanPropGrid::GetDelay (uint32_t freqIndex, double srcDepth, double rcvDepth, double range) const
+{
+  return Seconds (Interpolate (&Cell::m_delayS, freqIndex, srcDepth, rcvDepth, range));
+}
+
+const UanPdp &
+UanPropGrid::GetPdp (uint32_t freqIndex, double srcDepth, double rcvDepth, double range) const
+{
+  uint64_t index = GetCell (freqIndex,
+                            NearestOnAxis (m_srcDepths, m_nSrc, srcDepth),
+                            NearestOnAxis (m_rcvDepths, m_nRcv, rcvDepth),
+                            NearestOnAxis (m_ranges, m_nRange, range));
+
+  std::map<uint64_t, UanPdp>::iterator it = m_pdps.find (index);
+  if (it == m_pdps.end ())
+    {
+      const Cell &cell = m_cells[index];
+      if (cell.m_firstTap + cell.m_nTaps > m_nTaps)
+        {
+          NS_FATAL_ERROR ("UanPropModelBh grid cell " << index << " refers to taps past the end of the file");
+        }
+      std::vector<std::complex<double> > amps (cell.m_nTaps);
+      const double *tap = m_taps + 2 * cell.m_firstTap;
+      for (uint32_t i = 0; i < cell.m_nTaps; i++)
+        {
+          amps[i] = std::complex<double> (tap[2 * i], tap[2 * i + 1]);
+        }
+      it = m_pdps.insert (std::make_pair (index, UanPdp (amps, Seconds (cell.m_resolutionS)))).first;
+    }
+  return it->second;
+}
+
+/*************** UanPropModelBh definition *****************/
+UanPropModelBh::UanPropModelBh ()
+  : m_grid (0)
+{
+}
+
+UanPropModelBh::~UanPropModelBh ()
+{
+}
+
+TypeId
+UanPropModelBh::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UanPropModelBh")
+    .SetParent<Object> ()
+    .AddConstructor<UanPropModelBh> ()
+    .AddAttribute ("ConfigFile",
+                   "Name of file holding the pathloss, delay and PDP grid",
+                   StringValue (""),
+                   MakeStringAccessor (&UanPropModelBh::SetConfigFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+void
+UanPropModelBh::SetConfigFile (std::string fileName)
+{
+  m_configFile = fileName;
+  m_grid = 0;
+}
+
+const UanPropGrid &
+UanPropModelBh::GetGrid (void)
+{
+  if (m_grid == 0)
+    {
+      m_grid = &UanPropGrid::Get (m_configFile);
+    }
+  return *m_grid;
+}
+
+static double
+HorizontalRange (Ptr<MobilityModel> a, Ptr<MobilityModel> b)
+{
+  Vector pa = a->GetPosition ();
+  Vector pb = b->GetPosition ();
+  return std::sqrt ((pa.x - pb.x) * (pa.x - pb.x) + (pa.y - pb.y) * (pa.y - pb.y));
+}
+
+double
+UanPropModelBh::GetPathLossDb (Ptr<MobilityModel> a, Ptr<MobilityModel> b, UanTxMode mode)
+{
+  const UanPropGrid &grid = GetGrid ();
+  return grid.GetPathLossDb (grid.GetFreqIndex (mode.GetCenterFreqHz () / 1000.0),
+                             a->GetPosition ().z, b->GetPosition ().z, HorizontalRange (a, b));
+}
+
+UanPdp
+UanPropModelBh::GetPdp (Ptr<MobilityModel> a, Ptr<MobilityModel> b, UanTxMode mode)
+{
+  const UanPropGrid &grid = GetGrid ();
+  return grid.GetPdp (grid.GetFreqIndex (mode.GetCenterFreqHz () / 1000.0),
+                      a->GetPosition ().z, b->GetPosition ().z, HorizontalRange (a, b));
+}
+
+Time
+UanPropModelBh::GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b, UanTxMode mode)
+{
+  const UanPropGrid &grid = GetGrid ();
+  return grid.GetDelay (grid.GetFreqIndex (mode.GetCenterFreqHz () / 1000.0),
+                        a->GetPosition ().z, b->GetPosition ().z, HorizontalRange (a, b));
+}
+
+void
+UanPropModelBh::Clear (void)
+{
+  m_grid = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,210 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANPROPMODELBH_H
+#define UANPROPMODELBH_H
+
+#include "uan-prop-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \class UanPropGrid
+ * \brief Precomputed pathloss, delay and PDP on a frequency x source depth
+ * x receiver depth x range grid, shared by all UanPropModelBh objects
+ *
+ * Files are loaded the first time they are requested and kept
+ * for the lifetime of the process, so every channel in a simulation
+ * refers to the same copy of the grid.
+ *
+ * A grid file may be text or binary.  The text format has '#' starting
+ * a comment.  It begins with the four grid axes, each a keyword followed
+ * by the number of points and the (strictly increasing) points:
+ *
+ *   FREQUENCIES nFreq f0 f1 ...     (kHz)
+ *   SOURCEDEPTHS nSrc d0 d1 ...     (m)
+ *   RECEIVERDEPTHS nRcv d0 d1 ...   (m)
+ *   RANGES nRange r0 r1 ...         (m)
+ *
+ * followed by the keyword CELLS and nFreq * nSrc * nRcv * nRange cells,
+ * range varying fastest and frequency slowest.  Each cell is
+ *
+ *   pathLossDb delaySeconds pdp
+ *
+ * where pdp is a UanPdp in the format written by operator<<.
+ *
+ * Binary files (written by WriteBinary, see the uan-env-convert example)
+ * are memory-mapped read-only rather than parsed, so loading a grid takes
+ * constant time and its pages are shared with every other user of the
+ * file.  All values are in native byte order and each block starts on a
+ * 64 byte boundary:
+ *
+ *   header  magic "UANGRID", version, byte order mark 0x01020304, the
+ *           four axis lengths, offsets of the axes, cells and taps
+ *           blocks, total number of taps and file size
+ *   axes    the four axes as doubles, in the order above
+ *   cells   per grid point: pathloss (dB), delay (s), PDP resolution (s)
+ *           as doubles, index of the first tap (uint64) and number of
+ *           taps (uint32), padded to 40 bytes
+ *   taps    real and imaginary part of each tap amplitude as doubles
+ */
+class UanPropGrid
+{
+public:
+  /**
+   * \param fileName Name of grid file, text or binary
+   * \returns Grid loaded from fileName (loaded on first request only)
+   */
+  static const UanPropGrid &Get (std::string fileName);
+
+  /**
+   * Writes this grid in the binary format
+   * \param fileName Name of file to write
+   */
+  void WriteBinary (std::string fileName) const;
+
+  /**
+   * \param fKhz Frequency in kHz
+   * \returns Index of the grid frequency nearest fKhz
+   */
+  uint32_t GetFreqIndex (double fKhz) const;
+  /**
+   * \param freqIndex Frequency index as returned by GetFreqIndex
+   * \param srcDepth Depth of source in m
+   * \param rcvDepth Depth of receiver in m
+   * \param range Horizontal range in m
+   * \returns Pathloss in dB interpolated over depths and range
+   */
+  double GetPathLossDb (uint32_t freqIndex, double srcDepth, double rcvDepth, double range) const;
+  /**
+   * \param freqIndex Frequency index as returned by GetFreqIndex
+   * \param srcDepth Depth of source in m
+   * \param rcvDepth Depth of receiver in m
+   * \param range Horizontal range in m
+   * \returns Propagation delay interpolated over depths and range
+   */
+  Time GetDelay (uint32_t freqIndex, double srcDepth, double rcvDepth, double range) const;
+  /**
+   * \param freqIndex Frequency index as returned by GetFreqIndex
+   * \param srcDepth Depth of source in m
+   * \param rcvDepth Depth of receiver in m
+   * \param range Horizontal range in m
+   * \returns PDP of the grid point nearest the link
+   */
+  const UanPdp &GetPdp (uint32_t freqIndex, double srcDepth, double rcvDepth, double range) const;
+
+  ~UanPropGrid ();
+
+private:
+  struct Header;
+  struct Cell;
+
+  UanPropGrid ();
+  UanPropGrid (const UanPropGrid &o);
+  UanPropGrid &operator= (const UanPropGrid &o);
+
+  void Load (std::string fileName);
+  void LoadText (std::istream &file, std::string fileName);
+  void LoadBinary (std::string fileName);
+  void ReadAxis (std::istream &is, std::string keyword, std::vector<double> &axis, std::string fileName);
+  /**
+   * Checks the header of the binary image at m_base and sets up the
+   * axis, cell and tap pointers into it
+   */
+  void Attach (std::string fileName);
+  /**
+   * \returns Index into m_cells of the given grid point
+   */
+  uint64_t GetCell (uint32_t f, uint32_t s, uint32_t r, uint32_t k) const;
+  /**
+   * Interpolates a cell field over source depth, receiver depth and range
+   */
+  double Interpolate (double Cell::*field, uint32_t freqIndex,
+                      double srcDepth, double rcvDepth, double range) const;
+
+  /// Binary image, either memory-mapped or in m_image
+  const char *m_base;
+  uint64_t m_size;
+  void *m_mapping;
+  /// Image built from a text file (or read if mapping fails)
+  std::vector<uint64_t> m_image;
+
+  uint32_t m_nFreq;
+  uint32_t m_nSrc;
+  uint32_t m_nRcv;
+  uint32_t m_nRange;
+  const double *m_freqs;
+  const double *m_srcDepths;
+  const double *m_rcvDepths;
+  const double *m_ranges;
+  const Cell *m_cells;
+  const double *m_taps;
+  uint64_t m_nTaps;
+  /// PDPs built from the taps of the grid points used so far
+  mutable std::map<uint64_t, UanPdp> m_pdps;
+};
+
+/**
+ * \class UanPropModelBh
+ * \brief Propagation model using a precomputed grid of pathloss and multipath
+ *
+ * Pathloss, delay and PDP are looked up in the grid file given by the
+ * ConfigFile attribute (see UanPropGrid for the format), typically
+ * produced offline with the Bellhop ray tracer.  No external program is
+ * needed at run time.
+ *
+ * The grid frequency nearest the center frequency of the TX mode is used.
+ * Source and receiver depth are the z coordinates of the nodes and range
+ * is their horizontal distance.  Pathloss and delay are interpolated
+ * linearly in depth and range (clamped at the grid edges).  The PDP of
+ * the nearest grid point is returned, as interpolating complex tap
+ * amplitudes between grid points would introduce spurious fading.
+ */
+class UanPropModelBh : public UanPropModel
+{
+public:
+  UanPropModelBh ();
+  virtual ~UanPropModelBh ();
+
+  static TypeId GetTypeId (void);
+
+  // Inherited methods
+  virtual double GetPathLossDb (Ptr<MobilityModel> a, Ptr<MobilityModel> b, UanTxMode mode);
+  virtual UanPdp GetPdp (Ptr<MobilityModel> a, Ptr<MobilityModel> b, UanTxMode mode);
+  virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b, UanTxMode mode);
+  virtual void Clear (void);
+
+private:
+  void SetConfigFile (std::string fileName);
+  const UanPropGrid &GetGrid (void);
+
+  std::string m_configFile;
+  const UanPropGrid *m_grid;
+};
+
+} // namespace ns3
+
+#endif // UANPROPMODELBH_H
@@ -20,8 +20,11 @@
 #include "uan-prop-model-thorp.h"
 #include "uan-tx-mode.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 
+#include <cmath>
+
 NS_LOG_COMPONENT_DEFINE ("UanPropModelThorp");
 
 namespace ns3 {
@@ -29,6 +32,7 @@ namespace ns3 {
 NS_OBJECT_ENSURE_REGISTERED (UanPropModelThorp);
 
 UanPropModelThorp::UanPropModelThorp ()
+  : m_fastLog (false)
 {
 }
 
@@ -47,6 +51,11 @@ UanPropModelThorp::GetTypeId (void)
                    DoubleValue (1.5),
                    MakeDoubleAccessor (&UanPropModelThorp::m_SpreadCoef),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("FastLog",
+                   "Use a polynomial approximation of log10 for the spreading loss",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UanPropModelThorp::m_fastLog),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -56,8 +65,55 @@ UanPropModelThorp::GetPathLossDb (Ptr<MobilityModel> a, Ptr<MobilityModel> b, Ua
 {
   double distKyd = a->GetDistanceFrom (b) / 1.093613298; // Convert from dB/km to dB/kyd
 
-  return m_SpreadCoef * 10.0 * log10 (distKyd)
-         + distKyd * GetAttenDbKyd (10/*mode.GetCenterFreqHz () / 1000.0*/);
+  double logDist = m_fastLog ? FastLog10 (distKyd) : log10 (distKyd);
+  return m_SpreadCoef * 10.0 * logDist
+         + distKyd * GetModeAttenDbKyd (mode);
+}
+
+double
+UanPropModelThorp::GetModeAttenDbKyd (const UanTxMode &mode)
+{
+  uint32_t uid = mode.GetUid ();
+  if (uid >= m_atten.size ())
+    {
+      AttenEntry empty;
+      empty.m_valid = false;
+      empty.m_cfHz = 0;
+      empty.m_attenDbKyd = 0;
+      m_atten.resize (uid + 1, empty);
+    }
+
+  // Modes may be redefined (same name and uid, new parameters)
+  // so the cached value is checked against the center frequency
+  uint32_t cfHz = mode.GetCenterFreqHz ();
+  AttenEntry &entry = m_atten[uid];
+  if (!entry.m_valid || entry.m_cfHz != cfHz)
+    {
+      entry.m_valid = true;
+      entry.m_cfHz = cfHz;
+      entry.m_attenDbKyd = GetAttenDbKyd (cfHz / 1000.0);
+      NS_LOG_DEBUG ("Thorp absorption for mode " << uid << " at " << cfHz << " Hz = "
+                                                 << entry.m_attenDbKyd << " dB/kyd");
+    }
+  return entry.m_attenDbKyd;
+}
+
+double
+UanPropModelThorp::FastLog10 (double x)
+{
+  // x = m * 2^e with m in [sqrt(0.5), sqrt(2)), then
+  // ln (m) = 2 atanh (s), s = (m - 1) / (m + 1), |s| < 0.172
+  int e;
+  double m = frexp (x, &e);
+  if (m < 0.70710678118654752)
+    {
+      m *= 2;
+      e--;
+    }
+  double s = (m - 1) / (m + 1);
+  double s2 = s * s;
+  double lnM = 2 * s * (1 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7))));
+  return e * 0.30102999566398120 + lnM * 0.43429448190325183;
 }
 
 UanPdp
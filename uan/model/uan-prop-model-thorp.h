@@ -30,6 +30,10 @@ class UanTxMode;
 /**
  * \class UanPropModelThorp
  * \brief Uses Thorp's approximation to compute pathloss.  Assumes implulse PDP.
+ *
+ * Absorption is evaluated at the center frequency of the TX mode and
+ * cached by mode uid.  The spreading term can optionally use a fast
+ * polynomial approximation of log10 (FastLog attribute).
  */
 class UanPropModelThorp : public UanPropModel
 {
@@ -45,8 +49,28 @@ public:
 
 private:
   double GetAttenDbKyd (double freqKhz);
+  /**
+   * \param mode TX mode
+   * \returns Absorption in dB/kyd at center frequency of mode
+   */
+  double GetModeAttenDbKyd (const UanTxMode &mode);
+  /**
+   * \param x Positive value
+   * \returns Approximation of log10 (x), accurate to about 1e-8
+   */
+  static double FastLog10 (double x);
+
+  struct AttenEntry
+  {
+    bool m_valid;
+    uint32_t m_cfHz;
+    double m_attenDbKyd;
+  };
 
   double m_SpreadCoef;
+  bool m_fastLog;
+  /// Absorption cache indexed by mode uid
+  std::vector<AttenEntry> m_atten;
 };
 
 }
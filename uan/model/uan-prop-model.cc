@@ -22,6 +22,7 @@
 #include "ns3/nstime.h"
 #include <complex>
 #include <vector>
+#include <algorithm>
 
 
 namespace ns3 {
@@ -32,8 +33,8 @@ operator<< (std::ostream &os, UanPdp &pdp)
   os << pdp.GetNTaps () << '|';
   os << pdp.GetResolution ().GetSeconds () << '|';
 
-  UanPdp::Iterator it = pdp.m_taps.begin ();
-  for (; it != pdp.m_taps.end (); it++)
+  UanPdp::Iterator it = pdp.GetBegin ();
+  for (; it != pdp.GetEnd (); it++)
     {
       os << (*it).GetAmp () << '|';
     }
@@ -63,7 +64,8 @@ operator>> (std::istream &is, UanPdp &pdp)
 
 
   std::complex<double> amp;
-  pdp.m_taps = std::vector<Tap> (ntaps);
+  std::vector<Tap> &taps = pdp.GetWritableData ().m_taps;
+  taps = std::vector<Tap> (ntaps);
   for (uint32_t i = 0; i < ntaps; i++)
     {
       is >> amp >> c1;
@@ -72,7 +74,7 @@ operator>> (std::istream &is, UanPdp &pdp)
           NS_FATAL_ERROR ("UanPdp data corrupted at tap " << i);
           return is;
         }
-      pdp.m_taps[i] = Tap (Seconds (resolution * i), amp);
+      taps[i] = Tap (Seconds (resolution * i), amp);
     }
   return is;
 
@@ -105,67 +107,126 @@ Tap::GetDelay (void) const
 }
 
 
+UanPdp::Data::Data ()
+  : m_sumsValid (false),
+    m_maxTapIndex (0)
+{
+}
+
+void
+UanPdp::Data::UpdateSums (void) const
+{
+  uint32_t nTaps = m_taps.size ();
+  m_ncSums.resize (nTaps + 1);
+  m_cSums.resize (nTaps + 1);
+  m_ncSums[0] = 0;
+  m_cSums[0] = 0;
+
+  double maxAmp = -1;
+  m_maxTapIndex = 0;
+  for (uint32_t i = 0; i < nTaps; i++)
+    {
+      double amp = abs (m_taps[i].GetAmp ());
+      if (amp > maxAmp)
+        {
+          maxAmp = amp;
+          m_maxTapIndex = i;
+        }
+      m_ncSums[i + 1] = m_ncSums[i] + amp;
+      m_cSums[i + 1] = m_cSums[i] + m_taps[i].GetAmp ();
+    }
+  m_sumsValid = true;
+}
+
 UanPdp::UanPdp ()
+  : m_data (Create<Data> ())
 {
 
 }
 
 UanPdp::UanPdp (std::vector<Tap> taps, Time resolution)
-  : m_taps (taps),
+  : m_data (Create<Data> ()),
     m_resolution (resolution)
 {
+  m_data->m_taps = taps;
 }
 
 UanPdp::UanPdp (std::vector<std::complex<double> > amps, Time resolution)
-  : m_resolution (resolution)
+  : m_data (Create<Data> ()),
+    m_resolution (resolution)
 {
-  m_taps.resize (amps.size ());
+  std::vector<Tap> &taps = m_data->m_taps;
+  taps.resize (amps.size ());
   Time arrTime = Seconds (0);
   for (uint32_t index = 0; index < amps.size (); index++)
     {
-      m_taps[index] = Tap (arrTime, amps[index]);
+      taps[index] = Tap (arrTime, amps[index]);
       arrTime = arrTime + m_resolution;
     }
 }
 
 UanPdp::UanPdp (std::vector<double> amps, Time resolution)
-  : m_resolution (resolution)
+  : m_data (Create<Data> ()),
+    m_resolution (resolution)
 {
-  m_taps.resize (amps.size ());
+  std::vector<Tap> &taps = m_data->m_taps;
+  taps.resize (amps.size ());
   Time arrTime = Seconds (0);
   for (uint32_t index = 0; index < amps.size (); index++)
     {
-      m_taps[index] = Tap (arrTime, amps[index]);
+      taps[index] = Tap (arrTime, amps[index]);
       arrTime = arrTime + m_resolution;
     }
 }
 
 UanPdp::~UanPdp ()
 {
-  m_taps.clear ();
+  m_data = 0;
+}
+
+UanPdp::Data &
+UanPdp::GetWritableData (void)
+{
+  if (m_data->GetReferenceCount () > 1)
+    {
+      m_data = Ptr<Data> (new Data (*m_data), false);
+    }
+  m_data->m_sumsValid = false;
+  return *m_data;
+}
+
+const UanPdp::Data &
+UanPdp::GetSummedData (void) const
+{
+  if (!m_data->m_sumsValid)
+    {
+      m_data->UpdateSums ();
+    }
+  return *m_data;
 }
 
 void
 UanPdp::SetTap (std::complex<double> amp, uint32_t index)
 {
-  if (m_taps.size () <= index)
+  std::vector<Tap> &taps = GetWritableData ().m_taps;
+  if (taps.size () <= index)
     {
-      m_taps.resize (index + 1);
+      taps.resize (index + 1);
     }
 
   Time delay = Seconds (index * m_resolution.GetSeconds ());
-  m_taps[index] = Tap (delay, amp);
+  taps[index] = Tap (delay, amp);
 }
 const Tap &
 UanPdp::GetTap (uint32_t i) const
 {
   NS_ASSERT_MSG (i < GetNTaps (), "Call to UanPdp::GetTap with requested tap out of range");
-  return m_taps[i];
+  return m_data->m_taps[i];
 }
 void
 UanPdp::SetNTaps (uint32_t nTaps)
 {
-  m_taps.resize (nTaps);
+  GetWritableData ().m_taps.resize (nTaps);
 }
 void
 UanPdp::SetResolution (Time resolution)
@@ -175,19 +236,19 @@ UanPdp::SetResolution (Time resolution)
 UanPdp::Iterator
 UanPdp::GetBegin (void) const
 {
-  return m_taps.begin ();
+  return m_data->m_taps.begin ();
 }
 
 UanPdp::Iterator
 UanPdp::GetEnd (void) const
 {
-  return m_taps.end ();
+  return m_data->m_taps.end ();
 }
 
 uint32_t
 UanPdp::GetNTaps (void) const
 {
-  return m_taps.size ();
+  return m_data->m_taps.size ();
 }
 
 Time
@@ -196,6 +257,36 @@ UanPdp::GetResolution (void) const
   return m_resolution;
 }
 
+uint32_t
+UanPdp::GetMaxTapIndex (void) const
+{
+  return GetSummedData ().m_maxTapIndex;
+}
+
+double
+UanPdp::SumIndexNc (uint32_t begin, uint32_t end) const
+{
+  const Data &data = GetSummedData ();
+  end = std::min (end, GetNTaps ());
+  if (begin >= end)
+    {
+      return 0.0;
+    }
+  return data.m_ncSums[end] - data.m_ncSums[begin];
+}
+
+std::complex<double>
+UanPdp::SumIndexC (uint32_t begin, uint32_t end) const
+{
+  const Data &data = GetSummedData ();
+  end = std::min (end, GetNTaps ());
+  if (begin >= end)
+    {
+      return std::complex<double> (0.0);
+    }
+  return data.m_cSums[end] - data.m_cSums[begin];
+}
+
 std::complex<double>
 UanPdp::SumTapsFromMaxC (Time delay, Time duration) const
 {
@@ -204,29 +295,12 @@ UanPdp::SumTapsFromMaxC (Time delay, Time duration) const
       NS_ASSERT_MSG (GetNTaps () == 1, "Attempted to sum taps over time interval in "
                      "UanPdp with resolution 0 and multiple taps");
 
-      return m_taps[0].GetAmp ();
+      return GetTap (0).GetAmp ();
     }
 
   uint32_t numTaps =  static_cast<uint32_t> (duration.GetSeconds () / m_resolution.GetSeconds () + 0.5);
-  double maxAmp = -1;
-  uint32_t maxTapIndex = 0;
-
-  for (uint32_t i = 0; i < GetNTaps (); i++)
-    {
-      if (abs (m_taps[i].GetAmp ()) > maxAmp)
-        {
-          maxAmp = abs (m_taps[i].GetAmp ());
-          maxTapIndex = i;
-        }
-    }
-  uint32_t start = maxTapIndex + static_cast<uint32_t> (delay.GetSeconds () / m_resolution.GetSeconds ());
-  uint32_t end = std::min (start + numTaps, GetNTaps ());
-  std::complex<double> sum = 0;
-  for (uint32_t i = start; i < end; i++)
-    {
-      sum += m_taps[i].GetAmp ();
-    }
-  return sum;
+  uint32_t start = GetMaxTapIndex () + static_cast<uint32_t> (delay.GetSeconds () / m_resolution.GetSeconds ());
+  return SumIndexC (start, start + numTaps);
 }
 double
 UanPdp::SumTapsFromMaxNc (Time delay, Time duration) const
@@ -236,32 +310,12 @@ UanPdp::SumTapsFromMaxNc (Time delay, Time duration) const
       NS_ASSERT_MSG (GetNTaps () == 1, "Attempted to sum taps over time interval in "
                      "UanPdp with resolution 0 and multiple taps");
 
-      return abs (m_taps[0].GetAmp ());
+      return abs (GetTap (0).GetAmp ());
     }
 
   uint32_t numTaps =  static_cast<uint32_t> (duration.GetSeconds () / m_resolution.GetSeconds () + 0.5);
-  double maxAmp = -1;
-  uint32_t maxTapIndex = 0;
-
-  for (uint32_t i = 0; i < GetNTaps (); i++)
-    {
-      if (abs (m_taps[i].GetAmp ()) > maxAmp)
-        {
-          maxAmp = abs (m_taps[i].GetAmp ());
-          maxTapIndex = i;
-        }
-    }
-
-
-  uint32_t start = maxTapIndex + static_cast<uint32_t> (delay.GetSeconds () / m_resolution.GetSeconds ());
-  uint32_t end = std::min (start + numTaps, GetNTaps ());
-  double sum = 0;
-  for (uint32_t i = start; i < end; i++)
-
-    {
-      sum += abs (m_taps[i].GetAmp ());
-    }
-  return sum;
+  uint32_t start = GetMaxTapIndex () + static_cast<uint32_t> (delay.GetSeconds () / m_resolution.GetSeconds ());
+  return SumIndexNc (start, start + numTaps);
 }
 double
 UanPdp::SumTapsNc (Time begin, Time end) const
@@ -273,7 +327,7 @@ UanPdp::SumTapsNc (Time begin, Time end) const
 
       if (begin <= Seconds (0.0) && end >= Seconds (0.0))
         {
-          return abs (m_taps[0].GetAmp ());
+          return abs (GetTap (0).GetAmp ());
         }
       else
         {
@@ -284,14 +338,7 @@ UanPdp::SumTapsNc (Time begin, Time end) const
   uint32_t stIndex = (uint32_t)(begin.GetSeconds () / m_resolution.GetSeconds () + 0.5);
   uint32_t endIndex = (uint32_t)(end.GetSeconds () / m_resolution.GetSeconds () + 0.5);
 
-  endIndex = std::min (endIndex, GetNTaps ());
-  double sum = 0;
-  for (uint32_t i = stIndex; i < endIndex; i++)
-    {
-      sum += abs (m_taps[i].GetAmp ());
-    }
-  return sum;
-
+  return SumIndexNc (stIndex, endIndex);
 }
 
 
@@ -306,7 +353,7 @@ UanPdp::SumTapsC (Time begin, Time end) const
 
       if (begin <= Seconds (0.0) && end >= Seconds (0.0))
         {
-          return m_taps[0].GetAmp ();
+          return GetTap (0).GetAmp ();
         }
       else
         {
@@ -317,18 +364,11 @@ UanPdp::SumTapsC (Time begin, Time end) const
   uint32_t stIndex = (uint32_t)(begin.GetSeconds () / m_resolution.GetSeconds () + 0.5);
   uint32_t endIndex = (uint32_t)(end.GetSeconds () / m_resolution.GetSeconds () + 0.5);
 
-  endIndex = std::min (endIndex, GetNTaps ());
-
-  std::complex<double> sum = 0;
-  for (uint32_t i = stIndex; i < endIndex; i++)
-    {
-      sum += m_taps[i].GetAmp ();
-    }
-  return sum;
+  return SumIndexC (stIndex, endIndex);
 }
 
-UanPdp
-UanPdp::CreateImpulsePdp (void)
+static UanPdp
+BuildImpulsePdp (void)
 {
   UanPdp pdp;
   pdp.SetResolution (Seconds (0));
@@ -336,6 +376,14 @@ UanPdp::CreateImpulsePdp (void)
   return pdp;
 }
 
+UanPdp
+UanPdp::CreateImpulsePdp (void)
+{
+  // Every caller shares the same tap storage, which is copied on write
+  static const UanPdp impulse = BuildImpulsePdp ();
+  return impulse;
+}
+
 void
 UanPropModel::Clear (void)
 {
@@ -24,6 +24,7 @@
 #include "ns3/object.h"
 #include "ns3/mobility-model.h"
 #include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
 
 
 #include <vector>
@@ -78,7 +79,15 @@ private:
  * summing the taps on the interval and multiplying by
  * the total received power at the receiver.
  *
+ * The index of the maximum amplitude tap and running sums of the
+ * tap amplitudes are cached the first time they are needed (and
+ * again after the taps are modified), so the SumTaps methods cost
+ * O(1) regardless of the number of taps.
  *
+ * The taps (and cached sums) are held in reference counted storage
+ * which is shared between copies of a UanPdp, so PDPs can be passed
+ * by value cheaply.  Storage is copied only when a shared PDP is
+ * modified with SetTap or SetNTaps.
  */
 class UanPdp
 {
@@ -187,6 +196,10 @@ public:
    * starting the given time after the maximum amplitude arrival received
    */
   std::complex<double> SumTapsFromMaxC (Time delay, Time duration) const;
+  /**
+   * \returns Index of the arrival with the largest amplitude (first one if tied)
+   */
+  uint32_t GetMaxTapIndex (void) const;
 
   /**
    * \returns A PDP with a singlue unit impulse arrival at time 0
@@ -195,7 +208,53 @@ public:
 private:
   friend std::ostream &operator<< (std::ostream &os, UanPdp &pdp);
   friend std::istream &operator>> (std::istream &is, UanPdp &pdp);
-  std::vector<Tap> m_taps;
+
+  /**
+   * \class Data
+   * \brief Reference counted tap storage, shared by copies of a UanPdp
+   */
+  class Data : public SimpleRefCount<Data>
+  {
+  public:
+    Data ();
+
+    /**
+     * Recomputes m_maxTapIndex and the running sums from m_taps
+     */
+    void UpdateSums (void) const;
+
+    std::vector<Tap> m_taps;
+    mutable bool m_sumsValid;
+    mutable uint32_t m_maxTapIndex;
+    /// m_ncSums[i] is the sum of abs (amplitude) of taps 0 to i-1
+    mutable std::vector<double> m_ncSums;
+    /// m_cSums[i] is the sum of the complex amplitudes of taps 0 to i-1
+    mutable std::vector<std::complex<double> > m_cSums;
+  };
+
+  /**
+   * \returns Tap storage which is not shared with any other UanPdp
+   * (copying it first if necessary), with cached sums invalidated
+   */
+  Data &GetWritableData (void);
+  /**
+   * \returns Tap storage with valid cached sums
+   */
+  const Data &GetSummedData (void) const;
+  /**
+   * \param begin Index of first tap to sum
+   * \param end Index one past the last tap to sum (clamped to number of taps)
+   * \returns Non-coherent sum of taps in [begin, end)
+   */
+  double SumIndexNc (uint32_t begin, uint32_t end) const;
+  /**
+   * \param begin Index of first tap to sum
+   * \param end Index one past the last tap to sum (clamped to number of taps)
+   * \returns Coherent sum of taps in [begin, end)
+   */
+  std::complex<double> SumIndexC (uint32_t begin, uint32_t end) const;
+
+  Ptr<Data> m_data;
   Time m_resolution;
 
 };
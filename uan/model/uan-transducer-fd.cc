@@ -0,0 +1,179 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-transducer-fd.h"
+#include "uan-phy.h"
+#include "uan-channel.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+
+#include <map>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("UanTransducerFd");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanTransducerFd);
+
+/**
+ * \returns Mode with the band of txMode, used for in band self interference
+ */
+static UanTxMode
+GetSelfMode (const UanTxMode &txMode)
+{
+  typedef std::map<std::pair<uint32_t, uint32_t>, UanTxMode> SelfModes;
+  static SelfModes selfModes;
+
+  std::pair<uint32_t, uint32_t> band (txMode.GetCenterFreqHz (), txMode.GetBandwidthHz ());
+  SelfModes::const_iterator it = selfModes.find (band);
+  if (it != selfModes.end ())
+    {
+      return it->second;
+    }
+  std::ostringstream name;
+  name << "UanTransducerFdSelf" << band.first << "_" << band.second;
+  UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::OTHER,
+                                                 txMode.GetDataRateBps (),
+                                                 txMode.GetPhyRateSps (),
+                                                 band.first,
+                                                 band.second,
+                                                 txMode.GetConstellationSize (),
+                                                 name.str ());
+  selfModes[band] = mode;
+  return mode;
+}
+
+/**
+ * \returns Mode overlapping every band, used for out of band self interference
+ */
+static UanTxMode
+GetLeakageMode (void)
+{
+  static UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::OTHER, 1, 1, 0, 2000000000, 2,
+                                                        "UanTransducerFdLeakage");
+  return mode;
+}
+
+UanTransducerFd::UanTransducerFd ()
+  : UanTransducerHd (),
+    m_inBandIsolationDb (0),
+    m_outOfBandIsolationDb (100),
+    m_nTx (0)
+{
+}
+
+UanTransducerFd::~UanTransducerFd ()
+{
+}
+
+TypeId
+UanTransducerFd::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::UanTransducerFd")
+    .SetParent<UanTransducerHd> ()
+    .AddConstructor<UanTransducerFd> ()
+    .AddAttribute ("InBandIsolation",
+                   "Attenuation in dB of the own transmission at the receiver, in the band transmitted in.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&UanTransducerFd::m_inBandIsolationDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("OutOfBandIsolation",
+                   "Attenuation in dB of the own transmission at the receiver, in other bands.",
+                   DoubleValue (100),
+                   MakeDoubleAccessor (&UanTransducerFd::m_outOfBandIsolationDb),
+                   MakeDoubleChecker<double> ())
+  ;
+  return tid;
+}
+
+UanTransducer::State
+UanTransducerFd::GetState () const
+{
+  return m_nTx > 0 ? TX : RX;
+}
+
+bool
+UanTransducerFd::IsRx (void) const
+{
+  return true;
+}
+
+bool
+UanTransducerFd::IsTx (void) const
+{
+  return m_nTx > 0;
+}
+
+void
+UanTransducerFd::Receive (Ptr<Packet> packet,
+                          double rxPowerDb,
+                          UanTxMode txMode,
+                          UanPdp pdp)
+{
+  UanPacketArrival arrival (packet, rxPowerDb, txMode, pdp, Simulator::Now ());
+  Deliver (arrival, Seconds (packet->GetSize () * 8.0 / (txMode.GetDataRateBps () * arrival.GetDopplerFactor ())), 0);
+}
+
+void
+UanTransducerFd::Deliver (const UanPacketArrival &arrival, Time duration, Ptr<UanPhy> src)
+{
+  AddArrival (arrival, duration);
+  UanPhyList::const_iterator it = m_phyList.begin ();
+  for (; it != m_phyList.end (); it++)
+    {
+      if (*it != src && !(*it)->IsStateTx ())
+        {
+          (*it)->StartRxPacket (arrival.GetPacket (), arrival.GetRxPowerDb (), arrival.GetTxMode (), arrival.GetPdp ());
+        }
+    }
+}
+
+void
+UanTransducerFd::Transmit (Ptr<UanPhy> src,
+                           Ptr<Packet> packet,
+                           double txPowerDb,
+                           UanTxMode txMode)
+{
+  Time delay = Seconds (packet->GetSize () * 8.0 / txMode.GetDataRateBps ());
+  NS_LOG_DEBUG ("Transducer transmitting:  TX delay = "
+                << delay << " seconds for packet size "
+                << packet->GetSize () << " bytes and rate = "
+                << txMode.GetDataRateBps () << " bps");
+  m_nTx++;
+  Simulator::Schedule (delay, &UanTransducerFd::EndTx, this);
+  m_channel->TxPacket (Ptr<UanTransducer> (this), packet, txPowerDb, txMode);
+
+  // The other PHYs see the transmission as interference
+  UanPdp pdp = UanPdp::CreateImpulsePdp ();
+  Deliver (UanPacketArrival (packet, txPowerDb - m_inBandIsolationDb, GetSelfMode (txMode), pdp, Simulator::Now ()),
+           delay, src);
+  Deliver (UanPacketArrival (Create<Packet> (), txPowerDb - m_outOfBandIsolationDb, GetLeakageMode (), pdp, Simulator::Now ()),
+           delay, src);
+}
+
+void
+UanTransducerFd::EndTx (void)
+{
+  NS_ASSERT (m_nTx > 0);
+  m_nTx--;
+}
+
+} // namespace ns3
@@ -0,0 +1,82 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANTRANSDUCERFD_H
+#define UANTRANSDUCERFD_H
+
+#include "uan-transducer-hd.h"
+
+namespace ns3 {
+
+/**
+ * \class UanTransducerFd
+ * \brief Transducer able to receive while transmitting
+ *
+ * Models a node with separate transmit and receive hydrophones, or a
+ * front end filtering its own transmissions out of other bands.  Unlike
+ * UanTransducerHd, a transmission does not stop reception: arrivals keep
+ * being passed to every attached PHY which is not transmitting itself,
+ * so a PHY with several receive chains (UanPhyDual, UanPhyMulti) can
+ * receive on one band while transmitting on another.
+ *
+ * Each transmission is also added to the local arrival list as self
+ * interference, for its duration:
+ *  - in its own band, at the transmit power minus InBandIsolation
+ *  - in all bands, at the transmit power minus OutOfBandIsolation
+ *
+ * The self interference arrivals use modes no PHY supports, so they are
+ * never received as packets, but they enter the SINR and CCA evaluations
+ * of the PHYs like any other interferer.  With the default InBandIsolation
+ * of 0 dB a node still can not receive in the band it is transmitting in.
+ */
+class UanTransducerFd : public UanTransducerHd
+{
+public:
+  UanTransducerFd ();
+  virtual ~UanTransducerFd ();
+
+  static TypeId GetTypeId (void);
+
+  // inherited methods
+  virtual State GetState (void) const;
+  virtual bool IsRx (void) const;
+  virtual bool IsTx (void) const;
+  virtual void Receive (Ptr<Packet> packet, double rxPowerDb, UanTxMode txMode, UanPdp pdp);
+  virtual void Transmit (Ptr<UanPhy> src, Ptr<Packet> packet, double txPowerDb, UanTxMode txMode);
+
+private:
+  /**
+   * Adds arrival and starts its reception on the PHYs which are not transmitting
+   * \param arrival Arrival to add
+   * \param duration Duration of arrival
+   * \param src PHY transmitting arrival, which is skipped (Null Ptr for arrivals from the channel)
+   */
+  void Deliver (const UanPacketArrival &arrival, Time duration, Ptr<UanPhy> src);
+  void EndTx (void);
+
+  double m_inBandIsolationDb;
+  double m_outOfBandIsolationDb;
+  /// Number of transmissions in progress
+  uint32_t m_nTx;
+};
+
+} // namespace ns3
+
+#endif // UANTRANSDUCERFD_H
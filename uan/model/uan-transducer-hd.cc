@@ -23,6 +23,7 @@
 #include "ns3/uan-prop-model.h"
 #include "uan-phy.h"
 #include "uan-channel.h"
+#include "uan-counters.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 
@@ -36,7 +37,9 @@ UanTransducerHd::UanTransducerHd ()
   : UanTransducer (),
     m_state (RX),
     m_endTxTime (Seconds (0)),
-    m_cleared (false)
+    m_cleared (false),
+    m_totalPowerKp (0),
+    m_powerValid (false)
 {
 }
 
@@ -74,6 +77,8 @@ UanTransducerHd::Clear ()
     }
   m_phyList.clear ();
   m_arrivalList.clear ();
+  m_bandPower.clear ();
+  m_powerValid = false;
   m_endTxEvent.Cancel ();
 }
 
@@ -131,9 +136,8 @@ UanTransducerHd::Receive (Ptr<Packet> packet,
                             pdp,
                             Simulator::Now ());
 
-  m_arrivalList.push_back (arrival);
-  Time txDelay = Seconds (packet->GetSize () * 8.0 / txMode.GetDataRateBps ());
-  Simulator::Schedule (txDelay, &UanTransducerHd::RemoveArrival, this, arrival);
+  // Doppler compresses (or stretches) the arriving signal in time
+  AddArrival (arrival, Seconds (packet->GetSize () * 8.0 / (txMode.GetDataRateBps () * arrival.GetDopplerFactor ())));
   NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Transducer in receive");
   if (m_state == RX)
     {
@@ -218,6 +222,75 @@ UanTransducerHd::GetPhyList (void) const
   return m_phyList;
 }
 
+double
+UanTransducerHd::GetBandPowerKp (const UanTxMode &mode)
+{
+  if (!m_powerValid)
+    {
+      UpdatePower ();
+    }
+  BandKey key (mode.GetCenterFreqHz (), mode.GetBandwidthHz ());
+  std::map<BandKey, double>::iterator bit = m_bandPower.find (key);
+  if (bit != m_bandPower.end ())
+    {
+      return bit->second;
+    }
+
+  // First request for this band since the arrival list changed
+  double powerKp = 0;
+  ArrivalList::const_iterator it = m_arrivalList.begin ();
+  for (; it != m_arrivalList.end (); it++)
+    {
+      if (BandsOverlap (it->GetTxMode (), mode))
+        {
+          powerKp += std::pow (10, it->GetRxPowerDb () / 10.0);
+        }
+    }
+  m_bandPower[key] = powerKp;
+  return powerKp;
+}
+
+double
+UanTransducerHd::GetTotalPowerKp (void)
+{
+  if (!m_powerValid)
+    {
+      UpdatePower ();
+    }
+  return m_totalPowerKp;
+}
+
+uint32_t
+UanTransducerHd::GetNCachedBands (void) const
+{
+  return m_bandPower.size ();
+}
+
+void
+UanTransducerHd::UpdatePower (void)
+{
+  // Bands are recomputed on their next query, so that bands which are no
+  // longer queried (e.g. the rates of earlier RC-MAC cycles) cost nothing
+  m_bandPower.clear ();
+  m_totalPowerKp = 0;
+
+  ArrivalList::const_iterator it = m_arrivalList.begin ();
+  for (; it != m_arrivalList.end (); it++)
+    {
+      m_totalPowerKp += std::pow (10, it->GetRxPowerDb () / 10.0);
+    }
+  m_powerValid = true;
+}
+
+void
+UanTransducerHd::AddArrival (const UanPacketArrival &arrival, Time duration)
+{
+  m_arrivalList.push_back (arrival);
+  m_powerValid = false;
+  UanCounters::Increment (UanCounters::ARRIVAL_ADDED);
+  Simulator::Schedule (duration, &UanTransducerHd::RemoveArrival, this, arrival);
+}
+
 void
 UanTransducerHd::RemoveArrival (UanPacketArrival arrival)
 {
@@ -229,6 +302,8 @@ UanTransducerHd::RemoveArrival (UanPacketArrival arrival)
       if (it->GetPacket () == arrival.GetPacket ())
         {
           m_arrivalList.erase (it);
+          m_powerValid = false;
+          UanCounters::Increment (UanCounters::ARRIVAL_REMOVED);
           break;
         }
     }
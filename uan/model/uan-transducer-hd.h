@@ -23,6 +23,9 @@
 
 #include "uan-transducer.h"
 #include "ns3/simulator.h"
+
+#include <map>
+
 namespace ns3 {
 
 /**
@@ -50,21 +53,48 @@ public:
   virtual Ptr<UanChannel> GetChannel (void) const;
   virtual void AddPhy (Ptr<UanPhy>);
   virtual const UanPhyList &GetPhyList (void) const;
+  virtual double GetBandPowerKp (const UanTxMode &mode);
+  virtual double GetTotalPowerKp (void);
   virtual void Clear (void);
 
-private:
-  State m_state;
+  /**
+   * \returns Number of bands whose arrival power is cached.  The cache
+   * holds only the bands queried since the arrival list last changed.
+   */
+  uint32_t GetNCachedBands (void) const;
+
+protected:
+  /**
+   * Adds arrival to the arrival list and schedules its removal
+   * \param arrival Arrival to add
+   * \param duration Time the arrival stays in the list
+   */
+  void AddArrival (const UanPacketArrival &arrival, Time duration);
+  /**
+   * Removes arrival from the arrival list and notifies the PHYs
+   * \param arrival Arrival to remove
+   */
+  void RemoveArrival (UanPacketArrival arrival);
+  virtual void DoDispose ();
+
   ArrivalList m_arrivalList;
   UanPhyList m_phyList;
   Ptr<UanChannel> m_channel;
+
+private:
+  State m_state;
   EventId m_endTxEvent;
   Time m_endTxTime;
   bool m_cleared;
+  typedef std::pair<uint32_t, uint32_t> BandKey;
+  /// Arrival power of the bands queried since the last arrival list change, keyed by center frequency and bandwidth
+  std::map<BandKey, double> m_bandPower;
+  double m_totalPowerKp;
+  /// True if m_bandPower and m_totalPowerKp match the arrival list
+  bool m_powerValid;
 
-  void RemoveArrival (UanPacketArrival arrival);
+  void UpdatePower (void);
   void EndTx (void);
-protected:
-  virtual void DoDispose ();
 };
 
 }
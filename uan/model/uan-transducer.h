@@ -24,8 +24,10 @@
 #include "ns3/packet.h"
 #include "uan-tx-mode.h"
 #include "ns3/uan-prop-model.h"
+#include "uan-doppler-tag.h"
 
 #include <list>
+#include <cmath>
 namespace ns3 {
 
 class UanPhy;
@@ -98,10 +100,18 @@ public:
   /**
    * \returns PDP of arriving signal
    */
-  inline UanPdp GetPdp (void) const
+  inline const UanPdp &GetPdp (void) const
   {
     return m_pdp;
   }
+  /**
+   * \returns Doppler factor of arriving signal (1 unless it crossed a link with a moving node)
+   */
+  inline double GetDopplerFactor (void) const
+  {
+    UanDopplerTag tag;
+    return m_packet->PeekPacketTag (tag) ? tag.GetDopplerFactor () : 1.0;
+  }
 private:
   Ptr<Packet> m_packet;
   double m_rxPowerDb;
@@ -186,6 +196,28 @@ public:
    * \returns List of all Phy's this transducer sends packets to.
    */
   virtual const UanPhyList &GetPhyList (void) const = 0;
+  /**
+   * Sum of the power of the arrivals whose band overlaps the band of mode.
+   * The sums are kept until the arrival list changes, so all PHYs attached
+   * to this transducer share one pass over the arrivals.
+   * \param mode Mode whose center frequency and bandwidth define the band
+   * \returns Power in kilopascals
+   */
+  virtual double GetBandPowerKp (const UanTxMode &mode) = 0;
+  /**
+   * \returns Sum of the power of all arrivals in kilopascals
+   */
+  virtual double GetTotalPowerKp (void) = 0;
+  /**
+   * \param a First mode
+   * \param b Second mode
+   * \returns True if the frequency bands of a and b overlap
+   */
+  static inline bool BandsOverlap (const UanTxMode &a, const UanTxMode &b)
+  {
+    return std::abs ((double) a.GetCenterFreqHz () - (double) b.GetCenterFreqHz ())
+           < (double)(a.GetBandwidthHz () / 2 + b.GetBandwidthHz () / 2) - 0.5;
+  }
   /**
    * Clears all pointer references
    */
@@ -0,0 +1,227 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#include "uan-tx-queue.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("UanTxQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UanTxQueue);
+
+UanTxQueue::UanTxQueue ()
+  : m_maxPackets (100),
+    m_maxBytes (0),
+    m_discipline (FIFO),
+    m_dropPolicy (DROP_TAIL),
+    m_nPackets (0),
+    m_nBytes (0)
+{
+}
+
+UanTxQueue::~UanTxQueue ()
+{
+}
+
+TypeId
+UanTxQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UanTxQueue")
+    .SetParent<Object> ()
+    .AddConstructor<UanTxQueue> ()
+    .AddAttribute ("MaxPackets",
+                   "Maximum number of packets in the queue.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&UanTxQueue::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxBytes",
+                   "Maximum number of bytes in the queue (0 for no limit).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&UanTxQueue::m_maxBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Discipline",
+                   "Order packets are dequeued in.",
+                   EnumValue (FIFO),
+                   MakeEnumAccessor (&UanTxQueue::m_discipline),
+                   MakeEnumChecker (FIFO, "Fifo",
+                                    PRIORITY, "Priority"))
+    .AddAttribute ("DropPolicy",
+                   "Packets dropped when a new packet does not fit.",
+                   EnumValue (DROP_TAIL),
+                   MakeEnumAccessor (&UanTxQueue::m_dropPolicy),
+                   MakeEnumChecker (DROP_TAIL, "DropTail",
+                                    DROP_HEAD, "DropHead"))
+    .AddTraceSource ("Drop",
+                     "A packet was dropped by the queue.",
+                     MakeTraceSourceAccessor (&UanTxQueue::m_dropLogger))
+    .AddTraceSource ("Depth",
+                     "Number of packets and bytes in the queue, after each change.",
+                     MakeTraceSourceAccessor (&UanTxQueue::m_depthLogger))
+    .AddTraceSource ("Sojourn",
+                     "A packet was dequeued, with the time it spent in the queue.",
+                     MakeTraceSourceAccessor (&UanTxQueue::m_sojournLogger))
+  ;
+  return tid;
+}
+
+void
+UanTxQueue::DoDispose (void)
+{
+  Clear ();
+  Object::DoDispose ();
+}
+
+void
+UanTxQueue::SetPriority (uint16_t protocolNumber, uint8_t priority)
+{
+  m_priority[protocolNumber] = priority;
+}
+
+uint8_t
+UanTxQueue::GetPriority (uint16_t protocolNumber) const
+{
+  if (m_discipline == FIFO)
+    {
+      return 0;
+    }
+  std::map<uint16_t, uint8_t>::const_iterator it = m_priority.find (protocolNumber);
+  return it == m_priority.end () ? 0 : it->second;
+}
+
+bool
+UanTxQueue::Enqueue (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber)
+{
+  uint32_t size = packet->GetSize ();
+  uint8_t priority = GetPriority (protocolNumber);
+
+  bool fits = m_nPackets < m_maxPackets && (m_maxBytes == 0 || m_nBytes + size <= m_maxBytes);
+  if (!fits && m_dropPolicy == DROP_HEAD)
+    {
+      // Only drop older packets if that makes enough room
+      uint32_t freePackets = m_maxPackets - m_nPackets;
+      uint32_t freeBytes = m_maxBytes - m_nBytes;
+      for (BandMap::iterator it = m_bands.begin (); it != m_bands.end () && it->first <= priority; it++)
+        {
+          for (Band::iterator item = it->second.begin (); item != it->second.end (); item++)
+            {
+              freePackets++;
+              freeBytes += item->packet->GetSize ();
+            }
+        }
+      if (freePackets >= 1 && (m_maxBytes == 0 || freeBytes >= size))
+        {
+          while (m_nPackets >= m_maxPackets || (m_maxBytes != 0 && m_nBytes + size > m_maxBytes))
+            {
+              BandMap::iterator it = m_bands.begin ();
+              Ptr<Packet> old = it->second.front ().packet;
+              RemoveFront (it);
+              Drop (old);
+            }
+          fits = true;
+        }
+    }
+  if (!fits)
+    {
+      Drop (packet);
+      return false;
+    }
+
+  Item item;
+  item.packet = packet;
+  item.dest = dest;
+  item.protocolNumber = protocolNumber;
+  item.enqueueTime = Simulator::Now ();
+  m_bands[priority].push_back (item);
+  m_nPackets++;
+  m_nBytes += size;
+  m_depthLogger (m_nPackets, m_nBytes);
+  return true;
+}
+
+const UanTxQueue::Item &
+UanTxQueue::Peek (void) const
+{
+  NS_ASSERT (!m_bands.empty ());
+  return m_bands.rbegin ()->second.front ();
+}
+
+void
+UanTxQueue::Dequeue (void)
+{
+  NS_ASSERT (!m_bands.empty ());
+  BandMap::iterator it = m_bands.end ();
+  it--;
+  const Item &item = it->second.front ();
+  m_sojournLogger (item.packet, Simulator::Now () - item.enqueueTime);
+  RemoveFront (it);
+}
+
+void
+UanTxQueue::RemoveFront (BandMap::iterator it)
+{
+  m_nPackets--;
+  m_nBytes -= it->second.front ().packet->GetSize ();
+  it->second.pop_front ();
+  if (it->second.empty ())
+    {
+      m_bands.erase (it);
+    }
+  m_depthLogger (m_nPackets, m_nBytes);
+}
+
+void
+UanTxQueue::Drop (Ptr<const Packet> packet)
+{
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " Dropping packet of size " << packet->GetSize ());
+  m_dropLogger (packet);
+}
+
+bool
+UanTxQueue::IsEmpty (void) const
+{
+  return m_nPackets == 0;
+}
+
+uint32_t
+UanTxQueue::GetNPackets (void) const
+{
+  return m_nPackets;
+}
+
+uint32_t
+UanTxQueue::GetNBytes (void) const
+{
+  return m_nBytes;
+}
+
+void
+UanTxQueue::Clear (void)
+{
+  m_bands.clear ();
+  m_nPackets = 0;
+  m_nBytes = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,150 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Leonard Tracy <lentracy@gmail.com>
+ */
+
+#ifndef UANTXQUEUE_H
+#define UANTXQUEUE_H
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+
+#include <deque>
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \class UanTxQueue
+ * \brief Bounded transmit queue of a UanNetDevice
+ *
+ * Holds the packets an upper layer has sent until the MAC can accept
+ * them.  The queue is bounded by MaxPackets and, if MaxBytes is not
+ * zero, by the sum of the packet sizes.  With the PRIORITY discipline
+ * packets are dequeued in order of the priority of their protocol
+ * number (see SetPriority, 0 by default) and FIFO within a priority;
+ * with FIFO all packets share one band.
+ *
+ * When a packet does not fit, DROP_TAIL drops the new packet.  DROP_HEAD
+ * drops the oldest packets of the lowest priority band until the new
+ * packet fits, but never packets of higher priority than the new one.
+ */
+class UanTxQueue : public Object
+{
+public:
+  enum Discipline
+  {
+    FIFO,
+    PRIORITY
+  };
+  enum DropPolicy
+  {
+    DROP_TAIL,
+    DROP_HEAD
+  };
+
+  /**
+   * \brief Queued packet and the arguments it was sent with
+   */
+  struct Item
+  {
+    Ptr<Packet> packet;
+    Address dest;
+    uint16_t protocolNumber;
+    Time enqueueTime;
+  };
+
+  UanTxQueue ();
+  virtual ~UanTxQueue ();
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param protocolNumber Protocol number
+   * \param priority Priority of packets with protocolNumber (higher is served first)
+   */
+  void SetPriority (uint16_t protocolNumber, uint8_t priority);
+  /**
+   * \param protocolNumber Protocol number
+   * \returns Priority of packets with protocolNumber (always 0 with FIFO discipline)
+   */
+  uint8_t GetPriority (uint16_t protocolNumber) const;
+
+  /**
+   * \param packet Packet to queue
+   * \param dest Destination address
+   * \param protocolNumber Protocol number
+   * \returns False if packet was dropped
+   */
+  bool Enqueue (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
+  /**
+   * \returns Next packet to be dequeued.  Queue must not be empty.
+   */
+  const Item &Peek (void) const;
+  /**
+   * Removes the packet returned by Peek
+   */
+  void Dequeue (void);
+  /**
+   * \returns True if no packets are queued
+   */
+  bool IsEmpty (void) const;
+  /**
+   * \returns Number of packets queued
+   */
+  uint32_t GetNPackets (void) const;
+  /**
+   * \returns Number of bytes queued
+   */
+  uint32_t GetNBytes (void) const;
+  /**
+   * Drops all queued packets
+   */
+  void Clear (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  typedef std::deque<Item> Band;
+  typedef std::map<uint8_t, Band> BandMap;
+
+  void Drop (Ptr<const Packet> packet);
+  void RemoveFront (BandMap::iterator it);
+
+  uint32_t m_maxPackets;
+  uint32_t m_maxBytes;
+  Discipline m_discipline;
+  DropPolicy m_dropPolicy;
+  std::map<uint16_t, uint8_t> m_priority;
+
+  /// Non empty bands by priority
+  BandMap m_bands;
+  uint32_t m_nPackets;
+  uint32_t m_nBytes;
+
+  TracedCallback<Ptr<const Packet> > m_dropLogger;
+  TracedCallback<uint32_t, uint32_t> m_depthLogger;
+  TracedCallback<Ptr<const Packet>, Time> m_sojournLogger;
+};
+
+} // namespace ns3
+
+#endif // UANTXQUEUE_H
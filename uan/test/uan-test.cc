@@ -22,15 +22,42 @@
 #include "ns3/uan-channel.h"
 #include "ns3/uan-mac-aloha.h"
 #include "ns3/uan-phy-gen.h"
+#include "ns3/uan-phy-multi.h"
+#include "ns3/uan-phy-per-table.h"
 #include "ns3/uan-transducer-hd.h"
+#include "ns3/uan-transducer-fd.h"
 #include "ns3/uan-prop-model-ideal.h"
+#include "ns3/uan-prop-model-thorp.h"
+#include "ns3/uan-prop-model-bh.h"
+#include "ns3/uan-doppler-tag.h"
+#include "ns3/uan-counters.h"
+#include "ns3/uan-tx-queue.h"
+#include "ns3/uan-trace-writer.h"
+#include "ns3/uan-stats-collector.h"
+#include "ns3/uan-header-rc.h"
+#include "ns3/uan-header-common.h"
+#include "ns3/uan-mac-rc.h"
+#include "ns3/uan-mac-rc-gw.h"
+#include "ns3/uan-phy-dual.h"
+#include "ns3/uan-noise-model-default.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 #include "ns3/node.h"
 #include "ns3/object-factory.h"
 #include "ns3/pointer.h"
 #include "ns3/callback.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/global-value.h"
+#include "ns3/enum.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
 
 using namespace ns3;
 
@@ -222,6 +249,56 @@ UanTest::DoPhyTests ()
   NS_TEST_ASSERT_MSG_EQ (DoOnePhyTest (Seconds (1.0), Seconds (2.99), 50, 50, prop, 2, 3),
                          34, "Expected no collision");
 
+  // Phy Multi with the chains of Phy Dual
+  UanModesList mAll;
+  for (uint32_t i = 0; i < m0.GetNModes (); i++)
+    {
+      mAll.AppendMode (m0[i]);
+    }
+  for (uint32_t i = 0; i < m1.GetNModes (); i++)
+    {
+      mAll.AppendMode (m1[i]);
+    }
+  phyId = TypeId::LookupByName ("ns3::UanPhyMulti");
+  m_phyFac.SetTypeId (phyId);
+  phyList.Reset ();
+  phyList.SetWithTid (phyId, "SupportedModes", UanModesListValue (mAll));
+  phyList.SetWithTid (phyId, "ModesPerChain", UintegerValue (3));
+  m_phyFac.Set (phyList);
+
+  NS_TEST_ASSERT_MSG_EQ (DoOnePhyTest (Seconds (1.0), Seconds (2.99), 50, 50, prop, 0, 2),
+                         17, "Expected collision with only one packets lost");
+
+  NS_TEST_ASSERT_MSG_EQ (DoOnePhyTest (Seconds (1.0), Seconds (2.99), 50, 50, prop, 0, 5),
+                         34, "Expected no collision");
+
+  // One chain per mode:  non overlapping modes are received simultaneously
+  phyList.Reset ();
+  phyList.SetWithTid (phyId, "SupportedModes", UanModesListValue (mAll));
+  phyList.SetWithTid (phyId, "ModesPerChain", UintegerValue (1));
+  m_phyFac.Set (phyList);
+
+  NS_TEST_ASSERT_MSG_EQ (DoOnePhyTest (Seconds (1.0), Seconds (2.99), 50, 50, prop, 0, 2),
+                         34, "Expected simultaneous reception on two chains");
+
+  NS_TEST_ASSERT_MSG_EQ (DoOnePhyTest (Seconds (1.0), Seconds (2.99), 50, 50, prop, 0, 1),
+                         0, "Expected collision of overlapping modes on different chains");
+
+  // Chains rebuilt after attaching the PHY are attached the same way
+  Ptr<UanPhyMulti> multi = CreateObjectWithAttributes<UanPhyMulti> ("SupportedModes", UanModesListValue (mAll));
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+  Ptr<UanNetDevice> dev = CreateObject<UanNetDevice> ();
+  multi->SetChannel (channel);
+  multi->SetDevice (dev);
+  multi->SetModesPerChain (2);
+  for (uint32_t i = 0; i < multi->GetNChains (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (multi->GetChain (i)->GetChannel (), channel, "Rebuilt chain lost the channel");
+      NS_TEST_ASSERT_MSG_EQ (multi->GetChain (i)->GetDevice (), dev, "Rebuilt chain lost the device");
+    }
+  multi->Clear ();
+  dev->Clear ();
+
   return false;
 }
 
@@ -250,6 +327,1459 @@ UanTest::DoRun (void)
 }
 
 
+class UanPerTableTest : public TestCase
+{
+public:
+  UanPerTableTest ();
+
+  virtual bool DoRun (void);
+};
+
+UanPerTableTest::UanPerTableTest () : TestCase ("UanPhyPerUmodem table lookup")
+{
+
+}
+
+bool
+UanPerTableTest::DoRun (void)
+{
+  Ptr<UanPhyPerUmodem> exact = CreateObject<UanPhyPerUmodem> ();
+  Ptr<UanPhyPerUmodem> table = CreateObject<UanPhyPerUmodem> ();
+  table->SetAttribute ("UseTable", BooleanValue (true));
+  UanTxMode mode = UanPhyGen::GetDefaultModes ()[0];
+
+  uint32_t sizes[] = { 10, 100, 1000 };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<Packet> pkt = Create<Packet> (sizes[i]);
+      for (double sinr = 5.5; sinr < 10.5; sinr += 0.0137)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (table->CalcPer (pkt, sinr, mode),
+                                     exact->CalcPer (pkt, sinr, mode), 1e-4,
+                                     "Tabulated PER differs from analytic PER at " << sinr << " dB, "
+                                                                                  << sizes[i] << " bytes");
+        }
+    }
+
+  Ptr<Packet> pkt = Create<Packet> (1000);
+  NS_TEST_ASSERT_MSG_EQ_TOL (table->CalcPer (pkt, 9, mode), 0.539, 0.001, "Got PER outside of tolerance");
+
+  return GetErrorStatus ();
+}
+
+
+class UanPerFileTest : public TestCase
+{
+public:
+  UanPerFileTest ();
+
+  virtual bool DoRun (void);
+};
+
+UanPerFileTest::UanPerFileTest () : TestCase ("UanPhyPerTable file lookup")
+{
+
+}
+
+bool
+UanPerFileTest::DoRun (void)
+{
+  const char *fileName = "uan-per-table-test.txt";
+  {
+    std::ofstream f (fileName);
+    f << "# mode, sinrMin, sinrStep, nSinr, lenMin, lenStep, nLen\n";
+    f << "MODE PerTableTestMode, 0, 5, 3, 10, 10, 2\n";
+    f << "1.0, 0.5, 0.0\n";
+    f << "1.0, 0.7, 0.2\n";
+  }
+  UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 10000, 4000, 2, "PerTableTestMode");
+
+  Ptr<UanPhyPerTable> per = CreateObject<UanPhyPerTable> ();
+  per->SetAttribute ("FileName", StringValue (fileName));
+  Ptr<UanPhyPerTable> per2 = CreateObject<UanPhyPerTable> ();
+  per2->SetAttribute ("FileName", StringValue (fileName));
+
+  double onGrid = per->CalcPer (Create<Packet> (10), 2.5, mode);
+  double inside = per->CalcPer (Create<Packet> (15), 7.5, mode);
+  // Table is cached, so this lookup succeeds after the file is gone
+  std::remove (fileName);
+  double clamped = per2->CalcPer (Create<Packet> (100), 20, mode);
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (onGrid, 0.75, 1e-9, "Wrong PER interpolated along SINR");
+  NS_TEST_ASSERT_MSG_EQ_TOL (inside, 0.35, 1e-9, "Wrong PER interpolated along SINR and length");
+  NS_TEST_ASSERT_MSG_EQ_TOL (clamped, 0.2, 1e-9, "PER outside table not clamped to table edge");
+
+  return GetErrorStatus ();
+}
+
+
+class UanPdpSumTest : public TestCase
+{
+public:
+  UanPdpSumTest ();
+
+  virtual bool DoRun (void);
+};
+
+UanPdpSumTest::UanPdpSumTest () : TestCase ("UanPdp tap sums")
+{
+
+}
+
+bool
+UanPdpSumTest::DoRun (void)
+{
+  std::vector<std::complex<double> > amps;
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      amps.push_back (std::polar (1.0 / (1.0 + std::abs (i - 17.0)), 0.3 * i));
+    }
+  Time res = Seconds (0.001);
+  UanPdp pdp (amps, res);
+
+  NS_TEST_ASSERT_MSG_EQ (pdp.GetMaxTapIndex (), 17, "Wrong maximum tap");
+
+  for (uint32_t b = 0; b < 55; b += 3)
+    {
+      for (uint32_t e = b; e < 60; e += 7)
+        {
+          double nc = 0;
+          std::complex<double> c = 0;
+          for (uint32_t i = b; i < std::min (e, 50u); i++)
+            {
+              nc += std::abs (amps[i]);
+              c += amps[i];
+            }
+          Time begin = Seconds (b * res.GetSeconds ());
+          Time end = Seconds (e * res.GetSeconds ());
+          NS_TEST_ASSERT_MSG_EQ_TOL (pdp.SumTapsNc (begin, end), nc, 1e-9, "Wrong non-coherent sum");
+          NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (pdp.SumTapsC (begin, end) - c), 0, 1e-9, "Wrong coherent sum");
+        }
+    }
+
+  double fromMax = std::abs (amps[19]) + std::abs (amps[20]) + std::abs (amps[21]);
+  NS_TEST_ASSERT_MSG_EQ_TOL (pdp.SumTapsFromMaxNc (Seconds (0.002), Seconds (0.003)), fromMax, 1e-9,
+                             "Wrong non-coherent sum from max");
+
+  // Modifying a tap must invalidate the cached sums
+  pdp.SetTap (10.0, 3);
+  NS_TEST_ASSERT_MSG_EQ (pdp.GetMaxTapIndex (), 3, "Maximum tap not updated after SetTap");
+  NS_TEST_ASSERT_MSG_EQ_TOL (pdp.SumTapsNc (Seconds (0.003), Seconds (0.004)), 10.0, 1e-9,
+                             "Sum not updated after SetTap");
+
+  // Copies share taps until one of them is modified
+  UanPdp copy = pdp;
+  copy.SetTap (20.0, 4);
+  NS_TEST_ASSERT_MSG_EQ (pdp.GetMaxTapIndex (), 3, "Modifying a copy changed the original PDP");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetMaxTapIndex (), 4, "Modified copy has wrong maximum tap");
+
+  UanPdp impulse = UanPdp::CreateImpulsePdp ();
+  impulse.SetTap (0.5, 0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (UanPdp::CreateImpulsePdp ().GetTap (0).GetAmp ()), 1.0, 1e-9,
+                             "Modifying an impulse PDP changed the shared impulse");
+
+  return GetErrorStatus ();
+}
+
+
+class UanThorpTest : public TestCase
+{
+public:
+  UanThorpTest ();
+
+  virtual bool DoRun (void);
+private:
+  double ThorpDb (double distM, double freqKhz);
+};
+
+UanThorpTest::UanThorpTest () : TestCase ("Thorp pathloss at mode center frequency")
+{
+
+}
+
+double
+UanThorpTest::ThorpDb (double distM, double freqKhz)
+{
+  double atten = 0.002 + 0.11 * (freqKhz / (1 + freqKhz)) + 0.011 * freqKhz;
+  double distKyd = distM / 1.093613298;
+  return 1.5 * 10.0 * std::log10 (distKyd) + distKyd * atten;
+}
+
+bool
+UanThorpTest::DoRun (void)
+{
+  UanTxMode low = UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 10000, 4000, 2, "ThorpTestLow");
+  UanTxMode high = UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 25000, 4000, 2, "ThorpTestHigh");
+
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+
+  Ptr<UanPropModelThorp> exact = CreateObject<UanPropModelThorp> ();
+  Ptr<UanPropModelThorp> fast = CreateObjectWithAttributes<UanPropModelThorp> ("FastLog", BooleanValue (true));
+
+  double dists[] = { 10.0, 333.0, 1000.0, 4321.0 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      b->SetPosition (Vector (dists[i], 0, 0));
+      // Evaluate twice so the second lookup comes from the cached absorption
+      for (uint32_t pass = 0; pass < 2; pass++)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (exact->GetPathLossDb (a, b, low), ThorpDb (dists[i], 10.0), 1e-9,
+                                     "Wrong pathloss at 10 kHz");
+          NS_TEST_ASSERT_MSG_EQ_TOL (exact->GetPathLossDb (a, b, high), ThorpDb (dists[i], 25.0), 1e-9,
+                                     "Wrong pathloss at 25 kHz");
+          NS_TEST_ASSERT_MSG_EQ_TOL (fast->GetPathLossDb (a, b, high), ThorpDb (dists[i], 25.0), 1e-6,
+                                     "Fast log approximation out of tolerance");
+        }
+    }
+
+  // Redefining a mode with a new center frequency must not use the cached absorption
+  high = UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 15000, 4000, 2, "ThorpTestHigh");
+  NS_TEST_ASSERT_MSG_EQ_TOL (exact->GetPathLossDb (a, b, high), ThorpDb (4321.0, 15.0), 1e-9,
+                             "Stale absorption after mode redefinition");
+
+  return GetErrorStatus ();
+}
+
+
+class UanNoiseTest : public TestCase
+{
+public:
+  UanNoiseTest ();
+
+  virtual bool DoRun (void);
+private:
+  double UrickDbHz (double fKhz, double wind, double shipping);
+};
+
+UanNoiseTest::UanNoiseTest () : TestCase ("Ambient noise spectrum and table")
+{
+
+}
+
+double
+UanNoiseTest::UrickDbHz (double fKhz, double wind, double shipping)
+{
+  double turb = 17.0 - 30.0 * std::log10 (fKhz);
+  double ship = 40.0 + 20.0 * (shipping - 0.5) + 26.0 * std::log10 (fKhz) - 60.0 * std::log10 (fKhz + 0.03);
+  double win = 50.0 + 7.5 * std::sqrt (wind) + 20.0 * std::log10 (fKhz) - 40.0 * std::log10 (fKhz + 0.4);
+  double thermal = -15.0 + 20.0 * std::log10 (fKhz);
+  return 10 * std::log10 (std::pow (10.0, turb * 0.1) + std::pow (10.0, ship * 0.1)
+                          + std::pow (10.0, win * 0.1) + std::pow (10.0, thermal * 0.1));
+}
+
+bool
+UanNoiseTest::DoRun (void)
+{
+  Ptr<UanNoiseModelDefault> direct = CreateObjectWithAttributes<UanNoiseModelDefault> (
+      "Wind", DoubleValue (5.0), "Shipping", DoubleValue (0.5));
+  Ptr<UanNoiseModelDefault> table = CreateObjectWithAttributes<UanNoiseModelDefault> (
+      "Wind", DoubleValue (5.0), "Shipping", DoubleValue (0.5), "UseTable", BooleanValue (true));
+
+  for (double fKhz = 0.05; fKhz < 500; fKhz *= 1.37)
+    {
+      double expected = UrickDbHz (fKhz, 5.0, 0.5);
+      NS_TEST_ASSERT_MSG_EQ_TOL (direct->GetNoiseDbHz (fKhz), expected, 1e-9, "Noise differs from Urick formulas");
+      NS_TEST_ASSERT_MSG_EQ_TOL (table->GetNoiseDbHz (fKhz), expected, 0.01, "Tabulated noise out of tolerance");
+    }
+
+  // Changing an attribute must rebuild the table
+  table->SetAttribute ("Wind", DoubleValue (15.0));
+  NS_TEST_ASSERT_MSG_EQ_TOL (table->GetNoiseDbHz (3.3), UrickDbHz (3.3, 15.0, 0.5), 0.01,
+                             "Noise table not rebuilt after attribute change");
+
+  UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 12000, 4000, 2, "NoiseTestMode");
+  for (uint32_t pass = 0; pass < 2; pass++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (direct->GetNoiseDb (12.0, mode), UrickDbHz (12.0, 5.0, 0.5) + 10 * std::log10 (4000.0),
+                                 1e-9, "Wrong band-integrated noise");
+    }
+  direct->SetAttribute ("Shipping", DoubleValue (1.0));
+  NS_TEST_ASSERT_MSG_EQ_TOL (direct->GetNoiseDb (12.0, mode), UrickDbHz (12.0, 5.0, 1.0) + 10 * std::log10 (4000.0),
+                             1e-9, "Band-integrated noise not updated after attribute change");
+  direct->SetAttribute ("UseTable", BooleanValue (true));
+  NS_TEST_ASSERT_MSG_EQ_TOL (direct->GetNoiseDb (12.0, mode), direct->GetNoiseDbHz (12.0) + 10 * std::log10 (4000.0),
+                             1e-12, "Band-integrated noise not updated after switching to the table");
+
+  return GetErrorStatus ();
+}
+
+
+class UanPropBhTest : public TestCase
+{
+public:
+  UanPropBhTest ();
+
+  virtual bool DoRun (void);
+private:
+  double ExpectedLoss (uint32_t freqIndex, double srcDepth, double rcvDepth, double range);
+};
+
+UanPropBhTest::UanPropBhTest () : TestCase ("Grid based propagation model")
+{
+
+}
+
+double
+UanPropBhTest::ExpectedLoss (uint32_t freqIndex, double srcDepth, double rcvDepth, double range)
+{
+  return 40.0 + 5.0 * freqIndex + 0.1 * srcDepth + 0.2 * rcvDepth + 0.01 * range;
+}
+
+bool
+UanPropBhTest::DoRun (void)
+{
+  const char *fileName = "uan-prop-bh-test.txt";
+  double depths[] = { 10.0, 50.0 };
+  double ranges[] = { 100.0, 1000.0 };
+  {
+    std::ofstream file (fileName);
+    file << "# Loss is linear in depth and range so interpolation is exact\n"
+         << "FREQUENCIES 2 10 20\n"
+         << "SOURCEDEPTHS 2 10 50\n"
+         << "RECEIVERDEPTHS 2 10 50\n"
+         << "RANGES 2 100 1000\n"
+         << "CELLS\n";
+    for (uint32_t f = 0; f < 2; f++)
+      {
+        for (uint32_t s = 0; s < 2; s++)
+          {
+            for (uint32_t r = 0; r < 2; r++)
+              {
+                for (uint32_t k = 0; k < 2; k++)
+                  {
+                    // One more tap at the far range, amplitude identifies the frequency
+                    std::vector<double> taps (k + 1, 1.0 / (f + 1));
+                    UanPdp pdp (taps, Seconds (0.001));
+                    file << ExpectedLoss (f, depths[s], depths[r], ranges[k]) << " "
+                         << ranges[k] / 1000.0 << " " << pdp << "\n";
+                  }
+              }
+          }
+      }
+  }
+
+  Ptr<UanPropModelBh> prop = CreateObjectWithAttributes<UanPropModelBh> ("ConfigFile", StringValue (fileName));
+  UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 19000, 4000, 2, "BhTestMode");
+
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 20.0));
+  b->SetPosition (Vector (300.0, 400.0, 35.0));
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (prop->GetPathLossDb (a, b, mode), ExpectedLoss (1, 20.0, 35.0, 500.0), 1e-9,
+                             "Wrong interpolated pathloss");
+  NS_TEST_ASSERT_MSG_EQ_TOL (prop->GetDelay (a, b, mode).GetSeconds (), 0.5, 1e-9,
+                             "Wrong interpolated delay");
+
+  UanPdp pdp = prop->GetPdp (a, b, mode);
+  NS_TEST_ASSERT_MSG_EQ (pdp.GetNTaps (), 1, "PDP not taken from nearest range");
+  NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (pdp.GetTap (0).GetAmp ()), 0.5, 1e-9, "PDP not taken from nearest frequency");
+
+  // Outside the grid values are clamped to the edge
+  b->SetPosition (Vector (3000.0, 0, 80.0));
+  NS_TEST_ASSERT_MSG_EQ_TOL (prop->GetPathLossDb (a, b, mode), ExpectedLoss (1, 20.0, 50.0, 1000.0), 1e-9,
+                             "Pathloss not clamped at grid edge");
+  NS_TEST_ASSERT_MSG_EQ (prop->GetPdp (a, b, mode).GetNTaps (), 2, "PDP not clamped at grid edge");
+
+  // The binary format must give the same results as the text it was converted from
+  const char *binName = "uan-prop-bh-test.bin";
+  UanPropGrid::Get (fileName).WriteBinary (binName);
+  Ptr<UanPropModelBh> binProp = CreateObjectWithAttributes<UanPropModelBh> ("ConfigFile", StringValue (binName));
+  b->SetPosition (Vector (300.0, 400.0, 35.0));
+  NS_TEST_ASSERT_MSG_EQ_TOL (binProp->GetPathLossDb (a, b, mode), ExpectedLoss (1, 20.0, 35.0, 500.0), 1e-9,
+                             "Wrong pathloss from binary grid");
+  NS_TEST_ASSERT_MSG_EQ_TOL (binProp->GetDelay (a, b, mode).GetSeconds (), 0.5, 1e-9,
+                             "Wrong delay from binary grid");
+  pdp = binProp->GetPdp (a, b, mode);
+  NS_TEST_ASSERT_MSG_EQ (pdp.GetNTaps (), 1, "Wrong PDP from binary grid");
+  NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (pdp.GetTap (0).GetAmp ()), 0.5, 1e-9, "Wrong PDP tap from binary grid");
+  NS_TEST_ASSERT_MSG_EQ (pdp.GetResolution (), Seconds (0.001), "Wrong PDP resolution from binary grid");
+
+  std::remove (fileName);
+  std::remove (binName);
+  return GetErrorStatus ();
+}
+
+
+static Ptr<UanNetDevice>
+CreateTestNode (Ptr<MobilityModel> mobility, Ptr<UanChannel> chan, Ptr<UanPhy> phy, Ptr<UanTransducer> trans)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<UanNetDevice> dev = CreateObject<UanNetDevice> ();
+  Ptr<UanMacAloha> mac = CreateObject<UanMacAloha> ();
+
+  node->AggregateObject (mobility);
+  mac->SetAddress (UanAddress::Allocate ());
+
+  dev->SetPhy (phy);
+  dev->SetMac (mac);
+  dev->SetChannel (chan);
+  dev->SetTransducer (trans);
+  node->AddDevice (dev);
+
+  return dev;
+}
+
+static Ptr<UanNetDevice>
+CreateTestNode (Ptr<MobilityModel> mobility, Ptr<UanChannel> chan, UanModesList modes)
+{
+  return CreateTestNode (mobility, chan,
+                         CreateObjectWithAttributes<UanPhyGen> ("SupportedModes", UanModesListValue (modes)),
+                         CreateObject<UanTransducerHd> ());
+}
+
+static void
+SendTestPacket (Ptr<UanNetDevice> dev)
+{
+  dev->Send (Create<Packet> (17), dev->GetBroadcast (), 0);
+}
+
+
+class UanDopplerTest : public TestCase
+{
+public:
+  UanDopplerTest ();
+
+  virtual bool DoRun (void);
+private:
+  void RunOnce (Vector rxVelocity);
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  bool EchoRxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  static void SendBack (Ptr<UanNetDevice> dev, Ptr<Packet> pkt);
+
+  UanModesList m_modes;
+  Time m_rxTime;
+  double m_doppler;
+  bool m_echoed;
+};
+
+UanDopplerTest::UanDopplerTest () : TestCase ("Mobility aware channel")
+{
+
+}
+
+bool
+UanDopplerTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_rxTime = Simulator::Now ();
+  UanDopplerTag tag;
+  m_doppler = pkt->PeekPacketTag (tag) ? tag.GetDopplerFactor () : 1.0;
+  // Send the tagged packet back over the same link
+  Simulator::ScheduleNow (&UanDopplerTest::SendBack, dev->GetObject<UanNetDevice> (), pkt->Copy ());
+  return true;
+}
+
+void
+UanDopplerTest::SendBack (Ptr<UanNetDevice> dev, Ptr<Packet> pkt)
+{
+  dev->Send (pkt, dev->GetBroadcast (), 0);
+}
+
+bool
+UanDopplerTest::EchoRxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_echoed = true;
+  return true;
+}
+
+void
+UanDopplerTest::RunOnce (Vector rxVelocity)
+{
+  Ptr<UanChannel> channel = CreateObjectWithAttributes<UanChannel> ("MobilityAware", BooleanValue (true));
+
+  Ptr<ConstantPositionMobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+  txMobility->SetPosition (Vector (0, 0, 50));
+  Ptr<ConstantVelocityMobilityModel> rxMobility = CreateObject<ConstantVelocityMobilityModel> ();
+  rxMobility->SetPosition (Vector (1500, 0, 50));
+  rxMobility->SetVelocity (rxVelocity);
+
+  Ptr<UanNetDevice> tx = CreateTestNode (txMobility, channel, m_modes);
+  Ptr<UanNetDevice> rx = CreateTestNode (rxMobility, channel, m_modes);
+  rx->SetReceiveCallback (MakeCallback (&UanDopplerTest::RxPacket, this));
+  tx->SetReceiveCallback (MakeCallback (&UanDopplerTest::EchoRxPacket, this));
+
+  m_rxTime = Seconds (0);
+  m_doppler = 0;
+  m_echoed = false;
+  Simulator::ScheduleNow (&SendTestPacket, tx);
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+bool
+UanDopplerTest::DoRun (void)
+{
+  m_modes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 10000, 4000, 2, "DopplerTestMode"));
+
+  RunOnce (Vector (0, 0, 0));
+  Time staticRx = m_rxTime;
+  NS_TEST_ASSERT_MSG_EQ (staticRx > Seconds (1.0), true, "Packet not received over static link");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_doppler, 1.0, 1e-12, "Static link should not have a Doppler factor");
+
+  // Receiver moving directly away at 10 m/s: arrival after 1500 / (1500 - 10) s,
+  // and the packet (staticRx - 1 s long) is stretched by the same ratio
+  RunOnce (Vector (10, 0, 0));
+  NS_TEST_ASSERT_MSG_EQ_TOL ((m_rxTime - staticRx).GetSeconds (), (1500.0 / 1490.0 - 1.0) * staticRx.GetSeconds (), 1e-6,
+                             "Wrong arrival time or duration for moving receiver");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_doppler, 1490.0 / 1500.0, 1e-9, "Wrong Doppler factor");
+  NS_TEST_ASSERT_MSG_EQ (m_echoed, true, "Tagged packet was not sent back");
+
+  return GetErrorStatus ();
+}
+
+
+class UanRegionTest : public TestCase
+{
+public:
+  UanRegionTest ();
+
+  virtual bool DoRun (void);
+private:
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  std::map<NetDevice *, uint32_t> m_rxCount;
+};
+
+UanRegionTest::UanRegionTest () : TestCase ("Channel maximum range")
+{
+
+}
+
+bool
+UanRegionTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_rxCount[PeekPointer (dev)]++;
+  return true;
+}
+
+bool
+UanRegionTest::DoRun (void)
+{
+  UanModesList modes;
+  modes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 10000, 4000, 2, "RegionTestMode"));
+  Ptr<UanChannel> channel = CreateObjectWithAttributes<UanChannel> ("MaxRange", DoubleValue (1000.0));
+
+  // Sender, two nodes in range (one across a region boundary), one in a
+  // neighbouring region but out of range and one in a distant region
+  double xs[] = { 100.0, 800.0, -850.0, 1500.0, 5000.0 };
+  std::vector<Ptr<UanNetDevice> > devs;
+  std::vector<Ptr<ConstantPositionMobilityModel> > mobility;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      mobility.push_back (CreateObject<ConstantPositionMobilityModel> ());
+      mobility[i]->SetPosition (Vector (xs[i], 0, 50));
+      devs.push_back (CreateTestNode (mobility[i], channel, modes));
+      devs[i]->SetReceiveCallback (MakeCallback (&UanRegionTest::RxPacket, this));
+    }
+
+  Simulator::Schedule (Seconds (1.0), &SendTestPacket, devs[0]);
+  // Moving the distant node into range must rebuild the regions
+  Simulator::Schedule (Seconds (10.0), &ConstantPositionMobilityModel::SetPosition, mobility[4], Vector (300, 0, 50));
+  Simulator::Schedule (Seconds (11.0), &SendTestPacket, devs[0]);
+  Simulator::Stop (Seconds (20.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxCount[PeekPointer (devs[0])], 0, "Sender received its own packet");
+  NS_TEST_ASSERT_MSG_EQ (m_rxCount[PeekPointer (devs[1])], 2, "Node in range missed packets");
+  NS_TEST_ASSERT_MSG_EQ (m_rxCount[PeekPointer (devs[2])], 2, "Node across region boundary missed packets");
+  NS_TEST_ASSERT_MSG_EQ (m_rxCount[PeekPointer (devs[3])], 0, "Node out of range received packets");
+  NS_TEST_ASSERT_MSG_EQ (m_rxCount[PeekPointer (devs[4])], 1, "Regions not updated after node moved");
+
+  Simulator::Destroy ();
+  return GetErrorStatus ();
+}
+
+
+class UanCountersTest : public TestCase
+{
+public:
+  UanCountersTest ();
+
+  virtual bool DoRun (void);
+};
+
+UanCountersTest::UanCountersTest () : TestCase ("Hot path counters")
+{
+
+}
+
+bool
+UanCountersTest::DoRun (void)
+{
+  const char *fileName = "uan-counters-test.txt";
+  GlobalValue::Bind ("UanCounters", BooleanValue (true));
+  GlobalValue::Bind ("UanCountersOutputFile", StringValue (fileName));
+
+  UanModesList modes;
+  modes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 10000, 4000, 2, "CountersTestMode"));
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+
+  std::vector<Ptr<UanNetDevice> > devs;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (i * 100.0, 0, 50));
+      devs.push_back (CreateTestNode (mobility, channel, modes));
+    }
+  uint32_t txNode = devs[0]->GetNode ()->GetId ();
+  uint32_t rxNode = devs[1]->GetNode ()->GetId ();
+
+  Simulator::ScheduleWithContext (txNode, Seconds (1.0), &SendTestPacket, devs[0]);
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetGlobal (UanCounters::CHANNEL_DELIVERY), 2, "Wrong number of channel deliveries");
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetNode (UanCounters::CHANNEL_DELIVERY, txNode), 2, "Deliveries not counted for sender");
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetNode (UanCounters::CHANNEL_DELIVERY, rxNode), 0, "Deliveries counted for receiver");
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetGlobal (UanCounters::ARRIVAL_ADDED), 2, "Wrong number of arrivals added");
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetNode (UanCounters::ARRIVAL_ADDED, rxNode), 1, "Arrival not counted for receiver");
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetGlobal (UanCounters::ARRIVAL_REMOVED), 2, "Wrong number of arrivals removed");
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetGlobal (UanCounters::PER_EVAL), 2, "Wrong number of PER evaluations");
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetGlobal (UanCounters::SINR_EVAL) >= 2, true, "SINR evaluations not counted");
+
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (UanCounters::GetGlobal (UanCounters::CHANNEL_DELIVERY), 0, "Counters not reset at Destroy");
+
+  std::ifstream is (fileName);
+  std::string line;
+  bool found = false;
+  while (std::getline (is, line))
+    {
+      found = found || line.find ("UanCounters all 2 ") == 0;
+    }
+  is.close ();
+  std::remove (fileName);
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Summary not written to UanCountersOutputFile");
+
+  GlobalValue::Bind ("UanCountersOutputFile", StringValue (""));
+  GlobalValue::Bind ("UanCounters", BooleanValue (false));
+  return GetErrorStatus ();
+}
+
+
+class UanTraceWriterTest : public TestCase
+{
+public:
+  UanTraceWriterTest ();
+
+  virtual bool DoRun (void);
+private:
+  void RunOnce (bool compress);
+};
+
+UanTraceWriterTest::UanTraceWriterTest () : TestCase ("Binary trace writer")
+{
+
+}
+
+void
+UanTraceWriterTest::RunOnce (bool compress)
+{
+  const char *fileName = "uan-trace-writer-test.tr";
+  UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 10000, 4000, 2, "TraceTestMode");
+  UanModesList modes;
+  modes.AppendMode (mode);
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+
+  Ptr<ConstantPositionMobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+  txMobility->SetPosition (Vector (0, 0, 50));
+  Ptr<ConstantPositionMobilityModel> rxMobility = CreateObject<ConstantPositionMobilityModel> ();
+  rxMobility->SetPosition (Vector (1500, 0, 50));
+  Ptr<UanNetDevice> tx = CreateTestNode (txMobility, channel, modes);
+  Ptr<UanNetDevice> rx = CreateTestNode (rxMobility, channel, modes);
+
+  Ptr<UanTraceWriter> writer = CreateObjectWithAttributes<UanTraceWriter> ("Compress", BooleanValue (compress));
+  writer->Open (fileName);
+  writer->Connect (tx);
+  writer->Connect (rx);
+
+  Simulator::Schedule (Seconds (1.0), &SendTestPacket, tx);
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream is (fileName, std::ios::in | std::ios::binary);
+  std::vector<UanTraceWriter::Record> records;
+  NS_TEST_EXPECT_MSG_EQ (UanTraceWriter::Read (is, records), true, "Trace could not be read back");
+  NS_TEST_EXPECT_MSG_EQ (records.size (), 2, "Wrong number of trace records");
+  if (records.size () == 2)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) records[0].type, (uint32_t) UanTraceWriter::TX, "First record should be the transmission");
+      NS_TEST_EXPECT_MSG_EQ (records[0].node, tx->GetNode ()->GetId (), "Wrong node for transmission");
+      NS_TEST_EXPECT_MSG_EQ (records[0].timeNs, Seconds (1.0).GetNanoSeconds (), "Wrong transmission time");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) records[1].type, (uint32_t) UanTraceWriter::RX_OK, "Second record should be the reception");
+      NS_TEST_EXPECT_MSG_EQ (records[1].node, rx->GetNode ()->GetId (), "Wrong node for reception");
+      NS_TEST_EXPECT_MSG_EQ (records[1].modeUid, mode.GetUid (), "Wrong mode for reception");
+      NS_TEST_EXPECT_MSG_EQ (records[1].size, records[0].size, "Sizes of transmitted and received packet differ");
+    }
+  std::remove (fileName);
+}
+
+bool
+UanTraceWriterTest::DoRun (void)
+{
+  RunOnce (false);
+  RunOnce (true);
+  return GetErrorStatus ();
+}
+
+
+class UanStatsCollectorTest : public TestCase
+{
+public:
+  UanStatsCollectorTest ();
+
+  virtual bool DoRun (void);
+};
+
+UanStatsCollectorTest::UanStatsCollectorTest () : TestCase ("Per-link statistics collector")
+{
+
+}
+
+bool
+UanStatsCollectorTest::DoRun (void)
+{
+  const char *fileName = "uan-stats-collector-test.txt";
+  UanTxMode mode = UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 10000, 4000, 2, "StatsTestMode");
+  UanModesList modes;
+  modes.AppendMode (mode);
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+
+  Ptr<ConstantPositionMobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+  txMobility->SetPosition (Vector (0, 0, 50));
+  Ptr<ConstantPositionMobilityModel> rxMobility = CreateObject<ConstantPositionMobilityModel> ();
+  rxMobility->SetPosition (Vector (1500, 0, 50));
+  Ptr<UanNetDevice> tx = CreateTestNode (txMobility, channel, modes);
+  Ptr<UanNetDevice> rx = CreateTestNode (rxMobility, channel, modes);
+
+  Ptr<UanStatsCollector> collector = CreateObjectWithAttributes<UanStatsCollector> ("OutputFile", StringValue (fileName));
+  collector->Install (tx);
+  collector->Install (rx);
+
+  Simulator::Schedule (Seconds (1.0), &SendTestPacket, tx);
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+
+  UanAddress txAddress = UanAddress::ConvertFrom (tx->GetAddress ());
+  UanStatsCollector::LinkStats link = collector->GetLinkStats (txAddress, rx->GetNode ()->GetId ());
+  NS_TEST_ASSERT_MSG_EQ (link.rxOk, 1, "Reception on link not counted");
+  NS_TEST_ASSERT_MSG_EQ (link.rxError, 0, "Unexpected reception error on link");
+  uint32_t nSinr = 0;
+  for (uint32_t i = 0; i < link.sinr.GetBins ().size (); i++)
+    {
+      nSinr += link.sinr.GetBins ()[i];
+    }
+  NS_TEST_ASSERT_MSG_EQ (nSinr, 1, "SINR histogram should hold one value");
+
+  // Transmitted size includes the MAC header
+  double airtime = collector->GetAirtime (mode.GetUid ()).GetSeconds ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (airtime, 20 * 8 / 1000.0, 1e-6, "Wrong airtime");
+  NS_TEST_ASSERT_MSG_EQ (collector->GetNHandshakes (), 0, "Aloha should not complete handshakes");
+
+  Simulator::Destroy ();
+
+  std::ifstream is (fileName);
+  NS_TEST_ASSERT_MSG_EQ (is.is_open (), true, "Summary was not written");
+  std::string first;
+  is >> first;
+  NS_TEST_ASSERT_MSG_EQ (first, "link", "Summary should start with the link statistics");
+  is.close ();
+  std::remove (fileName);
+  return GetErrorStatus ();
+}
+
+
+class UanAckAggTest : public TestCase
+{
+public:
+  UanAckAggTest ();
+
+  virtual bool DoRun (void);
+};
+
+UanAckAggTest::UanAckAggTest () : TestCase ("Aggregated RC ACK header")
+{
+
+}
+
+bool
+UanAckAggTest::DoRun (void)
+{
+  UanHeaderRcAck all;
+  all.SetFrameNo (7);
+  UanHeaderRcAck some;
+  some.SetFrameNo (200);
+  some.AddNackedFrame (0);
+  some.AddNackedFrame (9);
+
+  UanHeaderRcAckAgg agg;
+  agg.AddAck (UanAddress (1), all);
+  agg.AddAck (UanAddress (2), some);
+  NS_TEST_ASSERT_MSG_EQ (agg.GetSerializedSize (), 2 + 3 + 3 + 2, "Wrong aggregated ACK size");
+
+  Ptr<Packet> pkt = Create<Packet> ();
+  pkt->AddHeader (agg);
+  UanHeaderRcAckAgg rx;
+  pkt->RemoveHeader (rx);
+  NS_TEST_ASSERT_MSG_EQ (pkt->GetSize (), 0, "Aggregated ACK not fully deserialized");
+  NS_TEST_ASSERT_MSG_EQ (rx.GetNoAcks (), 2, "Wrong number of ACKs");
+
+  UanHeaderRcAck ah;
+  NS_TEST_ASSERT_MSG_EQ (rx.GetAck (UanAddress (3), ah), false, "Found ACK for unlisted node");
+  NS_TEST_ASSERT_MSG_EQ (rx.GetAck (UanAddress (1), ah), true, "Missing ACK for node 1");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) ah.GetFrameNo (), 7, "Wrong frame number for node 1");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) ah.GetNoNacks (), 0, "Unexpected NACKs for node 1");
+  NS_TEST_ASSERT_MSG_EQ (rx.GetAck (UanAddress (2), ah), true, "Missing ACK for node 2");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) ah.GetFrameNo (), 200, "Wrong frame number for node 2");
+  NS_TEST_ASSERT_MSG_EQ (ah.GetNackedFrames () == some.GetNackedFrames (), true, "Wrong NACKs for node 2");
+  return GetErrorStatus ();
+}
+
+
+class UanRcOptATest : public TestCase
+{
+public:
+  UanRcOptATest ();
+
+  virtual bool DoRun (void);
+};
+
+UanRcOptATest::UanRcOptATest () : TestCase ("Cached RC gateway optimum follows attribute changes")
+{
+
+}
+
+bool
+UanRcOptATest::DoRun (void)
+{
+  // Each step changes one more input of FindOptA on a gateway whose
+  // result is already cached and compares with a fresh gateway
+  Ptr<UanMacRcGw> cached = CreateObjectWithAttributes<UanMacRcGw> ("NumberOfNodes", UintegerValue (20),
+                                                                   "FrameSize", UintegerValue (100));
+  cached->FindOptA ();
+  for (uint32_t step = 0; step < 4; step++)
+    {
+      switch (step)
+        {
+        case 0:
+          cached->SetAttribute ("AggregateAck", BooleanValue (true));
+          break;
+        case 1:
+          cached->SetAttribute ("MaxPropDelay", TimeValue (Seconds (0.5)));
+          break;
+        case 2:
+          cached->SetAttribute ("SIFS", TimeValue (Seconds (1.0)));
+          break;
+        case 3:
+          cached->SetAttribute ("FrameSize", UintegerValue (1000));
+          break;
+        }
+      uint32_t optA = cached->FindOptA ();
+      NS_TEST_ASSERT_MSG_EQ (cached->FindOptA (), optA, "FindOptA not stable between calls");
+
+      Ptr<UanMacRcGw> fresh = CreateObjectWithAttributes<UanMacRcGw> ("NumberOfNodes", UintegerValue (20),
+                                                                      "FrameSize", UintegerValue (step < 3 ? 100 : 1000),
+                                                                      "AggregateAck", BooleanValue (true),
+                                                                      "MaxPropDelay", TimeValue (step < 1 ? Seconds (2) : Seconds (0.5)),
+                                                                      "SIFS", TimeValue (step < 2 ? Seconds (0.2) : Seconds (1.0)));
+      NS_TEST_ASSERT_MSG_EQ (optA, fresh->FindOptA (), "Stale FindOptA after changing attributes (step " << step << ")");
+    }
+  return GetErrorStatus ();
+}
+
+
+class UanBandPowerTest : public TestCase
+{
+public:
+  UanBandPowerTest ();
+
+  virtual bool DoRun (void);
+};
+
+UanBandPowerTest::UanBandPowerTest () : TestCase ("Transducer per band arrival power")
+{
+
+}
+
+bool
+UanBandPowerTest::DoRun (void)
+{
+  UanTxMode low = UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 10000, 4000, 2, "BandTestLow");
+  UanTxMode lowNear = UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 12000, 4000, 2, "BandTestLowNear");
+  UanTxMode high = UanTxModeFactory::CreateMode (UanTxMode::FSK, 1000, 1000, 20000, 4000, 2, "BandTestHigh");
+
+  Ptr<UanTransducerHd> trans = CreateObject<UanTransducerHd> ();
+  NS_TEST_ASSERT_MSG_EQ (trans->GetBandPowerKp (low), 0, "Power without arrivals");
+
+  trans->Receive (Create<Packet> (100), 100, low, UanPdp::CreateImpulsePdp ());
+  trans->Receive (Create<Packet> (100), 90, high, UanPdp::CreateImpulsePdp ());
+  NS_TEST_ASSERT_MSG_EQ_TOL (trans->GetBandPowerKp (low), 1e10, 1, "Wrong power in low band");
+  NS_TEST_ASSERT_MSG_EQ_TOL (trans->GetBandPowerKp (high), 1e9, 1, "Wrong power in high band");
+  NS_TEST_ASSERT_MSG_EQ_TOL (trans->GetBandPowerKp (lowNear), 1e10, 1, "Overlapping band not counted");
+  NS_TEST_ASSERT_MSG_EQ_TOL (trans->GetTotalPowerKp (), 1.1e10, 1, "Wrong total power");
+
+  trans->Receive (Create<Packet> (200), 100, high, UanPdp::CreateImpulsePdp ());
+  NS_TEST_ASSERT_MSG_EQ_TOL (trans->GetBandPowerKp (high), 1.1e10, 1, "Band power not updated on arrival");
+  NS_TEST_ASSERT_MSG_EQ (trans->GetNCachedBands (), 1, "Bands not queried since the arrival were kept");
+
+  // Querying many bands, as RC-MAC does with a new rate every cycle, must
+  // not make later arrivals more expensive
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      std::ostringstream name;
+      name << "BandTestRate " << i;
+      trans->GetBandPowerKp (UanTxModeFactory::CreateMode (UanTxMode::OTHER, 10 * (i + 1), 1000, 30000,
+                                                           10 * (i + 1), 2, name.str ()));
+    }
+  NS_TEST_ASSERT_MSG_EQ (trans->GetNCachedBands (), 101, "Queried bands not cached");
+  trans->Receive (Create<Packet> (100), 80, low, UanPdp::CreateImpulsePdp ());
+  NS_TEST_ASSERT_MSG_EQ_TOL (trans->GetBandPowerKp (low), 1.01e10, 1, "Band power not updated on arrival");
+  NS_TEST_ASSERT_MSG_EQ (trans->GetNCachedBands (), 1, "Band cache grows with the bands ever queried");
+
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (trans->GetTotalPowerKp (), 0, "Power left after all arrivals ended");
+  NS_TEST_ASSERT_MSG_EQ (trans->GetBandPowerKp (high), 0, "Band power left after all arrivals ended");
+  trans->Clear ();
+  Simulator::Destroy ();
+  return GetErrorStatus ();
+}
+
+
+class UanFullDuplexTest : public TestCase
+{
+public:
+  UanFullDuplexTest ();
+
+  virtual bool DoRun (void);
+private:
+  uint32_t RunOnce (Ptr<UanTransducer> trans);
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  static void SendModePacket (Ptr<UanNetDevice> dev, uint16_t mode);
+
+  uint32_t m_bytesRx;
+};
+
+UanFullDuplexTest::UanFullDuplexTest () : TestCase ("Reception while transmitting in another band")
+{
+
+}
+
+bool
+UanFullDuplexTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_bytesRx += pkt->GetSize ();
+  return true;
+}
+
+void
+UanFullDuplexTest::SendModePacket (Ptr<UanNetDevice> dev, uint16_t mode)
+{
+  dev->Send (Create<Packet> (17), dev->GetBroadcast (), mode);
+}
+
+uint32_t
+UanFullDuplexTest::RunOnce (Ptr<UanTransducer> trans)
+{
+  UanModesList modes;
+  modes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 10000, 4000, 2, "FullDuplexTestA"));
+  modes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 20000, 4000, 2, "FullDuplexTestB"));
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+
+  std::vector<Ptr<UanNetDevice> > devs;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (i * 50.0, 50, 50));
+      devs.push_back (CreateTestNode (mobility, channel,
+                                      CreateObjectWithAttributes<UanPhyMulti> ("SupportedModes", UanModesListValue (modes)),
+                                      i == 0 ? trans : Ptr<UanTransducer> (CreateObject<UanTransducerHd> ())));
+    }
+  devs[0]->SetReceiveCallback (MakeCallback (&UanFullDuplexTest::RxPacket, this));
+
+  // Node 0 starts sending on band A while receiving on band B
+  Simulator::Schedule (Seconds (1.0), &UanFullDuplexTest::SendModePacket, devs[1], 1);
+  Simulator::Schedule (Seconds (1.5), &UanFullDuplexTest::SendModePacket, devs[0], 0);
+
+  m_bytesRx = 0;
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_bytesRx;
+}
+
+bool
+UanFullDuplexTest::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (RunOnce (CreateObject<UanTransducerHd> ()), 0,
+                         "Half duplex transducer received while transmitting");
+  NS_TEST_ASSERT_MSG_EQ (RunOnce (CreateObject<UanTransducerFd> ()), 17,
+                         "Full duplex transducer lost packet in other band");
+  NS_TEST_ASSERT_MSG_EQ (RunOnce (CreateObjectWithAttributes<UanTransducerFd> ("OutOfBandIsolation", DoubleValue (0))), 0,
+                         "Self interference not counted");
+  return GetErrorStatus ();
+}
+
+
+class UanTxQueueTest : public TestCase
+{
+public:
+  UanTxQueueTest ();
+
+  virtual bool DoRun (void);
+private:
+  uint32_t RunBurst (Ptr<UanTxQueue> queue);
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  void DeviceTx (Ptr<const Packet> pkt, UanAddress dest);
+
+  uint32_t m_bytesRx;
+  uint32_t m_nTx;
+};
+
+UanTxQueueTest::UanTxQueueTest () : TestCase ("Device transmit queue")
+{
+
+}
+
+bool
+UanTxQueueTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_bytesRx += pkt->GetSize ();
+  return true;
+}
+
+void
+UanTxQueueTest::DeviceTx (Ptr<const Packet> pkt, UanAddress dest)
+{
+  m_nTx++;
+}
+
+uint32_t
+UanTxQueueTest::RunBurst (Ptr<UanTxQueue> queue)
+{
+  UanModesList modes;
+  modes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 10000, 4000, 2, "TxQueueTest"));
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+
+  std::vector<Ptr<UanNetDevice> > devs;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (i * 50.0, 50, 50));
+      devs.push_back (CreateTestNode (mobility, channel, modes));
+    }
+  devs[0]->SetTxQueue (queue);
+  devs[0]->TraceConnectWithoutContext ("Tx", MakeCallback (&UanTxQueueTest::DeviceTx, this));
+  devs[1]->SetReceiveCallback (MakeCallback (&UanTxQueueTest::RxPacket, this));
+
+  // A burst of three packets sent at the same time
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1.0), &SendTestPacket, devs[0]);
+    }
+
+  m_bytesRx = 0;
+  m_nTx = 0;
+  Simulator::Stop (Seconds (20.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_bytesRx;
+}
+
+bool
+UanTxQueueTest::DoRun (void)
+{
+  Address dest = UanAddress::GetBroadcast ();
+
+  // Priority queue of 3 packets, protocol 1 before protocol 0
+  Ptr<UanTxQueue> queue = CreateObjectWithAttributes<UanTxQueue> ("MaxPackets", UintegerValue (3),
+                                                                  "Discipline", EnumValue (UanTxQueue::PRIORITY),
+                                                                  "DropPolicy", EnumValue (UanTxQueue::DROP_HEAD));
+  queue->SetPriority (1, 1);
+  queue->Enqueue (Create<Packet> (10), dest, 0);
+  queue->Enqueue (Create<Packet> (11), dest, 0);
+  queue->Enqueue (Create<Packet> (12), dest, 1);
+  NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<Packet> (13), dest, 1), true, "Drop head refused packet");
+  NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<Packet> (14), dest, 0), true, "Drop head refused packet");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNPackets (), 3, "Queue limit not kept");
+  uint32_t order[] = { 12, 13, 14 };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (queue->Peek ().packet->GetSize (), order[i], "Wrong dequeue order");
+      queue->Dequeue ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue->IsEmpty (), true, "Queue not empty");
+
+  // A low priority packet does not push out high priority ones
+  queue->Enqueue (Create<Packet> (12), dest, 1);
+  queue->Enqueue (Create<Packet> (12), dest, 1);
+  queue->Enqueue (Create<Packet> (12), dest, 1);
+  NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<Packet> (10), dest, 0), false, "Dropped higher priority packet");
+  queue->Clear ();
+
+  // Byte limit with drop tail
+  queue = CreateObjectWithAttributes<UanTxQueue> ("MaxBytes", UintegerValue (25));
+  queue->Enqueue (Create<Packet> (10), dest, 0);
+  queue->Enqueue (Create<Packet> (10), dest, 0);
+  NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<Packet> (10), dest, 0), false, "Byte limit not kept");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNBytes (), 20, "Wrong byte count");
+
+  // Aloha refuses packets while transmitting, the queue holds them
+  NS_TEST_ASSERT_MSG_EQ (RunBurst (0), 17, "Aloha accepted packet while transmitting");
+  NS_TEST_ASSERT_MSG_EQ (m_nTx, 1, "Tx traced for a refused packet");
+  NS_TEST_ASSERT_MSG_EQ (RunBurst (CreateObject<UanTxQueue> ()), 51, "Queued packets were not sent");
+  NS_TEST_ASSERT_MSG_EQ (m_nTx, 3, "Tx not traced for queued packets");
+  return GetErrorStatus ();
+}
+
+
+class UanTxReadyTest : public TestCase
+{
+public:
+  UanTxReadyTest ();
+
+  virtual bool DoRun (void);
+private:
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  void SendNext (void);
+
+  Ptr<UanNetDevice> m_dev;
+  uint32_t m_nToSend;
+  uint32_t m_nRefused;
+  uint32_t m_bytesRx;
+};
+
+UanTxReadyTest::UanTxReadyTest () : TestCase ("Upper layer paced by MAC readiness")
+{
+
+}
+
+bool
+UanTxReadyTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_bytesRx += pkt->GetSize ();
+  return true;
+}
+
+void
+UanTxReadyTest::SendNext (void)
+{
+  if (m_nToSend == 0)
+    {
+      return;
+    }
+  if (m_dev->Send (Create<Packet> (17), m_dev->GetBroadcast (), 0))
+    {
+      m_nToSend--;
+    }
+  else
+    {
+      m_nRefused++;
+    }
+}
+
+bool
+UanTxReadyTest::DoRun (void)
+{
+  UanModesList modes;
+  modes.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::FSK, 80, 80, 10000, 4000, 2, "TxReadyTest"));
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+
+  std::vector<Ptr<UanNetDevice> > devs;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (i * 50.0, 50, 50));
+      devs.push_back (CreateTestNode (mobility, channel, modes));
+    }
+  m_dev = devs[0];
+  m_dev->AddTxReadyCallback (MakeCallback (&UanTxReadyTest::SendNext, this));
+  devs[1]->SetReceiveCallback (MakeCallback (&UanTxReadyTest::RxPacket, this));
+
+  // The first packet is sent by hand, the others on each wake up
+  Simulator::Schedule (Seconds (1.0), &UanTxReadyTest::SendNext, this);
+
+  m_nToSend = 3;
+  m_nRefused = 0;
+  m_bytesRx = 0;
+  Simulator::Stop (Seconds (20.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_dev = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (m_nRefused, 0, "Woken up while MAC was busy");
+  NS_TEST_ASSERT_MSG_EQ (m_bytesRx, 51, "Paced packets were not all received");
+  return GetErrorStatus ();
+}
+
+
+// RC-MAC test networks use 3 rates per gateway band of 4096 bps
+static const uint32_t RC_NUM_RATES = 3;
+static const uint32_t RC_TOTAL_RATE = 4096;
+
+/**
+ * Appends the data and control modes of numRateSets gateway bands,
+ * split as in the uan-rc-example
+ */
+static void
+CreateRcModes (uint32_t numRateSets, UanModesList &data, UanModesList &control)
+{
+  uint32_t step = RC_TOTAL_RATE / (RC_NUM_RATES + 1);
+  for (uint32_t g = 0; g < numRateSets; g++)
+    {
+      uint32_t fc = 12000 + g * RC_TOTAL_RATE;
+      for (uint32_t i = RC_NUM_RATES; i > 0; i--)
+        {
+          std::ostringstream name;
+          name << "RcTestData " << g << " " << i;
+          data.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::OTHER, i * step, RC_TOTAL_RATE,
+                                                         fc + (RC_TOTAL_RATE - i * step) / 2, i * step, 2, name.str ()));
+        }
+      for (uint32_t i = 1; i < RC_NUM_RATES + 1; i++)
+        {
+          std::ostringstream name;
+          name << "RcTestControl " << g << " " << i;
+          control.AppendMode (UanTxModeFactory::CreateMode (UanTxMode::OTHER, i * step, RC_TOTAL_RATE,
+                                                            fc - (RC_TOTAL_RATE - i * step) / 2, i * step, 2, name.str ()));
+        }
+    }
+}
+
+static Ptr<UanNetDevice>
+CreateRcDevice (Vector pos, Ptr<UanChannel> channel, Ptr<UanMac> mac, uint32_t numRateSets)
+{
+  UanModesList data;
+  UanModesList control;
+  CreateRcModes (numRateSets, data, control);
+
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (pos);
+  Ptr<Node> node = CreateObject<Node> ();
+  node->AggregateObject (mobility);
+  Ptr<UanPhyDual> phy = CreateObject<UanPhyDual> ();
+  phy->SetAttribute ("SupportedModesPhy1", UanModesListValue (data));
+  phy->SetAttribute ("SupportedModesPhy2", UanModesListValue (control));
+  mac->SetAttribute ("NumberOfRates", UintegerValue (RC_NUM_RATES));
+  mac->SetAttribute ("NumberOfRateSets", UintegerValue (numRateSets));
+  mac->SetAttribute ("MaxPropDelay", TimeValue (Seconds (1)));
+  mac->SetAttribute ("SIFS", TimeValue (Seconds (0.05)));
+  mac->SetAddress (UanAddress::Allocate ());
+
+  Ptr<UanNetDevice> dev = CreateObject<UanNetDevice> ();
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetTransducer (CreateObject<UanTransducerHd> ());
+  dev->SetChannel (channel);
+  node->AddDevice (dev);
+  return dev;
+}
+
+static Ptr<UanMacRcGw>
+CreateRcGateway (uint32_t numRateSets, uint32_t rateSet)
+{
+  Ptr<UanMacRcGw> mac = CreateObject<UanMacRcGw> ();
+  mac->SetAttribute ("TotalRate", UintegerValue (RC_TOTAL_RATE));
+  mac->SetAttribute ("RateStep", UintegerValue (RC_TOTAL_RATE / (RC_NUM_RATES + 1)));
+  mac->SetAttribute ("RateSet", UintegerValue (rateSet));
+  mac->SetAttribute ("NumberOfNodes", UintegerValue (1));
+  mac->SetAttribute ("FrameSize", UintegerValue (32));
+  return mac;
+}
+
+class UanRcAckLossTest : public TestCase
+{
+public:
+  UanRcAckLossTest ();
+
+  virtual bool DoRun (void);
+private:
+  void GatewayTx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode);
+  void Acked (Ptr<const Packet> pkt, Time latency);
+  void RestoreRx (double threshDb);
+  static void SendBurst (Ptr<UanNetDevice> dev, uint32_t n);
+
+  Ptr<UanPhy> m_nodePhy;
+  bool m_ackDropped;
+  uint32_t m_nAcked;
+};
+
+UanRcAckLossTest::UanRcAckLossTest () : TestCase ("RC-MAC reservation with lost ACK across frame number wrap")
+{
+
+}
+
+void
+UanRcAckLossTest::GatewayTx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode)
+{
+  UanHeaderCommon ch;
+  pkt->PeekHeader (ch);
+  if (m_ackDropped || ch.GetType () != UanMacRc::TYPE_ACK)
+    {
+      return;
+    }
+  // Make the node deaf until the ACK has started arriving (0.33 s away)
+  m_ackDropped = true;
+  double threshDb = m_nodePhy->GetRxThresholdDb ();
+  m_nodePhy->SetRxThresholdDb (1000);
+  Simulator::Schedule (Seconds (0.5), &UanRcAckLossTest::RestoreRx, this, threshDb);
+}
+
+void
+UanRcAckLossTest::RestoreRx (double threshDb)
+{
+  m_nodePhy->SetRxThresholdDb (threshDb);
+}
+
+void
+UanRcAckLossTest::Acked (Ptr<const Packet> pkt, Time latency)
+{
+  m_nAcked++;
+}
+
+void
+UanRcAckLossTest::SendBurst (Ptr<UanNetDevice> dev, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      dev->Send (Create<Packet> (32), dev->GetBroadcast (), 0);
+    }
+}
+
+bool
+UanRcAckLossTest::DoRun (void)
+{
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+  Ptr<UanNetDevice> gw = CreateRcDevice (Vector (0, 0, 70), channel, CreateRcGateway (1, 0), 1);
+  Ptr<UanMacRc> mac = CreateObject<UanMacRc> ();
+  Ptr<UanNetDevice> dev = CreateRcDevice (Vector (500, 0, 70), channel, mac, 1);
+  dev->SetTxQueue (CreateObjectWithAttributes<UanTxQueue> ("MaxPackets", UintegerValue (300)));
+
+  m_nodePhy = dev->GetPhy ();
+  m_ackDropped = false;
+  m_nAcked = 0;
+  gw->GetPhy ()->TraceConnectWithoutContext ("Tx", MakeCallback (&UanRcAckLossTest::GatewayTx, this));
+  mac->TraceConnectWithoutContext ("AckLatency", MakeCallback (&UanRcAckLossTest::Acked, this));
+
+  // One frame per reservation, so the frame number wraps after 256 packets
+  Simulator::Schedule (Seconds (1), &UanRcAckLossTest::SendBurst, dev, 300);
+  Simulator::Stop (Seconds (100000));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_nodePhy = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (m_ackDropped, true, "No ACK was sent");
+  NS_TEST_ASSERT_MSG_EQ (m_nAcked, 300, "Frames of reservation with lost ACK were not sent again");
+  return GetErrorStatus ();
+}
+
+
+class UanRcGatewayTest : public TestCase
+{
+public:
+  UanRcGatewayTest ();
+
+  virtual bool DoRun (void);
+private:
+  void NodeTx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode);
+  bool GatewayRx (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  static void Send (Ptr<UanNetDevice> dev);
+
+  Ptr<NetDevice> m_gwDev[2];
+  UanAddress m_gwAddr[2];
+  UanAddress m_lastDataDest;
+  uint32_t m_rxAtGw[2];
+  uint32_t m_wrongBand;
+};
+
+UanRcGatewayTest::UanRcGatewayTest () : TestCase ("RC-MAC node choice among two gateways")
+{
+
+}
+
+void
+UanRcGatewayTest::NodeTx (Ptr<const Packet> pkt, double txPowerDb, UanTxMode mode)
+{
+  UanHeaderCommon ch;
+  pkt->PeekHeader (ch);
+  std::string prefix;
+  if (ch.GetType () == UanMacRc::TYPE_DATA)
+    {
+      m_lastDataDest = ch.GetDest ();
+      prefix = "RcTestData ";
+    }
+  else if (ch.GetType () == UanMacRc::TYPE_RTS)
+    {
+      prefix = "RcTestControl ";
+    }
+  else
+    {
+      return;
+    }
+  for (uint32_t g = 0; g < 2; g++)
+    {
+      std::ostringstream band;
+      band << prefix << g << " ";
+      if (ch.GetDest () == m_gwAddr[g] && mode.GetName ().find (band.str ()) != 0)
+        {
+          m_wrongBand++;
+        }
+    }
+}
+
+bool
+UanRcGatewayTest::GatewayRx (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_rxAtGw[dev == m_gwDev[0] ? 0 : 1]++;
+  return true;
+}
+
+void
+UanRcGatewayTest::Send (Ptr<UanNetDevice> dev)
+{
+  dev->Send (Create<Packet> (32), dev->GetBroadcast (), 0);
+}
+
+bool
+UanRcGatewayTest::DoRun (void)
+{
+  // The node is 1300 m from gateway 0 and 100 m from gateway 1, each
+  // gateway on its own rate set
+  Ptr<UanChannel> channel = CreateObject<UanChannel> ();
+  for (uint32_t g = 0; g < 2; g++)
+    {
+      Ptr<UanMacRcGw> gwMac = CreateRcGateway (2, g);
+      m_gwDev[g] = CreateRcDevice (Vector (g * 1400.0, 0, 70), channel, gwMac, 2);
+      m_gwDev[g]->SetReceiveCallback (MakeCallback (&UanRcGatewayTest::GatewayRx, this));
+      m_gwAddr[g] = UanAddress::ConvertFrom (gwMac->GetAddress ());
+      m_rxAtGw[g] = 0;
+    }
+  Ptr<UanMacRc> mac = CreateObject<UanMacRc> ();
+  mac->SetAttribute ("ReservationCost", TimeValue (Seconds (0.1)));
+  Ptr<UanNetDevice> dev = CreateRcDevice (Vector (1300, 0, 70), channel, mac, 2);
+  dev->GetPhy ()->TraceConnectWithoutContext ("Tx", MakeCallback (&UanRcGatewayTest::NodeTx, this));
+  m_lastDataDest = UanAddress::GetBroadcast ();
+  m_wrongBand = 0;
+
+  // One reservation at a time, each preceded by a gateway choice
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      Simulator::Schedule (Seconds (1 + 60 * i), &UanRcGatewayTest::Send, dev);
+    }
+  Simulator::Stop (Seconds (2000));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_gwDev[0] = 0;
+  m_gwDev[1] = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (m_wrongBand, 0, "Packet sent outside the rate set of the gateway it is addressed to");
+  NS_TEST_ASSERT_MSG_EQ (m_lastDataDest, m_gwAddr[1], "Node did not settle on the nearer gateway");
+  NS_TEST_ASSERT_MSG_EQ (m_rxAtGw[1] > m_rxAtGw[0], true, "Nearer gateway did not receive most of the data");
+  return GetErrorStatus ();
+}
+
+
 class UanTestSuite : public TestSuite
 {
 public:
@@ -260,6 +1790,25 @@ UanTestSuite::UanTestSuite ()
   :  TestSuite ("devices-uan", UNIT)
 {
   AddTestCase (new UanTest);
+  AddTestCase (new UanPerTableTest);
+  AddTestCase (new UanPerFileTest);
+  AddTestCase (new UanPdpSumTest);
+  AddTestCase (new UanThorpTest);
+  AddTestCase (new UanNoiseTest);
+  AddTestCase (new UanPropBhTest);
+  AddTestCase (new UanDopplerTest);
+  AddTestCase (new UanRegionTest);
+  AddTestCase (new UanCountersTest);
+  AddTestCase (new UanTraceWriterTest);
+  AddTestCase (new UanStatsCollectorTest);
+  AddTestCase (new UanAckAggTest);
+  AddTestCase (new UanRcOptATest);
+  AddTestCase (new UanBandPowerTest);
+  AddTestCase (new UanFullDuplexTest);
+  AddTestCase (new UanTxQueueTest);
+  AddTestCase (new UanTxReadyTest);
+  AddTestCase (new UanRcAckLossTest);
+  AddTestCase (new UanRcGatewayTest);
 }
 
 UanTestSuite g_uanTestSuite;